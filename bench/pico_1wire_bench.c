@@ -0,0 +1,267 @@
+/* pico_1wire_bench.c
+
+   Copyright (C) 2024 Timo Kokkonen <tjko@iki.fi>
+
+   SPDX-License-Identifier: GPL-3.0-or-later
+
+   This file is part of pico-1wire Library.
+
+   pico-1wire Library is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   pico-1wire Library is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with pico-1wire Library. If not, see <https://www.gnu.org/licenses/>.
+*/
+
+/* Bus-time benchmark: runs standard scenarios against the simulated bus
+   and reports bus time, slot and reset counts, and host CPU time for each
+   scenario as JSON (one object per line). */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "pico_1wire.h"
+#include "pico_1wire_switch.h"
+#include "pico_1wire_ds2438.h"
+#include "pico_1wire_sim.h"
+
+
+#define DATA_PIN  16
+#define POWER_PIN 17
+
+#define SWITCH_UPDATES 256
+
+
+typedef struct bench_t {
+	const char *name;
+	uint64_t bus_start;
+	uint64_t cpu_start;
+	pico_1wire_sim_stats_t stats;
+} bench_t;
+
+
+static pico_1wire_sim_t *sim;
+static pico_1wire_t *ctx;
+
+
+static uint64_t cpu_time_us()
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &ts);
+	return (uint64_t)ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+}
+
+
+static void bench_start(bench_t *b, const char *name)
+{
+	b->name = name;
+	pico_1wire_sim_reset_stats(sim);
+	pico_1wire_reset_stats(ctx);
+	b->bus_start = pico_1wire_host_time_us();
+	b->cpu_start = cpu_time_us();
+}
+
+
+static void bench_end(bench_t *b, uint devices, uint ops, int result)
+{
+	uint64_t cpu = cpu_time_us() - b->cpu_start;
+	uint64_t bus = pico_1wire_host_time_us() - b->bus_start;
+	pico_1wire_sim_stats_t *s = &b->stats;
+	pico_1wire_stats_t lib;
+
+	pico_1wire_sim_get_stats(sim, s);
+	pico_1wire_get_stats(ctx, &lib);
+	if (ops < 1)
+		ops = 1;
+
+	printf("{\"scenario\":\"%s\",\"devices\":%u,\"operations\":%u,\"result\":%d,"
+		"\"bus_us\":%llu,\"bus_us_per_op\":%.1f,\"ops_per_s\":%.1f,"
+		"\"resets\":%llu,\"write0_slots\":%llu,\"write1_slots\":%llu,\"read_slots\":%llu,"
+		"\"slots_per_op\":%.1f,\"cpu_us\":%llu,\"cpu_us_per_op\":%.2f,"
+		"\"lib_bus_us\":%llu,\"presence_failures\":%u,\"crc_failures\":%u}\n",
+		b->name, devices, ops, result,
+		(unsigned long long)bus, (double)bus / ops, (bus ? ops * 1000000.0 / bus : 0.0),
+		(unsigned long long)s->resets,
+		(unsigned long long)s->write0_slots,
+		(unsigned long long)s->write1_slots,
+		(unsigned long long)s->read_slots,
+		(double)(s->write0_slots + s->write1_slots + s->read_slots) / ops,
+		(unsigned long long)cpu, (double)cpu / ops,
+		(unsigned long long)lib.bus_time, lib.presence_failures,
+		lib.crc_failures + lib.search_crc_failures);
+}
+
+
+int main(int argc, char **argv)
+{
+	uint devices = 32;
+	uint64_t *addr_list;
+	uint found = 0;
+	bench_t b;
+	int res;
+
+	if (argc > 1)
+		devices = atoi(argv[1]);
+	if (devices < 1) {
+		fprintf(stderr, "usage: %s [devices]\n", argv[0]);
+		return 1;
+	}
+
+	if (!(addr_list = calloc(devices, sizeof(uint64_t))))
+		return 1;
+
+	sim = pico_1wire_sim_create(DATA_PIN, POWER_PIN, true);
+	pico_1wire_sim_add_devices(sim, 0x28, devices, false, 1);
+	for (uint i = 0; i < devices; i++)
+		pico_1wire_sim_set_temperature(pico_1wire_sim_device(sim, i), 20.0 + (i % 100) * 0.1);
+
+	bench_start(&b, "init");
+	ctx = pico_1wire_init(DATA_PIN, POWER_PIN, true);
+	bench_end(&b, devices, 1, (ctx ? 0 : -1));
+	if (!ctx)
+		return 1;
+
+	bench_start(&b, "enumerate");
+	res = pico_1wire_search_rom(ctx, addr_list, devices, &found);
+	bench_end(&b, devices, found, res);
+
+	bench_start(&b, "read_temperature");
+	res = pico_1wire_convert_temperature(ctx, 0, true);
+	for (uint i = 0; i < found && !res; i++) {
+		float temp;
+		res = pico_1wire_get_temperature(ctx, addr_list[i], &temp);
+	}
+	bench_end(&b, devices, found, res);
+
+	bench_start(&b, "set_resolution");
+	res = 0;
+	for (uint i = 0; i < found && !res; i++)
+		res = pico_1wire_set_resolution(ctx, addr_list[i], 9);
+	bench_end(&b, devices, found, res);
+
+	bench_start(&b, "read_temperature_9bit");
+	res = pico_1wire_convert_temperature(ctx, 0, true);
+	for (uint i = 0; i < found && !res; i++) {
+		float temp;
+		res = pico_1wire_get_temperature(ctx, addr_list[i], &temp);
+	}
+	bench_end(&b, devices, found, res);
+
+	/* Alarm thresholds so that no sensor is in alarm state. */
+	int8_t *high = calloc(found, sizeof(int8_t));
+	int8_t *low = calloc(found, sizeof(int8_t));
+	for (uint i = 0; i < found; i++) {
+		high[i] = 100;
+		low[i] = -50;
+	}
+	bench_start(&b, "set_alarms");
+	res = pico_1wire_set_alarms(ctx, addr_list, high, low, found, PICO_1WIRE_SAVE_NONE);
+	bench_end(&b, devices, found, res);
+
+	bench_start(&b, "alarm_cycle");
+	uint alarms;
+	res = pico_1wire_alarm_cycle(ctx, addr_list, devices, &alarms);
+	bench_end(&b, devices, 1, res);
+
+	/* Put one sensor in alarm state. */
+	pico_1wire_sim_set_temperature(pico_1wire_sim_device(sim, 0), 110.0);
+	bench_start(&b, "alarm_cycle_1_alarm");
+	res = pico_1wire_alarm_cycle(ctx, addr_list, devices, &alarms);
+	bench_end(&b, devices, 1, (res ? res : (alarms == 1 ? 0 : -2)));
+
+	/* Same bus driven through DS2482 I2C bridge (search using 1-Wire Triplet). */
+	pico_1wire_sim_ds2482_t *bridge = pico_1wire_sim_ds2482_create(0, PICO_1WIRE_DS2482_ADDR, 1);
+	pico_1wire_t *gpio_ctx = ctx;
+	pico_1wire_sim_ds2482_attach(bridge, 0, sim);
+
+	bench_start(&b, "ds2482_init");
+	ctx = pico_1wire_init_ds2482(0, PICO_1WIRE_DS2482_ADDR, -1, 0);
+	bench_end(&b, devices, 1, (ctx ? 0 : -1));
+	if (ctx) {
+		bench_start(&b, "ds2482_enumerate");
+		res = pico_1wire_search_rom(ctx, addr_list, devices, &found);
+		bench_end(&b, devices, found, res);
+
+		bench_start(&b, "ds2482_read_temperature");
+		res = pico_1wire_convert_temperature(ctx, 0, true);
+		for (uint i = 0; i < found && !res; i++) {
+			float temp;
+			res = pico_1wire_get_temperature(ctx, addr_list[i], &temp);
+		}
+		bench_end(&b, devices, found, res);
+
+		pico_1wire_destroy(ctx);
+	}
+	ctx = gpio_ctx;
+	pico_1wire_sim_ds2482_destroy(bridge);
+
+	/* Switch control loop: one update per transaction vs. streamed updates. */
+	pico_1wire_switch_t sw;
+	uint8_t values[SWITCH_UPDATES];
+	uint64_t sw_addr = pico_1wire_sim_rom(0x29, 1);
+	pico_1wire_sim_add_device(sim, sw_addr, false);
+	pico_1wire_switch_init(&sw, ctx, sw_addr);
+	for (uint i = 0; i < SWITCH_UPDATES; i++)
+		values[i] = i;
+
+	bench_start(&b, "switch_set");
+	res = 0;
+	for (uint i = 0; i < SWITCH_UPDATES && !res; i++)
+		res = pico_1wire_switch_set(&sw, values[i]);
+	bench_end(&b, 1, SWITCH_UPDATES, res);
+
+	bench_start(&b, "switch_write_stream");
+	res = pico_1wire_switch_write(&sw, values, SWITCH_UPDATES, NULL);
+	bench_end(&b, 1, SWITCH_UPDATES, res);
+
+	/* DS2438 acquisition: bus with DS2438 devices only (broadcast conversions), and
+	   with another device in the bus (Match ROM for each command). */
+	pico_1wire_destroy(ctx);
+	pico_1wire_sim_destroy(sim);
+	sim = pico_1wire_sim_create(DATA_PIN, POWER_PIN, true);
+	pico_1wire_sim_add_devices(sim, 0x26, devices, false, 1);
+	ctx = pico_1wire_init(DATA_PIN, POWER_PIN, true);
+	pico_1wire_ds2438_t *ds2438 = calloc(devices, sizeof(pico_1wire_ds2438_t));
+	uint64_t *mixed_list = calloc(devices + 1, sizeof(uint64_t));
+	res = pico_1wire_search_rom(ctx, addr_list, devices, &found);
+
+	bench_start(&b, "ds2438_acquire");
+	res = (res ? res : pico_1wire_ds2438_acquire(ctx, addr_list, found, ds2438, false));
+	bench_end(&b, devices, found, res);
+
+	bench_start(&b, "ds2438_acquire_ica");
+	res = (res ? res : pico_1wire_ds2438_acquire(ctx, addr_list, found, ds2438, true));
+	bench_end(&b, devices, found, res);
+
+	pico_1wire_sim_add_device(sim, pico_1wire_sim_rom(0x28, 1), false);
+	uint mixed_found;
+	res = (res ? res : pico_1wire_search_rom(ctx, mixed_list, devices + 1, &mixed_found));
+
+	bench_start(&b, "ds2438_acquire_match");
+	res = (res ? res : pico_1wire_ds2438_acquire(ctx, addr_list, found, ds2438, false));
+	bench_end(&b, devices, found, res);
+
+	bench_start(&b, "ds2438_acquire_match_ica");
+	res = (res ? res : pico_1wire_ds2438_acquire(ctx, addr_list, found, ds2438, true));
+	bench_end(&b, devices, found, res);
+
+	free(ds2438);
+	free(mixed_list);
+	free(high);
+	free(low);
+	pico_1wire_destroy(ctx);
+	pico_1wire_sim_destroy(sim);
+	free(addr_list);
+
+	return 0;
+}
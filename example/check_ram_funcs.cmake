@@ -0,0 +1,36 @@
+# check_ram_funcs.cmake
+#
+# Checks linker map file of a PICO_1WIRE_RAM_FUNCS=1 build: slot-level functions
+# and the CRC table must be in SRAM (.time_critical.*), not in flash (.text.* / .rodata.*).
+#
+# Usage: cmake -DMAP_FILE=<program>.elf.map -P check_ram_funcs.cmake
+
+if(NOT MAP_FILE OR NOT EXISTS "${MAP_FILE}")
+  message(FATAL_ERROR "check_ram_funcs: map file not found: '${MAP_FILE}'")
+endif()
+
+file(READ "${MAP_FILE}" map)
+
+set(ram_sections
+  gpio_write_bit
+  gpio_write_byte
+  gpio_read_bit
+  gpio_read_byte
+  gpio_reset_bus
+  pico_1wire_crc8
+)
+
+set(errors 0)
+foreach(name ${ram_sections})
+  string(REGEX MATCH "\\.time_critical\\.${name}[ \n]" ram_match "${map}")
+  string(REGEX MATCH "\\.(text|rodata)\\.${name}[ \n]" flash_match "${map}")
+  if(NOT ram_match OR flash_match)
+    message(SEND_ERROR "check_ram_funcs: ${name} is not in SRAM (.time_critical.${name})")
+    math(EXPR errors "${errors} + 1")
+  endif()
+endforeach()
+
+if(errors GREATER 0)
+  message(FATAL_ERROR "check_ram_funcs: ${errors} slot function(s) placed in flash")
+endif()
+message(STATUS "check_ram_funcs: all slot functions in SRAM")
@@ -0,0 +1,161 @@
+#include <stdio.h>
+#include <stdarg.h>
+#include <string.h>
+#include "pico/stdlib.h"
+#include "pico/multicore.h"
+#include "hardware/regs/addressmap.h"
+#include "hardware/structs/xip_ctrl.h"
+#include "pico_1wire.h"
+
+/* Slot timing jitter test: core1 keeps flushing the XIP cache and reading flash
+   (bypassing the cache) while core0 runs the 1-Wire slot path. Core0 is never
+   paused, so slot code running from flash has to compete with core1 for the
+   flash interface after each flush. Jitter statistics (PICO_1WIRE_STATS) are
+   printed for each IRQ masking policy.
+
+   Built twice (see CMakeLists.txt): pico-1wire-jitter-test with PICO_1WIRE_RAM_FUNCS=1,
+   and pico-1wire-jitter-test-flash without, to compare the two. */
+
+
+#define DATA_PIN 16
+#define POWER_PIN -1
+
+#define MAX_DEVICES 32
+#define TEST_ROUNDS 50
+
+#define FLASH_READ_SIZE (64 * 1024)
+
+
+/* Data read by core1 (in flash, core0 never executes from here). */
+static const uint8_t flash_data[FLASH_READ_SIZE] = { 1 };
+
+static volatile uint32_t flash_rounds = 0;
+static volatile uint32_t flash_sum = 0;
+
+
+void log_msg(const char *format, ...)
+{
+	va_list ap;
+	char buf[256];
+	int len;
+	static uint64_t last_t = 0;
+
+	va_start(ap, format);
+	vsnprintf(buf, sizeof(buf), format, ap);
+	va_end(ap);
+
+	if ((len = strlen(buf)) > 0) {
+		/* If string ends with \n, remove it. */
+		if (buf[len - 1] == '\n')
+			buf[len - 1] = 0;
+	}
+
+	uint64_t t = to_us_since_boot(get_absolute_time());
+	printf("[%6llu.%06llu][%8llu] %s\n", (t / 1000000), (t % 1000000), (t - last_t) / 1000, buf);
+	last_t = t;
+}
+
+
+void core1_main()
+{
+	/* Uncached alias of flash_data: every read goes to the flash interface. */
+	const volatile uint32_t *data = (const volatile uint32_t *)
+		((uintptr_t)flash_data - XIP_BASE + XIP_NOCACHE_NOALLOC_BASE);
+	uint32_t sum;
+
+	while (1) {
+		/* Flush XIP cache: code core0 runs from flash has to be fetched again. */
+		xip_ctrl_hw->flush = 1;
+		(void)xip_ctrl_hw->flush;
+
+		sum = 0;
+		for (uint i = 0; i < FLASH_READ_SIZE / 4; i += 8)
+			sum += data[i];
+
+		flash_sum = sum;
+		flash_rounds++;
+	}
+}
+
+
+void print_jitter(const char *name, const pico_1wire_jitter_t *j)
+{
+	log_msg("  %-7s slots=%8lu late=%6lu max=%5luus avg=%6.2fus", name,
+		(unsigned long)j->count, (unsigned long)j->late, (unsigned long)j->max,
+		(j->count ? (double)j->total / j->count : 0.0));
+}
+
+
+
+int main() {
+	static const char *policy_names[] = { "NONE", "CRITICAL", "SLOT" };
+	uint64_t addr_list[MAX_DEVICES];
+	uint device_count;
+	uint8_t scratch[9];
+	pico_1wire_stats_t stats;
+	uint32_t ops;
+	int res;
+
+	stdio_init_all();
+
+	sleep_ms(250);
+	printf("\n\n\nBOOT\n");
+
+#if !PICO_1WIRE_STATS
+	log_msg("Warning: built without PICO_1WIRE_STATS");
+#endif
+	log_msg("Slot path in %s (PICO_1WIRE_RAM_FUNCS=%d)", (PICO_1WIRE_RAM_FUNCS ? "SRAM" : "flash"),
+		PICO_1WIRE_RAM_FUNCS);
+
+	pico_1wire_t *ctx = pico_1wire_init(DATA_PIN, POWER_PIN, true);
+	if (!ctx) {
+		log_msg("pico_1wire_init() failed");
+		panic("halt");
+	}
+
+	log_msg("Find devices in the bus...");
+	while ((res = pico_1wire_search_rom(ctx, addr_list, MAX_DEVICES, &device_count))) {
+		log_msg("pico_1wire_search_rom() failed: %d (no devices in the bus)", res);
+		sleep_ms(1000);
+	}
+	log_msg("%u device(s) found.", device_count);
+
+	multicore_launch_core1(core1_main);
+	log_msg("XIP cache flush and flash read loop started on core1.");
+
+	while (1) {
+		for (uint policy = PICO_1WIRE_IRQ_NONE; policy <= PICO_1WIRE_IRQ_SLOT; policy++) {
+			uint errors = 0;
+
+			pico_1wire_set_irq_policy(ctx, policy);
+			pico_1wire_reset_stats(ctx);
+			ops = flash_rounds;
+
+			for (int round = 0; round < TEST_ROUNDS; round++) {
+				uint found;
+
+				if (pico_1wire_search_rom(ctx, addr_list, MAX_DEVICES, &found) || found != device_count)
+					errors++;
+				for (int i = 0; i < found; i++) {
+					if (pico_1wire_read_scratch_pad(ctx, addr_list[i], scratch))
+						errors++;
+				}
+			}
+
+			pico_1wire_get_stats(ctx, &stats);
+			log_msg("IRQ policy %s: %u rounds, %lu cache flushes, %u errors, %lu CRC failures",
+				policy_names[policy], TEST_ROUNDS, (unsigned long)(flash_rounds - ops), errors,
+				(unsigned long)(stats.crc_failures + stats.search_crc_failures));
+			print_jitter("reset", &stats.reset_jitter);
+			print_jitter("write0", &stats.write0_jitter);
+			print_jitter("write1", &stats.write1_jitter);
+			print_jitter("read", &stats.read_jitter);
+		}
+
+		log_msg("sleep...");
+		sleep_ms(5000);
+	}
+
+
+	return 0;
+}
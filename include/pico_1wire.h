@@ -26,7 +26,11 @@
 #ifndef PICO_1WIRE_H
 #define PICO_1WIRE_H 1
 
+#ifdef PICO_1WIRE_HOST
+#include "pico_1wire_host.h"
+#else
 #include "pico/stdio.h"
+#endif
 
 #ifdef __cplusplus
 extern "C"
@@ -34,29 +38,329 @@ extern "C"
 #endif
 
 
+/** Maximum number of devices tracked in the bus context (device registry). */
+#ifndef PICO_1WIRE_MAX_DEVICES
+#define PICO_1WIRE_MAX_DEVICES 32
+#endif
+
+
+/** Number of bus contexts in static pool used by pico_1wire_init() (0 = contexts are allocated from heap). */
+#ifndef PICO_1WIRE_STATIC_POOL_SIZE
+#define PICO_1WIRE_STATIC_POOL_SIZE 0
+#endif
+
+
+/** Enable instrumentation counters in the bus context (see pico_1wire_get_stats()). */
+#ifndef PICO_1WIRE_STATS
+#define PICO_1WIRE_STATS 0
+#endif
+
+
+/** Maximum number of device family drivers (built-in and registered). */
+#ifndef PICO_1WIRE_MAX_DRIVERS
+#define PICO_1WIRE_MAX_DRIVERS 16
+#endif
+
+
+/** Place slot-level code (bit/byte I/O, bus reset) and CRC table in SRAM instead of XIP flash (Pico only). */
+#ifndef PICO_1WIRE_RAM_FUNCS
+#define PICO_1WIRE_RAM_FUNCS 0
+#endif
+
+
+/** Include DS2482 I2C bridge backend (pico_1wire_init_ds2482()). On Pico, defined by pico_1wire_ds2482 library. */
+#ifndef PICO_1WIRE_DS2482
+#define PICO_1WIRE_DS2482 0
+#endif
+
+
+/** Number of records in bit-level trace ring buffer (0 = tracing disabled). See pico_1wire_trace_dump(). */
+#ifndef PICO_1WIRE_TRACE_SIZE
+#define PICO_1WIRE_TRACE_SIZE 0
+#endif
+
+
+/** Trace record type: bus reset (driven = 0, sampled = presence pulse detected) */
+#define PICO_1WIRE_TRACE_RESET  0
+/** Trace record type: write slot (sampled = bus level at end of slot) */
+#define PICO_1WIRE_TRACE_WRITE  1
+/** Trace record type: read slot (driven = 1, sampled = bit read) */
+#define PICO_1WIRE_TRACE_READ   2
+
+
+/**
+ * Bit-level trace record.
+ */
+typedef struct pico_1wire_trace_t {
+	uint32_t timestamp;   /**< Time (us since boot, lower 32 bits) when slot started */
+	uint8_t type;         /**< Record type (PICO_1WIRE_TRACE_xxx) */
+	uint8_t driven;       /**< Value driven to the bus */
+	uint8_t sampled;      /**< Value sampled from the bus */
+} pico_1wire_trace_t;
+
+
+/**
+ * Slot timing jitter statistics.
+ *
+ * Lateness (us) of a timing-critical edge compared to intended time, measured from the timer.
+ */
+typedef struct pico_1wire_jitter_t {
+	uint32_t count;       /**< Number of slots measured */
+	uint32_t late;        /**< Slots where edge was outside protocol limits (bit likely corrupted) */
+	uint32_t max;         /**< Maximum lateness (us) */
+	uint64_t total;       /**< Cumulative lateness (us), total / count gives average */
+} pico_1wire_jitter_t;
+
+
+/**
+ * Instrumentation counters.
+ */
+typedef struct pico_1wire_stats_t {
+	uint32_t resets;              /**< Bus resets issued */
+	uint32_t presence_failures;   /**< Bus resets without presence pulse */
+	uint32_t crc_failures;        /**< CRC-8 failures reading scratchpad */
+	uint32_t search_crc_failures; /**< CRC-8 failures (ROM address) during search */
+	uint32_t line_faults;         /**< Bus resets that found data line stuck low (or shorted) */
+	uint64_t bits_written;        /**< Bits written to the bus */
+	uint64_t bits_read;           /**< Bits read from the bus */
+	uint64_t bus_time;            /**< Cumulative time (us) bus was busy with slots and resets */
+	pico_1wire_jitter_t reset_jitter;  /**< Reset pulse release (intended 480us) */
+	pico_1wire_jitter_t write0_jitter; /**< Write "0" slot release (intended 60us, limit 120us) */
+	pico_1wire_jitter_t write1_jitter; /**< Write "1" slot release (intended 3us, limit 15us) */
+	pico_1wire_jitter_t read_jitter;   /**< Read slot sample (intended 10us, limit 15us) */
+} pico_1wire_stats_t;
+
+
+/** IRQ masking policy: never mask interrupts (default) */
+#define PICO_1WIRE_IRQ_NONE      0
+/** IRQ masking policy: mask interrupts only around edges that determine bit value */
+#define PICO_1WIRE_IRQ_CRITICAL  1
+/** IRQ masking policy: mask interrupts for the active (low) part of every slot and presence detect */
+#define PICO_1WIRE_IRQ_SLOT      2
+
+
+/**
+ * Device family driver.
+ *
+ * Driver implements family specific operations for temperature sensors.
+ * Drivers for DS18S20, DS1822, DS18B20, DS1825/MAX31826, MAX31850/MAX31851 and DS28EA00 are built-in,
+ * additional drivers can be registered using pico_1wire_register_driver().
+ */
+typedef struct pico_1wire_driver_t {
+	uint8_t family;       /**< Device family code */
+	const char *name;     /**< Device name */
+	uint8_t resolution;   /**< Fixed measurement resolution (bits), 0 if resolution is configurable */
+	uint8_t config_len;   /**< Number of bytes written by Write Scratchpad command (T(H), T(L), config),
+	                           0 if device has no writable scratchpad */
+	/** Decode temperature from scratchpad. Returns 0 on success, 2 if result may be inaccurate. */
+	int (*decode)(const uint8_t *scratch, float *temperature);
+	/** Get resolution (bits) from scratchpad (optional). */
+	uint (*get_resolution)(const uint8_t *scratch);
+	/** Set resolution (bits) in scratchpad (optional). Returns 0 on success. */
+	int (*set_resolution)(uint8_t *scratch, uint resolution);
+	/** Return conversion time (ms) for given resolution (0 = unknown). */
+	uint (*conversion_time)(uint resolution);
+	/** Identify device sharing the family code from scratchpad contents (optional).
+	    Returns driver for the device, or NULL if this driver applies. */
+	const struct pico_1wire_driver_t* (*identify)(const uint8_t *scratch);
+} pico_1wire_driver_t;
+
+
+/**
+ * Device registry entry.
+ *
+ * Bus context keeps track of devices found by pico_1wire_search_rom().
+ */
+typedef struct pico_1wire_device_t {
+	uint64_t addr;        /**< Device ROM address */
+	bool parasitic;       /**< Device uses phantom power (needs strong pull-up) */
+	float temperature;    /**< Last temperature read from the device */
+	uint64_t timestamp;   /**< Time (us since boot) of conversion for last temperature */
+	bool temp_valid;      /**< Last temperature (and timestamp) is valid */
+	uint64_t conv_start;  /**< Time (us since boot) pending conversion was started */
+	uint64_t conv_ready;  /**< Time (us since boot) pending conversion completes */
+	bool conv_pending;    /**< Conversion has been started, but result has not been read yet */
+	uint8_t resolution;   /**< Last known measurement resolution (0 = unknown) */
+	bool prev_valid;      /**< Previous reading available for adaptive resolution control */
+	float prev_temp;      /**< Previous reading used by adaptive resolution control */
+	const pico_1wire_driver_t *driver; /**< Identified driver (devices sharing family code), NULL if not known */
+	uint16_t position;    /**< Physical position found by pico_1wire_sequence_discovery() (1 = first, 0 = unknown) */
+	uint64_t coupler;     /**< DS2409 coupler the device is connected behind (0 = main trunk) */
+	uint8_t branch;       /**< Coupler branch the device is connected to (PICO_1WIRE_BRANCH_xxx) */
+} pico_1wire_device_t;
+
+
+/**
+ * Adaptive resolution controller configuration.
+ *
+ * See pico_1wire_set_adaptive_resolution().
+ */
+typedef struct pico_1wire_adaptive_config_t {
+	float accuracy;         /**< Required precision (C) when reading is changing or near threshold */
+	float stable_delta;     /**< Maximum change (C) between readings for sensor to be considered stable */
+	float threshold_low;    /**< Low threshold (C) to watch (NAN if not used) */
+	float threshold_high;   /**< High threshold (C) to watch (NAN if not used) */
+	float threshold_margin; /**< Distance (C) from threshold where required precision is used */
+	uint8_t min_resolution; /**< Resolution (9-12bit) used when reading is stable */
+} pico_1wire_adaptive_config_t;
+
 
 /**
  * Context for 1-Wire bus instance.
  *
  * This structure stores state information about the 1-Wire bus instance.
- * Created using pico_1wire_init(), and destroyed using pico_1wire_destroy().
+ * Created using pico_1wire_init() (or pico_1wire_init_static()), and destroyed using pico_1wire_destroy().
  */
 typedef struct pico_1wire_t {
 	uint data_pin;        /**< GPIO pin for 1-Wire data communications */
 	uint power_pin;       /**< GPIO pin that controls MOSFET (strong pull-up) */
 	bool power_available; /**< Power MOSFET available */
 	bool power_state;     /**< GPIO state (1 or 0) to turn power MOSFET on */
+	uint8_t storage;      /**< Where context memory came from (heap, static pool, or caller) */
 
 	bool psu_present;     /**< False is one or more devices use phantom power. */
+	bool power_known;     /**< Bus wide power supply status (psu_present) has been checked */
+	uint8_t bus_fault;    /**< Result of last bus reset (PICO_1WIRE_RESET_xxx) */
+	uint64_t resume_addr; /**< Device last selected using Match ROM, if it supports Resume command (0 = none) */
+	uint8_t irq_policy;   /**< Interrupt masking policy (PICO_1WIRE_IRQ_xxx) */
+	uint64_t branch_coupler; /**< DS2409 coupler that has a branch switched on (0 = all branches off) */
+	uint8_t branch;       /**< Branch currently switched on (PICO_1WIRE_BRANCH_xxx) */
+
+	bool bridge;          /**< Bus is driven through DS2482 I2C-to-1-Wire bridge (instead of GPIO) */
+	uint8_t i2c_bus;      /**< DS2482: I2C controller (0 = i2c0, 1 = i2c1) */
+	uint8_t i2c_addr;     /**< DS2482: I2C address */
+	int8_t channel;       /**< DS2482-800: 1-Wire channel (-1 = DS2482-100, no channel selection) */
+
+	pico_1wire_device_t devices[PICO_1WIRE_MAX_DEVICES]; /**< Device registry */
+	uint device_count;    /**< Number of devices in the registry */
+	bool registry_complete; /**< Registry holds all devices on the bus (last search found all of them) */
+
+	bool adaptive;        /**< Adaptive resolution control enabled */
+	pico_1wire_adaptive_config_t adaptive_config; /**< Adaptive resolution controller configuration */
+
+#if PICO_1WIRE_STATS
+	pico_1wire_stats_t stats; /**< Instrumentation counters */
+#endif
+
+#if PICO_1WIRE_TRACE_SIZE > 0
+	pico_1wire_trace_t trace[PICO_1WIRE_TRACE_SIZE]; /**< Trace ring buffer */
+	uint trace_pos;       /**< Index of next trace record to write */
+	uint32_t trace_count; /**< Number of trace records written since last clear */
+#endif
 } pico_1wire_t;
 
 
+/** Bus reset result: presence pulse detected */
+#define PICO_1WIRE_RESET_OK           0
+/** Bus reset result: no presence pulse (no devices) */
+#define PICO_1WIRE_RESET_NO_PRESENCE  1
+/** Bus reset result: data line stuck low before reset (reset pulse was not sent) */
+#define PICO_1WIRE_RESET_STUCK_LOW    2
+/** Bus reset result: data line did not return high after presence window (short circuit) */
+#define PICO_1WIRE_RESET_SHORT        3
+
+
+/** Device selection: Skip ROM (address all devices) */
+#define PICO_1WIRE_SELECT_SKIP     0
+/** Device selection: Match ROM */
+#define PICO_1WIRE_SELECT_MATCH    1
+/** Device selection: Resume (if device supports it, and was the last one selected by Match ROM, otherwise Match ROM) */
+#define PICO_1WIRE_SELECT_RESUME   2
+
+
+/** DS2409 coupler branch: main */
+#define PICO_1WIRE_BRANCH_MAIN     0
+/** DS2409 coupler branch: auxiliary */
+#define PICO_1WIRE_BRANCH_AUX      1
+
+
+/** Transaction operation: reset bus (fails if no presence pulse) */
+#define PICO_1WIRE_OP_RESET   0
+/** Transaction operation: reset bus and select device(s), see pico_1wire_select() */
+#define PICO_1WIRE_OP_SELECT  1
+/** Transaction operation: write len bytes from tx */
+#define PICO_1WIRE_OP_WRITE   2
+/** Transaction operation: read len bytes to rx */
+#define PICO_1WIRE_OP_READ    3
+/** Transaction operation: wait len ms */
+#define PICO_1WIRE_OP_DELAY   4
+/** Transaction operation: strong pull-up on for len ms (immediately after previous operation) */
+#define PICO_1WIRE_OP_PULLUP  5
+
+
+/**
+ * Transaction operation descriptor.
+ *
+ * Sequence of operations is executed using pico_1wire_run_transaction().
+ * Descriptors only describe the operations, so same (static) descriptor list
+ * can be reused and executed by different backends.
+ */
+typedef struct pico_1wire_op_t {
+	uint8_t type;         /**< Operation type (PICO_1WIRE_OP_xxx) */
+	uint8_t mode;         /**< Selection mode for PICO_1WIRE_OP_SELECT (PICO_1WIRE_SELECT_xxx) */
+	uint16_t len;         /**< Number of bytes to write/read, or duration (ms) */
+	uint64_t addr;        /**< Device to select (0 = use address passed to pico_1wire_run_transaction()) */
+	const uint8_t *tx;    /**< Data to write (PICO_1WIRE_OP_WRITE) */
+	uint8_t *rx;          /**< Buffer for data read (PICO_1WIRE_OP_READ) */
+} pico_1wire_op_t;
+
+
+/** Initialization flag: only configure GPIOs, defer power supply discovery until first conversion */
+#define PICO_1WIRE_INIT_LAZY     0x01
+
+
+/** DS2482 I2C address with address pins (AD0..AD2) low */
+#define PICO_1WIRE_DS2482_ADDR   0x18
+
+
+/** Size of storage needed for a bus context (see pico_1wire_init_static()). */
+#define PICO_1WIRE_CTX_SIZE (sizeof(pico_1wire_t))
+
+
+/** Alarm thresholds save mode: do not copy scratchpad to EEPROM */
+#define PICO_1WIRE_SAVE_NONE     0
+/** Alarm thresholds save mode: copy scratchpad of each listed device to EEPROM */
+#define PICO_1WIRE_SAVE_DEVICES  1
+/** Alarm thresholds save mode: copy scratchpad of all devices in the bus to EEPROM (broadcast) */
+#define PICO_1WIRE_SAVE_ALL      2
+
+
+/** Conversion plan step: start temperature conversion */
+#define PICO_1WIRE_STEP_CONVERT  0
+/** Conversion plan step: read temperature */
+#define PICO_1WIRE_STEP_READ     1
+
+/** Device index used in conversion plan to address all devices in the bus */
+#define PICO_1WIRE_ALL_DEVICES   0xffff
+
+/** Size of steps array needed to plan conversions for given number of devices
+    (plan itself has at most 2 * n steps, rest of the array is used while planning). */
+#define PICO_1WIRE_PLAN_MAX_STEPS(n) (3 * (n) + 1)
+
+
+/**
+ * Conversion plan step.
+ *
+ * Temperature conversion plan consists of array of these steps, created
+ * by pico_1wire_plan_conversions().
+ */
+typedef struct pico_1wire_plan_step_t {
+	uint8_t type;         /**< Step type (PICO_1WIRE_STEP_CONVERT or PICO_1WIRE_STEP_READ) */
+	bool strong_pullup;   /**< Use strong pull-up during conversion (bus is busy until done) */
+	uint16_t index;       /**< Index to device address list (or PICO_1WIRE_ALL_DEVICES) */
+	uint16_t branch;      /**< Broadcast conversion: index of device whose coupler branch is switched on */
+	uint16_t duration;    /**< Conversion time (ms) to wait for before this step is complete */
+} pico_1wire_plan_step_t;
+
+
 
 /**
  * Initialize 1-Wire Bus.
  *
  * Initializes a 1-Wire bus instance. Function allocates and initializes a
  * pico_1wire_t structure (context) to use with other library functions to manipulate the bus.
+ * Context is allocated from heap, or from a static pool if library is built with
+ * PICO_1WIRE_STATIC_POOL_SIZE set (in which case NULL is returned when pool is exhausted).
  *
  * @param data_pin GPIO pin connected to 1-Wire bus data (DQ) line.
  * @param power_pin GPIO pin connected to a MOSFET that when activated acts
@@ -67,18 +371,91 @@ typedef struct pico_1wire_t {
  *
  * @return Pointer to a new bus context allocated or NULL if function failed.
  *
- * @note When bus is initialized search check for phantom powered devices is performed.
- *       If device power status changes later, then @ref pico_1wire_read_power_supply() should
- *       be called to update power status in the bus context.
+ * @note When bus is initialized, devices are searched (filling the device registry) and
+ *       checked for phantom power. Read Power Supply is only broadcast when all devices found
+ *       are temperature sensors (0xB4 is Convert V on DS2438), otherwise each sensor is checked
+ *       separately. If device power status changes later, then @ref pico_1wire_read_power_supply()
+ *       should be called to update power status in the bus context.
  */
 pico_1wire_t* pico_1wire_init(int data_pin, int power_pin, bool power_polarity);
 
 
+/**
+ * Initialize 1-Wire Bus (with options).
+ *
+ * Same as pico_1wire_init(), with initialization flags:
+ *   - PICO_1WIRE_INIT_LAZY, only configure GPIOs and do not generate any bus traffic.
+ *     Check for phantom powered devices is deferred until first temperature conversion.
+ *
+ * @param data_pin GPIO pin connected to 1-Wire bus data (DQ) line.
+ * @param power_pin GPIO pin connected to a MOSFET that when activated acts
+ *                  a strong pull-up to power devices needing phantom power.
+ *                  (Set to -1 if no MOSFET available)
+ * @param power_polarity Define GPIO state (1 or 0) to used to activate MOSFET
+ *                       via power pin.
+ * @param flags Initialization flags (PICO_1WIRE_INIT_xxx).
+ *
+ * @return Pointer to a new bus context allocated or NULL if function failed.
+ */
+pico_1wire_t* pico_1wire_init_ex(int data_pin, int power_pin, bool power_polarity, uint flags);
+
+
+/**
+ * Initialize 1-Wire Bus using caller provided storage.
+ *
+ * Same as pico_1wire_init(), except bus context is placed in memory provided
+ * by the caller (no memory is allocated). Storage must be at least
+ * PICO_1WIRE_CTX_SIZE bytes, suitably aligned for pico_1wire_t (for example
+ * a pico_1wire_t variable), and remain valid until pico_1wire_destroy() is called.
+ *
+ * @param buf Pointer to storage for the bus context.
+ * @param size Size of storage (bytes).
+ * @param data_pin GPIO pin connected to 1-Wire bus data (DQ) line.
+ * @param power_pin GPIO pin connected to a MOSFET that when activated acts
+ *                  a strong pull-up to power devices needing phantom power.
+ *                  (Set to -1 if no MOSFET available)
+ * @param power_polarity Define GPIO state (1 or 0) to used to activate MOSFET
+ *                       via power pin.
+ * @param flags Initialization flags (PICO_1WIRE_INIT_xxx), see pico_1wire_init_ex().
+ *
+ * @return Pointer to bus context (same as buf) or NULL if function failed.
+ */
+pico_1wire_t* pico_1wire_init_static(void *buf, size_t size, int data_pin, int power_pin, bool power_polarity,
+				uint flags);
+
+
+/**
+ * Initialize 1-Wire Bus driven by DS2482 I2C-to-1-Wire bridge.
+ *
+ * Same as pico_1wire_init_ex(), except bus is driven through DS2482-100 or DS2482-800
+ * instead of a GPIO pin. Bus resets, bit and byte transfers are done by DS2482 commands,
+ * and ROM search uses DS2482 1-Wire Triplet command. Strong pull-up is provided by
+ * DS2482 (SPU), so no power MOSFET is needed.
+ *
+ * Each channel of DS2482-800 is a separate bus, so one context is created per channel.
+ * Channel is selected at the start of each bus reset, so transactions on different
+ * channels of same DS2482-800 should not be interleaved.
+ *
+ * I2C controller (and its GPIO pins) must be initialized by the caller.
+ * Requires PICO_1WIRE_DS2482 (on Pico, link pico_1wire_ds2482 library).
+ *
+ * @param i2c_bus I2C controller (0 = i2c0, 1 = i2c1).
+ * @param i2c_addr DS2482 I2C address (PICO_1WIRE_DS2482_ADDR + address pin settings).
+ * @param channel DS2482-800 channel (0-7), or -1 for DS2482-100.
+ * @param flags Initialization flags (PICO_1WIRE_INIT_xxx), see pico_1wire_init_ex().
+ *
+ * @return Pointer to a new bus context allocated or NULL if function failed
+ *         (DS2482 not responding, or backend not built in).
+ */
+pico_1wire_t* pico_1wire_init_ds2482(uint i2c_bus, uint8_t i2c_addr, int channel, uint flags);
+
+
 /**
  * Destroy previously created 1-Wire Bus context.
  *
  * This functions takes pointer to structure allocated earlier with call to pico_1wire_init().
  * GPIO lines are set back to high-imbedance (input) and resources are freed.
+ * For contexts created with pico_1wire_init_static(), caller provided storage is not freed.
  *
  * @param ctx Pointer to a bus context.
  *
@@ -96,10 +473,50 @@ void pico_1wire_destroy(pico_1wire_t *ctx);
  * @param ctx Pointer to a bus context.
  *
  * @return True if one or more devices are present in the Bus. False if no devices found.
+ *         (or data line is stuck low, see @ref pico_1wire_reset_bus_ex()).
  */
 bool pico_1wire_reset_bus(pico_1wire_t *ctx);
 
 
+/**
+ * Reset 1-Wire Bus (with line fault detection).
+ *
+ * This function performs reset procedure on the 1-Wire bus. Data line is sampled
+ * before driving the reset pulse and after the presence window to detect line that is
+ * stuck low (shorted). Result is stored in the bus context (see @ref pico_1wire_get_bus_fault()).
+ *
+ * Normally, when line is found low before reset, function waits up to 120us for a slot
+ * in progress to complete. While stored result is PICO_1WIRE_RESET_STUCK_LOW or
+ * PICO_1WIRE_RESET_SHORT, this wait is skipped, so reset (and any function using the bus)
+ * fails immediately as long as the line stays low. Stored fault is only cleared by a reset:
+ * after the fault has been removed, next reset that finds the line high sends the reset
+ * pulse normally and stores its result (PICO_1WIRE_RESET_OK or PICO_1WIRE_RESET_NO_PRESENCE).
+ *
+ * @param ctx Pointer to a bus context.
+ *
+ * @return Status code,
+ *         - -1, invalid parameters
+ *         - PICO_1WIRE_RESET_OK (0), devices present in the bus
+ *         - PICO_1WIRE_RESET_NO_PRESENCE (1), no devices found
+ *         - PICO_1WIRE_RESET_STUCK_LOW (2), data line stuck low (reset not sent)
+ *         - PICO_1WIRE_RESET_SHORT (3), data line did not return high after presence window
+ */
+int pico_1wire_reset_bus_ex(pico_1wire_t *ctx);
+
+
+/**
+ * Get bus fault state.
+ *
+ * Returns result of the last bus reset. Can be used to find out why a function failed
+ * with "no devices found" status.
+ *
+ * @param ctx Pointer to a bus context.
+ *
+ * @return Status code (see @ref pico_1wire_reset_bus_ex()).
+ */
+int pico_1wire_get_bus_fault(pico_1wire_t *ctx);
+
+
 /**
  * Read (ROM) Address of single device.
  *
@@ -133,6 +550,9 @@ int pico_1wire_read_rom(pico_1wire_t *ctx, uint64_t *addr);
  *                       device addresses will be returned.
  * @param devices_found Pointer to variable to store number active of devices found in the bus.
  *
+ * @note Devices found are also stored into the device registry in the bus context
+ *       (up to PICO_1WIRE_MAX_DEVICES devices) along with their power supply status.
+ *
  * @return Status code,
  *         - -1, invalid parameters
  *         - 0, success
@@ -142,6 +562,147 @@ int pico_1wire_read_rom(pico_1wire_t *ctx, uint64_t *addr);
 int pico_1wire_search_rom(pico_1wire_t *ctx, uint64_t  *addr_list, uint addr_list_size, uint *devices_found);
 
 
+/**
+ * Discover physical order of DS28EA00 devices (sequence detection).
+ *
+ * Uses DS28EA00 chain mode to enumerate devices in the order they are wired on the
+ * PIOA/PIOB chain: all devices are put into chain mode, then Conditional Read ROM
+ * returns the address of the first device not yet done, which is then marked done
+ * (enabling next device in the chain). Finally chain mode is turned off.
+ *
+ * This finds devices in a single pass, without separate Search ROM.
+ *
+ * @param ctx Pointer to bus context.
+ * @param addr_list Pointer to array to store device (ROM) addresses (in physical order).
+ * @param addr_list_size Size of addr_list.
+ * @param devices_found Pointer to variable to store number of devices found.
+ *
+ * @note Devices found are added to the device registry (if not already there), and their
+ *       position in the chain is stored in the registry (see pico_1wire_get_position()).
+ *
+ * @return Status code,
+ *         - -1, invalid parameters
+ *         - 0, success
+ *         - 1, bus reset failed (no devices found)
+ *         - 2, found more devices than addr_list_size
+ *         - 3, chain command not confirmed or CRC error (sequence may be incomplete)
+ */
+int pico_1wire_sequence_discovery(pico_1wire_t *ctx, uint64_t *addr_list, uint addr_list_size, uint *devices_found);
+
+
+/**
+ * Get physical position of a device.
+ *
+ * @param ctx Pointer to bus context.
+ * @param addr ROM Address of the device.
+ * @param position Pointer to variable to store position (1 = first device in chain).
+ *
+ * @return Status code,
+ *         - -1, invalid parameters
+ *         - 0, success
+ *         - 1, position not known (device not in registry, or not found by pico_1wire_sequence_discovery())
+ */
+int pico_1wire_get_position(pico_1wire_t *ctx, uint64_t addr, uint *position);
+
+
+/**
+ * Discover devices behind DS2409 MicroLAN couplers.
+ *
+ * Switches all coupler branches off and searches devices on the main trunk, then
+ * switches on each branch (main and auxiliary) of each coupler found in turn, and
+ * searches devices on the branch. Device registry is rebuilt, and each entry records
+ * the coupler and branch the device is connected to.
+ *
+ * Returned list contains main trunk devices first, followed by devices on each branch.
+ * All branches are switched off when done.
+ *
+ * @param ctx Pointer to bus context.
+ * @param addr_list Pointer to array to store device (ROM) addresses.
+ * @param addr_list_size Size of addr_list (must have room for main trunk devices twice,
+ *                       as main trunk devices are visible also while searching a branch).
+ * @param devices_found Pointer to variable to store number of devices found.
+ *
+ * @note Only one level of couplers is supported (couplers found on a branch are not explored).
+ *
+ * @return Status code,
+ *         - -1, invalid parameters
+ *         - 0, success
+ *         - 1, bus reset failed (no devices found)
+ *         - 2, found more devices than addr_list_size
+ *         - 3, coupler did not confirm branch switching
+ */
+int pico_1wire_branch_discovery(pico_1wire_t *ctx, uint64_t *addr_list, uint addr_list_size, uint *devices_found);
+
+
+/**
+ * Switch on DS2409 coupler branch.
+ *
+ * Uses Smart-On command (coupler issues reset on the branch before connecting it),
+ * any other branch switched on by the library is switched off first. Nothing is sent
+ * if the branch is already on.
+ *
+ * @param ctx Pointer to bus context.
+ * @param coupler ROM Address of the coupler (0 = switch all branches off).
+ * @param branch Branch to switch on (PICO_1WIRE_BRANCH_xxx).
+ *
+ * @return Status code,
+ *         - -1, invalid parameters
+ *         - 0, success
+ *         - 1, no device found (coupler did not respond)
+ *         - 2, branch is on, but no devices responded on the branch
+ *         - 3, coupler did not confirm the command
+ */
+int pico_1wire_branch_on(pico_1wire_t *ctx, uint64_t coupler, uint branch);
+
+
+/**
+ * Switch off all DS2409 coupler branches.
+ *
+ * @param ctx Pointer to bus context.
+ *
+ * @return Status code,
+ *         - -1, invalid parameters
+ *         - 0, success
+ *         - 1, no device found
+ */
+int pico_1wire_branch_off(pico_1wire_t *ctx);
+
+
+/**
+ * Make device reachable, switching coupler branch if needed.
+ *
+ * Uses branch information stored in the device registry by pico_1wire_branch_discovery().
+ * Devices on main trunk (or not in the registry) are always reachable.
+ *
+ * Functions addressing a single device call this automatically, so calling it directly
+ * is only needed when accessing the device by other means.
+ *
+ * @param ctx Pointer to bus context.
+ * @param addr ROM Address of the device.
+ *
+ * @return Status code (see pico_1wire_branch_on()).
+ */
+int pico_1wire_branch_select(pico_1wire_t *ctx, uint64_t addr);
+
+
+/**
+ * Sort list of devices by coupler branch.
+ *
+ * Groups devices on the same branch together (main trunk devices first), keeping
+ * the original order within each group. Accessing devices in this order
+ * switches each branch only once per cycle.
+ *
+ * @param ctx Pointer to bus context.
+ * @param addr_list List of ROM Addresses to sort (in place).
+ * @param count Number of addresses in the list.
+ *
+ * @return Status code,
+ *         - -1, invalid parameters
+ *         - 0, success
+ */
+int pico_1wire_branch_sort(pico_1wire_t *ctx, uint64_t *addr_list, uint count);
+
+
 /**
  * Read Power Supply Status of devices in the bus.
  *
@@ -154,7 +715,9 @@ int pico_1wire_search_rom(pico_1wire_t *ctx, uint64_t  *addr_list, uint addr_lis
  * @param present Pointer to variable, that reports True if all devices in the bus
  *                have power supply. If set to NULL, power supply status is not returned.
  *
- * @note This function updates power supply status saved in the bus context
+ * @note This function updates power supply status saved in the bus context.
+ *       When addr is non-zero, only status of that device (in the device registry) is updated
+ *       and bus wide status is only changed if the device uses phantom power.
  *
  * @return Status code,
  *         - -1, invalid parameters
@@ -194,11 +757,15 @@ int pico_1wire_read_scratch_pad(pico_1wire_t *ctx,  uint64_t addr, uint8_t *buf)
  * @param addr ROM Address of the device to read.
  * @param buf Buffer that contains scratchpad memory to write to the device (must be at least 9 bytes long)
  *
+ * @note MAX31850/MAX31851 (family code 0x3B, shared with DS1825) scratchpad is read-only,
+ *       device is identified from scratchpad contents (read from device if not known yet).
+ *
  * @return Status code,
  *         - -1, invalid parameters
  *         - 0, success
  *         - 1, device not found
  *         - 2, bad checksum
+ *         - 3, device has no writable scratchpad (MAX31850/MAX31851)
  */
 int pico_1wire_write_scratch_pad(pico_1wire_t *ctx, uint64_t addr, uint8_t *buf);
 
@@ -233,7 +800,14 @@ int pico_1wire_convert_duration(pico_1wire_t *ctx, uint64_t addr, uint *duration
  * @param addr ROM Address of the device to read.
  * @param wait When true, function does not return until conversion is complete.
  *             (Otherwise function returns immediately).
-  *
+ *
+ * @note Strong pull-up is only used if addressed device (or any device when addr is 0)
+ *       uses phantom power. Otherwise, when wait is true, conversion completion is polled
+ *       from the device(s) and function returns as soon as conversion is complete.
+ *
+ * @note When addr is 0 and devices have been found behind DS2409 couplers, conversion
+ *       is broadcast to main trunk and then to each coupler branch in turn.
+ *
  * @return Status code,
  *         - -1, invalid parameters
  *         - 0, success
@@ -263,6 +837,36 @@ int pico_1wire_convert_temperature(pico_1wire_t *ctx, uint64_t addr, bool wait);
 int pico_1wire_get_temperature(pico_1wire_t *ctx, uint64_t addr, float *temperature);
 
 
+/**
+ * Retrieve temperature from a sensor, using cached reading if recent enough.
+ *
+ * This function returns last temperature read from the sensor if it is not older
+ * than given maximum age. Otherwise, if a conversion recent enough is already in progress
+ * on the sensor (started earlier using this context, for example by
+ * @ref pico_1wire_convert_temperature() without waiting, or by a "convert all" command),
+ * function waits for it to complete and reads the result. Only if neither is available,
+ * a new temperature conversion is initiated.
+ *
+ * @param ctx Pointer to bus context.
+ * @param addr ROM Address of the device to read.
+ * @param max_age Maximum acceptable age (ms) of the temperature measurement.
+ * @param temperature Pointer to variable to store the temperatue (in Celcius).
+ *
+ * @return Status code,
+ *         - -1, invalid parameters
+ *         - 0, success
+ *         - 1, no device found
+ *         - 2, unsupported device (temperature result may be inaccurate)
+ *
+ * @note Age of a measurement is counted from the start of the conversion.
+ *       Caching is only available for devices in the device registry (see @ref pico_1wire_search_rom()).
+ * @note Library does no locking: like other functions, this must not be called concurrently
+ *       on the same context. Tasks sharing a bus must serialize calls (for example with a mutex),
+ *       and then get the cached (or in progress) result instead of each converting again.
+ */
+int pico_1wire_get_temperature_cached(pico_1wire_t *ctx, uint64_t addr, uint max_age, float *temperature);
+
+
 /**
  * Get current temperature measurement resolution.
  *
@@ -302,6 +906,457 @@ int pico_1wire_get_resolution(pico_1wire_t *ctx, uint64_t addr, uint *resolution
 int pico_1wire_set_resolution(pico_1wire_t *ctx, uint64_t addr, uint resolution);
 
 
+/**
+ * Plan temperature conversions for a list of sensors.
+ *
+ * This function checks power supply status of each sensor and creates a plan
+ * for converting (and reading) temperature from all sensors in the list while
+ * keeping current drawn from the bus by phantom powered sensors within given budget.
+ *
+ * Broadcast conversion (Skip ROM) converts every sensor it reaches, so it is only used
+ * when the device registry is complete (see @ref pico_1wire_search_rom()), addr_list
+ * includes every phantom powered sensor the broadcast reaches, and those sensors fit in
+ * the budget together. Other phantom powered sensors are converted one at a time using
+ * Match ROM (strong pull-up keeps the bus busy until conversion completes, so selected
+ * conversions cannot overlap). Externally powered sensors that are not converted by
+ * a broadcast are converted at the start, and read during the first gap between
+ * strong pull-up periods.
+ *
+ * Sensors behind DS2409 couplers (see @ref pico_1wire_branch_discovery()) are grouped
+ * by branch. Broadcast conversion reaches main trunk and one branch, so each branch
+ * is checked separately (main trunk sensors convert along with each branch, and count
+ * against the budget), and only branches that fit use broadcast conversion.
+ *
+ * @param ctx Pointer to bus context.
+ * @param addr_list List of sensor (ROM) addresses.
+ * @param count Number of addresses in addr_list.
+ * @param current_budget Maximum current (uA) the bus can supply to phantom powered sensors.
+ * @param steps Array to store the plan.
+ * @param max_steps Size of the steps array (must be at least PICO_1WIRE_PLAN_MAX_STEPS(count)).
+ * @param step_count Pointer to variable to store number of steps in the plan.
+ *
+ * @return Status code,
+ *         - -1, invalid parameters
+ *         - 0, success
+ *         - 1, device not found
+ *         - 2, budget is too small to convert even one phantom powered sensor
+ *
+ * @note Plan can be executed (repeatedly) using @ref pico_1wire_run_conversion_plan().
+ */
+int pico_1wire_plan_conversions(pico_1wire_t *ctx, const uint64_t *addr_list, uint count,
+				uint current_budget, pico_1wire_plan_step_t *steps,
+				uint max_steps, uint *step_count);
+
+
+/**
+ * Execute temperature conversion plan.
+ *
+ * This function executes conversion plan created by @ref pico_1wire_plan_conversions().
+ * Function returns once all sensors in the plan have been read.
+ *
+ * @param ctx Pointer to bus context.
+ * @param addr_list List of sensor (ROM) addresses (same as used to create the plan).
+ * @param count Number of addresses in addr_list.
+ * @param steps Conversion plan.
+ * @param step_count Number of steps in the plan.
+ * @param temperatures Array to store temperatures read from the sensors (must be at least count long).
+ * @param results Array to store status code from @ref pico_1wire_get_temperature()
+ *                for each sensor. (If set to NULL, individual status codes are not returned.)
+ *
+ * @return Status code,
+ *         - -1, invalid parameters
+ *         - 0, success
+ *         - 1, no device(s) found
+ *         - 2, failed to read temperature from one or more sensors
+ */
+int pico_1wire_run_conversion_plan(pico_1wire_t *ctx, const uint64_t *addr_list, uint count,
+				const pico_1wire_plan_step_t *steps, uint step_count,
+				float *temperatures, int *results);
+
+
+/**
+ * Enable (or disable) adaptive resolution control.
+ *
+ * When enabled, each successful temperature reading with @ref pico_1wire_get_temperature()
+ * from sensors in the device registry is fed to a controller that lowers
+ * sensor resolution (and thus conversion time) when the reading is stable, and raises
+ * resolution to meet configured accuracy when reading changes fast or approaches
+ * one of the thresholds.
+ *
+ * @param ctx Pointer to bus context.
+ * @param config Pointer to controller configuration (set to NULL to disable controller).
+ *
+ * @return Status code,
+ *         - -1, invalid parameters
+ *         - 0, success
+ *
+ * @note Resolution changes are written to sensor scratchpad only (not to EEPROM).
+ *       Only sensors with configurable resolution are affected.
+ */
+int pico_1wire_set_adaptive_resolution(pico_1wire_t *ctx, const pico_1wire_adaptive_config_t *config);
+
+
+/**
+ * Copy Device Scratchpad to EEPROM.
+ *
+ * This function copies alarm thresholds (TH and TL registers) and
+ * configuration register from the scratchpad to EEPROM. Strong pull-up is
+ * used during EEPROM write when device(s) use phantom power.
+ *
+ * @param ctx Pointer to bus context.
+ * @param addr ROM Address of the device. Use 0 as address to copy scratchpad of all devices.
+ *
+ * @return Status code,
+ *         - -1, invalid parameters
+ *         - 0, success
+ *         - 1, device not found
+ */
+int pico_1wire_copy_scratch_pad(pico_1wire_t *ctx, uint64_t addr);
+
+
+/**
+ * Set temperature alarm thresholds.
+ *
+ * This function programs high (TH) and low (TL) temperature alarm threshold
+ * registers of a sensor. After temperature conversion, sensor will respond
+ * to Alarm Search (see @ref pico_1wire_alarm_search()) if measured temperature is
+ * higher than TH or lower than TL.
+ *
+ * @param ctx Pointer to bus context.
+ * @param addr ROM Address of the device.
+ * @param high High temperature threshold (C).
+ * @param low Low temperature threshold (C).
+ * @param save When true, thresholds are also copied to EEPROM.
+ *
+ * @return Status code,
+ *         - -1, invalid parameters
+ *         - 0, success
+ *         - 1, device not found
+ *         - 2, failed to update thresholds
+ *         - 3, device has no alarm thresholds (MAX31850/MAX31851)
+ */
+int pico_1wire_set_alarm(pico_1wire_t *ctx, uint64_t addr, int8_t high, int8_t low, bool save);
+
+
+/**
+ * Set temperature alarm thresholds on multiple sensors.
+ *
+ * This function programs alarm thresholds on each sensor in the list (see @ref pico_1wire_set_alarm()).
+ *
+ * @param ctx Pointer to bus context.
+ * @param addr_list List of sensor (ROM) addresses.
+ * @param high Array of high temperature thresholds (C), one for each sensor.
+ * @param low Array of low temperature thresholds (C), one for each sensor.
+ * @param count Number of sensors in addr_list.
+ * @param save Copy thresholds to EEPROM (PICO_1WIRE_SAVE_xxx),
+ *         - PICO_1WIRE_SAVE_NONE, thresholds are only written to scratchpad
+ *         - PICO_1WIRE_SAVE_DEVICES, scratchpad of each sensor in the list is copied to EEPROM
+ *         - PICO_1WIRE_SAVE_ALL, single Copy Scratchpad command is sent to all devices in the bus
+ *           (use only when every device in the bus is a sensor, and all are in the list)
+ *
+ * @return Status code,
+ *         - -1, invalid parameters
+ *         - 0, success
+ *         - 1, device not found
+ *         - 2, failed to update thresholds
+ *         - 3, device in the list has no alarm thresholds (MAX31850/MAX31851)
+ */
+int pico_1wire_set_alarms(pico_1wire_t *ctx, const uint64_t *addr_list, const int8_t *high,
+			const int8_t *low, uint count, uint save);
+
+
+/**
+ * Search (ROM) Addresses of devices with alarm condition.
+ *
+ * This function works like @ref pico_1wire_search_rom(), except only devices
+ * with alarm flag set (after last temperature conversion) will respond.
+ *
+ * @param ctx Pointer to bus context.
+ * @param addr_list Pointer to array to store found device (ROM) addresses.
+ * @param addr_list_size Size of addr_list.
+ * @param devices_found Pointer to variable to store number of devices found with alarm condition.
+ *
+ * @return Status code,
+ *         - -1, invalid parameters
+ *         - 0, success
+ *         - 1, bus reset failed (no devices found)
+ *         - 2, found more devices than addr_list_size
+ */
+int pico_1wire_alarm_search(pico_1wire_t *ctx, uint64_t *addr_list, uint addr_list_size, uint *devices_found);
+
+
+/**
+ * Perform threshold monitoring cycle.
+ *
+ * This function initiates temperature conversion on all devices, waits for conversion
+ * to complete and then performs Alarm Search to find sensors that are outside their
+ * alarm thresholds. Sensors within normal range only cost the broadcast conversion.
+ * Main trunk and each DS2409 coupler branch (see @ref pico_1wire_branch_discovery())
+ * are searched in turn.
+ *
+ * @param ctx Pointer to bus context.
+ * @param addr_list Pointer to array to store found device (ROM) addresses.
+ * @param addr_list_size Size of addr_list.
+ * @param devices_found Pointer to variable to store number of devices found with alarm condition.
+ *
+ * @return Status code,
+ *         - -1, invalid parameters
+ *         - 0, success
+ *         - 1, bus reset failed (no devices found)
+ *         - 2, found more devices than addr_list_size
+ */
+int pico_1wire_alarm_cycle(pico_1wire_t *ctx, uint64_t *addr_list, uint addr_list_size, uint *devices_found);
+
+
+/**
+ * Get instrumentation counters.
+ *
+ * @param ctx Pointer to bus context.
+ * @param stats Pointer to structure to store current counter values.
+ *
+ * @return Status code,
+ *         - -1, invalid parameters
+ *         - 0, success
+ *         - 1, counters not available (library compiled without PICO_1WIRE_STATS)
+ */
+int pico_1wire_get_stats(pico_1wire_t *ctx, pico_1wire_stats_t *stats);
+
+
+/**
+ * Reset instrumentation counters.
+ *
+ * @param ctx Pointer to bus context.
+ */
+void pico_1wire_reset_stats(pico_1wire_t *ctx);
+
+
+/**
+ * Select device(s) for a transaction.
+ *
+ * Resets the bus and sends ROM command to select device(s) for a transaction.
+ * Following function commands and data are sent using pico_1wire_write_block()
+ * and read using pico_1wire_read_block(). This allows talking to any type of 1-Wire device.
+ *
+ * Resume command is only supported by some device families (DS2408, DS2413, DS2431, DS28EC20,
+ * DS28EA00). It is used only if the device belongs to one of these families and was the last
+ * one selected using Match ROM, otherwise Match ROM is sent instead.
+ *
+ * @param ctx Pointer to bus context.
+ * @param mode Selection mode (PICO_1WIRE_SELECT_xxx).
+ * @param addr ROM Address of the device to select (ignored with PICO_1WIRE_SELECT_SKIP).
+ *
+ * @return Status code,
+ *         - -1, invalid parameters
+ *         - 0, success
+ *         - 1, bus reset failed (no devices found)
+ */
+int pico_1wire_select(pico_1wire_t *ctx, uint mode, uint64_t addr);
+
+
+/**
+ * Write block of data to the bus.
+ *
+ * Writes given bytes (LSB first) to the bus. Optionally strong pull-up is enabled right
+ * after last bit for given duration, to power parasitic device(s) during operation
+ * (for example EEPROM write or temperature conversion) started by the write.
+ *
+ * @param ctx Pointer to bus context.
+ * @param buf Pointer to data to write.
+ * @param len Number of bytes to write.
+ * @param pullup Duration (ms) to keep strong pull-up on after last bit (0 = no strong pull-up,
+ *               ignored when len is 0).
+ *
+ * @return Status code,
+ *         - -1, invalid parameters
+ *         - 0, success
+ */
+int pico_1wire_write_block(pico_1wire_t *ctx, const uint8_t *buf, uint len, uint pullup);
+
+
+/**
+ * Read block of data from the bus.
+ *
+ * @param ctx Pointer to bus context.
+ * @param buf Pointer to buffer to store data.
+ * @param len Number of bytes to read.
+ *
+ * @return Status code,
+ *         - -1, invalid parameters
+ *         - 0, success
+ */
+int pico_1wire_read_block(pico_1wire_t *ctx, uint8_t *buf, uint len);
+
+
+/**
+ * Calculate 1-Wire CRC-8 checksum.
+ *
+ * CRC-8 (polynomial x^8 + x^5 + x^4 + 1) protects ROM addresses and scratchpad
+ * contents. Checksum calculated over data and the received CRC byte is 0 when data is valid.
+ *
+ * @param crc Initial value (0, or result of previous call to continue calculation).
+ * @param buf Pointer to data.
+ * @param len Number of bytes.
+ *
+ * @return Updated CRC-8 value.
+ */
+uint8_t pico_1wire_crc8(uint8_t crc, const uint8_t *buf, uint len);
+
+
+/**
+ * Calculate 1-Wire CRC-16 checksum.
+ *
+ * CRC-16 (polynomial x^16 + x^15 + x^2 + 1) is used by memory and switch devices
+ * to protect commands and data. Devices send inverted CRC (LSB first), so checksum
+ * calculated over data and the received CRC bytes equals 0xB001 when data is valid.
+ *
+ * @param crc Initial value (0, or result of previous call to continue calculation).
+ * @param buf Pointer to data.
+ * @param len Number of bytes.
+ *
+ * @return Updated CRC-16 value.
+ */
+uint16_t pico_1wire_crc16(uint16_t crc, const uint8_t *buf, uint len);
+
+
+/**
+ * Execute a transaction described by list of operations.
+ *
+ * Operations are validated first, and then executed back to back in one call.
+ * Execution stops at first failing operation (a reset or select that gets no presence pulse).
+ *
+ * For PICO_1WIRE_OP_SELECT operations (with Match ROM or Resume mode) that have no address
+ * set, address passed to this function is used. This allows same static descriptor
+ * list to be used with multiple devices.
+ *
+ * @param ctx Pointer to bus context.
+ * @param ops Pointer to list of operations.
+ * @param count Number of operations in the list.
+ * @param addr ROM Address of the device for operations without address (can be 0 if not needed).
+ * @param completed Pointer to variable to store number of operations completed (can be NULL).
+ *
+ * @return Status code,
+ *         - -1, invalid parameters (no operations were executed)
+ *         - 0, success
+ *         - 1, bus reset failed (no devices found)
+ */
+int pico_1wire_run_transaction(pico_1wire_t *ctx, const pico_1wire_op_t *ops, uint count, uint64_t addr,
+			uint *completed);
+
+
+/**
+ * Register device family driver.
+ *
+ * Registers driver for given family code, replacing any previously registered
+ * (or built-in) driver for the same family. Driver structure must remain valid
+ * as long as the library is used.
+ *
+ * @param driver Pointer to driver.
+ *
+ * @return Status code,
+ *         - -1, invalid parameters
+ *         - 0, success
+ *         - 1, driver table full (see PICO_1WIRE_MAX_DRIVERS)
+ */
+int pico_1wire_register_driver(const pico_1wire_driver_t *driver);
+
+
+/**
+ * Get driver for a device.
+ *
+ * @param addr ROM Address of the device.
+ *
+ * @return Pointer to driver, or NULL if no driver is available for the device family.
+ */
+const pico_1wire_driver_t* pico_1wire_get_driver(uint64_t addr);
+
+
+/**
+ * Get driver for a device in the bus.
+ *
+ * Unlike pico_1wire_get_driver(), this identifies devices that share family code
+ * (such as DS1825 and MAX31850) from scratchpad contents. Result is cached in the
+ * device registry.
+ *
+ * @param ctx Pointer to bus context.
+ * @param addr ROM Address of the device.
+ *
+ * @return Pointer to driver, or NULL if no driver is available for the device.
+ */
+const pico_1wire_driver_t* pico_1wire_get_device_driver(pico_1wire_t *ctx, uint64_t addr);
+
+
+/**
+ * Set interrupt masking policy.
+ *
+ * Slot timing relies on busy-wait delays, so an interrupt that fires inside the
+ * timing-critical part of a slot can corrupt the bit. This sets whether interrupts are masked
+ * during slots:
+ *   - PICO_1WIRE_IRQ_NONE, interrupts are never masked (default).
+ *   - PICO_1WIRE_IRQ_CRITICAL, interrupts are masked only for the write "1" low pulse (3us) and
+ *     read slot up to the sample point (10us).
+ *   - PICO_1WIRE_IRQ_SLOT, additionally masks write "0" low pulse (60us) and presence
+ *     pulse detection after reset (up to 250us).
+ *
+ * Interrupts are never held off for longer than a single slot, recovery time between slots
+ * is always left unmasked.
+ *
+ * @param ctx Pointer to bus context.
+ * @param policy Masking policy (PICO_1WIRE_IRQ_xxx).
+ *
+ * @return Status code,
+ *         - -1, invalid parameters
+ *         - 0, success
+ */
+int pico_1wire_set_irq_policy(pico_1wire_t *ctx, uint policy);
+
+
+/**
+ * Read bit-level trace records.
+ *
+ * Copies records from the trace ring buffer, oldest record first. When more
+ * records have been written than fit in the ring buffer, oldest records are lost.
+ *
+ * @param ctx Pointer to bus context.
+ * @param buf Pointer to array to store trace records.
+ * @param size Size of buf (number of records).
+ * @param count Pointer to variable to store number of records copied.
+ *
+ * @return Status code,
+ *         - -1, invalid parameters
+ *         - 0, success
+ *         - 1, tracing not available (library compiled with PICO_1WIRE_TRACE_SIZE 0)
+ */
+int pico_1wire_trace_read(pico_1wire_t *ctx, pico_1wire_trace_t *buf, uint size, uint *count);
+
+
+/**
+ * Dump bit-level trace to stdout.
+ *
+ * Prints trace ring buffer contents (oldest record first) one record per line:
+ *
+ *     <timestamp> <R|W|r> <driven> <sampled>
+ *
+ * Where R is reset, W is write slot and r is read slot. Lines starting with '#' are comments.
+ * Output can be converted to VCD (for GTKWave) using pico_1wire_vcd tool (host build).
+ *
+ * @param ctx Pointer to bus context.
+ *
+ * @return Status code,
+ *         - -1, invalid parameters
+ *         - 0, success
+ *         - 1, tracing not available (library compiled with PICO_1WIRE_TRACE_SIZE 0)
+ */
+int pico_1wire_trace_dump(pico_1wire_t *ctx);
+
+
+/**
+ * Clear bit-level trace ring buffer.
+ *
+ * @param ctx Pointer to bus context.
+ */
+void pico_1wire_trace_clear(pico_1wire_t *ctx);
+
+
 #ifdef __cplusplus
 }
 #endif
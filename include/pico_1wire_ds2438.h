@@ -0,0 +1,128 @@
+/**
+ * @file pico_1wire_ds2438.h
+ *
+ * DS2438 smart battery monitor support for pico-1wire Library.
+ *
+ * Copyright (C) 2024 Timo Kokkonen <tjko@iki.fi>
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ *
+ * This file is part of pico-1wire Library.
+ *
+ * pico-1wire Library is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * pico-1wire Library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with pico-1wire Library. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef PICO_1WIRE_DS2438_H
+#define PICO_1WIRE_DS2438_H 1
+
+#include "pico_1wire.h"
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+
+/* Status/Configuration register bits */
+#define PICO_1WIRE_DS2438_IAD  0x01    /**< Current A/D (and ICA) enabled */
+#define PICO_1WIRE_DS2438_CA   0x02    /**< Current accumulators enabled */
+#define PICO_1WIRE_DS2438_EE   0x04    /**< Shadow current accumulators to EEPROM */
+#define PICO_1WIRE_DS2438_AD   0x08    /**< Voltage A/D input: 1 = VDD, 0 = VAD */
+
+
+/**
+ * DS2438 measurement (values in device fixed-point format).
+ */
+typedef struct pico_1wire_ds2438_t {
+	int16_t temperature;    /**< Temperature (1/256 C), 0.03125C resolution */
+	uint16_t voltage;       /**< Voltage (mV) of input selected by AD bit, 10mV resolution */
+	int16_t current;        /**< Current register, current (A) = current / (4096 * Rsens) */
+	uint8_t ica;            /**< Integrated Current Accumulator, charge (Ah) = ica / (2048 * Rsens) */
+	uint8_t status;         /**< Status/Configuration register */
+} pico_1wire_ds2438_t;
+
+
+/**
+ * Acquire temperature and voltage from multiple DS2438 devices.
+ *
+ * Results are read from memory page 0 (and page 1, for ICA) using Recall Memory and
+ * Read Scratchpad commands (device must be reset between the two).
+ *
+ * When device registry is complete and contains only DS2438 devices (see
+ * @ref pico_1wire_search_rom()), temperature and voltage conversions and Recall Memory
+ * are broadcast (Skip ROM) to all devices, and each device is selected only once per page read
+ * (about 14ms per device, 25ms with ICA).
+ *
+ * Otherwise each command is sent using Match ROM (DS2438 does not support Resume), so each
+ * device is selected four times (six with ICA). Temperature conversion is started on each
+ * device in turn, then voltage conversions, and results are read from each device as soon as
+ * its conversion has completed. This hides conversion time (10ms) behind bus traffic
+ * to other devices, but bus time is then the limit: Match ROM alone takes about 5.6ms
+ * (standard speed), so each device takes about 30ms (48ms with ICA).
+ *
+ * @param ctx Pointer to bus context.
+ * @param addr_list List of ROM Addresses of DS2438 devices.
+ * @param count Number of devices.
+ * @param results Pointer to array (count entries) to store the measurements in.
+ * @param ica If true, also read Integrated Current Accumulator (page 1).
+ *
+ * @return Status code,
+ *         - -1, invalid parameters
+ *         - 0, success
+ *         - 1, no device found (a device did not respond)
+ *         - 2, CRC error
+ */
+int pico_1wire_ds2438_acquire(pico_1wire_t *ctx, const uint64_t *addr_list, uint count,
+			pico_1wire_ds2438_t *results, bool ica);
+
+
+/**
+ * Read DS2438 memory page.
+ *
+ * Recalls page from memory to scratchpad and reads it.
+ *
+ * @param ctx Pointer to bus context.
+ * @param addr ROM Address of the device.
+ * @param page Page number (0..7).
+ * @param buf Pointer to buffer (8 bytes) to store page contents.
+ *
+ * @return Status code,
+ *         - -1, invalid parameters
+ *         - 0, success
+ *         - 1, no device found
+ *         - 2, CRC error
+ */
+int pico_1wire_ds2438_read_page(pico_1wire_t *ctx, uint64_t addr, uint page, uint8_t *buf);
+
+
+/**
+ * Set DS2438 Status/Configuration register.
+ *
+ * @param ctx Pointer to bus context.
+ * @param addr ROM Address of the device.
+ * @param config Configuration (PICO_1WIRE_DS2438_xxx bits).
+ *
+ * @return Status code,
+ *         - -1, invalid parameters
+ *         - 0, success
+ *         - 1, no device found
+ */
+int pico_1wire_ds2438_set_config(pico_1wire_t *ctx, uint64_t addr, uint8_t config);
+
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* PICO_1WIRE_DS2438_H */
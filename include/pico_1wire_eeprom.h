@@ -0,0 +1,141 @@
+/**
+ * @file pico_1wire_eeprom.h
+ *
+ * DS2431/DS28EC20 EEPROM support for pico-1wire Library.
+ *
+ * Copyright (C) 2024 Timo Kokkonen <tjko@iki.fi>
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ *
+ * This file is part of pico-1wire Library.
+ *
+ * pico-1wire Library is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * pico-1wire Library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with pico-1wire Library. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef PICO_1WIRE_EEPROM_H
+#define PICO_1WIRE_EEPROM_H 1
+
+#include "pico_1wire.h"
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+
+/** Number of memory pages cached per EEPROM device. */
+#ifndef PICO_1WIRE_EEPROM_CACHE_PAGES
+#define PICO_1WIRE_EEPROM_CACHE_PAGES 4
+#endif
+
+/** Size of memory page (bytes). */
+#define PICO_1WIRE_EEPROM_PAGE_SIZE 32
+
+
+/**
+ * EEPROM device handle.
+ *
+ * Handle is allocated by the caller and initialized using pico_1wire_eeprom_init().
+ * Recently read pages are cached in the handle (read-through cache), writes update
+ * the cache. Cache assumes that memory is only modified through this handle,
+ * use pico_1wire_eeprom_invalidate() if memory may have changed otherwise.
+ */
+typedef struct pico_1wire_eeprom_t {
+	pico_1wire_t *ctx;
+	uint64_t addr;
+	uint size;                    /**< Data memory size (bytes) */
+	uint row_size;                /**< Scratchpad size, write granularity (bytes) */
+	uint32_t cache_hits;          /**< Reads served from cache */
+	uint32_t cache_misses;        /**< Reads that required Read Memory command */
+	uint next_slot;
+	uint16_t page[PICO_1WIRE_EEPROM_CACHE_PAGES];
+	uint8_t cache[PICO_1WIRE_EEPROM_CACHE_PAGES][PICO_1WIRE_EEPROM_PAGE_SIZE];
+} pico_1wire_eeprom_t;
+
+
+/**
+ * Initialize EEPROM device handle.
+ *
+ * Supported devices are DS2431 (128 bytes, family 0x2D) and DS28EC20 (2560 bytes, family 0x43).
+ * This function does not access the bus.
+ *
+ * @param eeprom Pointer to handle to initialize.
+ * @param ctx Pointer to bus context.
+ * @param addr ROM Address of the device.
+ *
+ * @return Status code,
+ *         - -1, invalid parameters
+ *         - 0, success
+ *         - 2, unsupported device
+ */
+int pico_1wire_eeprom_init(pico_1wire_eeprom_t *eeprom, pico_1wire_t *ctx, uint64_t addr);
+
+
+/**
+ * Read data from EEPROM.
+ *
+ * Reads are served from the page cache when possible. Otherwise missing pages are
+ * read using single Read Memory command (streaming all requested pages), and stored
+ * in the cache.
+ *
+ * @param eeprom Pointer to EEPROM handle.
+ * @param offset Memory address to read from.
+ * @param buf Pointer to buffer to store data.
+ * @param len Number of bytes to read.
+ *
+ * @return Status code,
+ *         - -1, invalid parameters (or read beyond end of memory)
+ *         - 0, success
+ *         - 1, no device found
+ */
+int pico_1wire_eeprom_read(pico_1wire_eeprom_t *eeprom, uint offset, uint8_t *buf, uint len);
+
+
+/**
+ * Write data to EEPROM.
+ *
+ * Data is written one scratchpad row at a time (8 bytes on DS2431, 32 bytes on DS28EC20):
+ * Write Scratchpad, Read Scratchpad (verify data and CRC-16), and Copy Scratchpad with
+ * strong pull-up during programming. Partially written rows are first read, so that
+ * surrounding data is preserved. Rows that already contain given data (according to
+ * the cache) are not rewritten.
+ *
+ * @param eeprom Pointer to EEPROM handle.
+ * @param offset Memory address to write to.
+ * @param buf Pointer to data.
+ * @param len Number of bytes to write.
+ *
+ * @return Status code,
+ *         - -1, invalid parameters (or write beyond end of memory)
+ *         - 0, success
+ *         - 1, no device found
+ *         - 2, CRC error (or scratchpad contents did not match)
+ *         - 3, copy failed (memory write protected, or programming did not complete)
+ */
+int pico_1wire_eeprom_write(pico_1wire_eeprom_t *eeprom, uint offset, const uint8_t *buf, uint len);
+
+
+/**
+ * Invalidate EEPROM page cache.
+ *
+ * @param eeprom Pointer to EEPROM handle.
+ */
+void pico_1wire_eeprom_invalidate(pico_1wire_eeprom_t *eeprom);
+
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* PICO_1WIRE_EEPROM_H */
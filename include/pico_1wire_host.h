@@ -0,0 +1,131 @@
+/**
+ * @file pico_1wire_host.h
+ *
+ * Host (Linux) backend for pico-1wire Library.
+ *
+ * Copyright (C) 2024 Timo Kokkonen <tjko@iki.fi>
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ *
+ * This file is part of pico-1wire Library.
+ *
+ * pico-1wire Library is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * pico-1wire Library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with pico-1wire Library. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef PICO_1WIRE_HOST_H
+#define PICO_1WIRE_HOST_H 1
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+
+/* Pico SDK type used in the library API */
+typedef unsigned int uint;
+
+
+/**
+ * Host pin backend.
+ *
+ * When library is built for host, all GPIO operations are passed to a pin backend.
+ * Backend (for example a bus simulator) can use @ref pico_1wire_host_time_us()
+ * to determine when each operation takes place.
+ */
+typedef struct pico_1wire_host_backend_t {
+	void (*pin_init)(void *arg, uint pin);             /**< Initialize GPIO pin (optional) */
+	void (*pin_dir)(void *arg, uint pin, bool out);    /**< Set GPIO pin direction */
+	void (*pin_put)(void *arg, uint pin, bool value);  /**< Set GPIO pin output state */
+	bool (*pin_get)(void *arg, uint pin);              /**< Sample GPIO pin state */
+} pico_1wire_host_backend_t;
+
+
+/**
+ * Host I2C backend.
+ *
+ * I2C transfers (DS2482 bridge) are passed to I2C backend (for example a DS2482 model).
+ * Functions return number of bytes transferred, or negative value if device did not
+ * acknowledge (same as Pico SDK i2c_write_blocking()/i2c_read_blocking()).
+ */
+typedef struct pico_1wire_host_i2c_backend_t {
+	int (*write)(void *arg, uint bus, uint8_t addr, const uint8_t *buf, size_t len); /**< Write to device */
+	int (*read)(void *arg, uint bus, uint8_t addr, uint8_t *buf, size_t len);        /**< Read from device */
+} pico_1wire_host_i2c_backend_t;
+
+
+/**
+ * Set pin backend.
+ *
+ * @param backend Pointer to backend (set to NULL to use default backend,
+ *                where all pins read high unless driven low).
+ * @param arg Argument passed to backend functions.
+ */
+void pico_1wire_host_set_backend(const pico_1wire_host_backend_t *backend, void *arg);
+
+
+/**
+ * Set I2C backend.
+ *
+ * @param backend Pointer to backend (set to NULL to use default backend,
+ *                where no device acknowledges).
+ * @param arg Argument passed to backend functions.
+ */
+void pico_1wire_host_set_i2c_backend(const pico_1wire_host_i2c_backend_t *backend, void *arg);
+
+
+/**
+ * Return current time from the virtual clock.
+ *
+ * Virtual clock only advances when library (or program) sleeps,
+ * so library runs at full speed on host while timing stays exact.
+ *
+ * @return Time (in microseconds) since start.
+ */
+uint64_t pico_1wire_host_time_us(void);
+
+
+/**
+ * Advance virtual clock.
+ *
+ * @param us Number of microseconds to advance the clock.
+ */
+void pico_1wire_host_sleep_us(uint64_t us);
+
+
+/**
+ * Reset virtual clock back to zero.
+ */
+void pico_1wire_host_reset_clock(void);
+
+
+/* Pin functions used by the library (passed to the backend). */
+void pico_1wire_host_pin_init(uint pin);
+void pico_1wire_host_pin_dir(uint pin, bool out);
+void pico_1wire_host_pin_put(uint pin, bool value);
+bool pico_1wire_host_pin_get(uint pin);
+
+/* I2C functions used by the library (passed to the I2C backend). */
+int pico_1wire_host_i2c_write(uint bus, uint8_t addr, const uint8_t *buf, size_t len);
+int pico_1wire_host_i2c_read(uint bus, uint8_t addr, uint8_t *buf, size_t len);
+
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* PICO_1WIRE_HOST_H */
@@ -0,0 +1,95 @@
+/**
+ * @file pico_1wire_max31850.h
+ *
+ * MAX31850/MAX31851 thermocouple interface support for pico-1wire Library.
+ *
+ * Copyright (C) 2024 Timo Kokkonen <tjko@iki.fi>
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ *
+ * This file is part of pico-1wire Library.
+ *
+ * pico-1wire Library is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * pico-1wire Library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with pico-1wire Library. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef PICO_1WIRE_MAX31850_H
+#define PICO_1WIRE_MAX31850_H 1
+
+#include "pico_1wire.h"
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+
+/* Thermocouple fault status bits */
+#define PICO_1WIRE_TC_FAULT_OPEN      0x01   /**< Thermocouple open circuit */
+#define PICO_1WIRE_TC_FAULT_SHORT_GND 0x02   /**< Thermocouple shorted to GND */
+#define PICO_1WIRE_TC_FAULT_SHORT_VDD 0x04   /**< Thermocouple shorted to VDD */
+
+
+/**
+ * Thermocouple measurement.
+ */
+typedef struct pico_1wire_thermocouple_t {
+	float temperature;      /**< Thermocouple temperature (C), 0.25C resolution */
+	float cold_junction;    /**< Cold-junction (device internal) temperature (C), 0.0625C resolution */
+	uint8_t fault;          /**< Fault status (PICO_1WIRE_TC_FAULT_xxx bits), 0 if no fault */
+	uint8_t address;        /**< Hardware address set by AD0..AD3 pins (0..15) */
+} pico_1wire_thermocouple_t;
+
+
+/**
+ * Decode MAX31850/MAX31851 scratchpad contents.
+ *
+ * @param scratch Scratchpad contents (9 bytes) as returned by @ref pico_1wire_read_scratch_pad().
+ * @param tc Pointer to structure to store the measurement in.
+ *
+ * @return Status code,
+ *         - -1, invalid parameters
+ *         - 0, success
+ *         - 3, thermocouple fault (see fault field)
+ */
+int pico_1wire_max31850_decode(const uint8_t *scratch, pico_1wire_thermocouple_t *tc);
+
+
+/**
+ * Get latest thermocouple measurement from MAX31850/MAX31851.
+ *
+ * Conversion must be started first (see @ref pico_1wire_convert_temperature()).
+ * MAX31850 shares family code (0x3B) with DS1825/MAX31826, device is identified from
+ * the scratchpad contents (configuration register bit 7 is set on MAX31850, clear on DS1825).
+ * MAX31826 can not be told apart this way (bit 7 is set as on MAX31850), and is
+ * identified (and decoded) as MAX31850.
+ *
+ * @param ctx Pointer to bus context.
+ * @param addr ROM Address of the device to read.
+ * @param tc Pointer to structure to store the measurement in.
+ *
+ * @return Status code,
+ *         - -1, invalid parameters
+ *         - 0, success
+ *         - 1, no device found
+ *         - 2, device is not a MAX31850/MAX31851
+ *         - 3, thermocouple fault (see fault field)
+ */
+int pico_1wire_get_thermocouple(pico_1wire_t *ctx, uint64_t addr, pico_1wire_thermocouple_t *tc);
+
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* PICO_1WIRE_MAX31850_H */
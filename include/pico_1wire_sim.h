@@ -0,0 +1,298 @@
+/**
+ * @file pico_1wire_sim.h
+ *
+ * Virtual 1-Wire bus simulator for host (Linux) builds of pico-1wire Library.
+ *
+ * Copyright (C) 2024 Timo Kokkonen <tjko@iki.fi>
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ *
+ * This file is part of pico-1wire Library.
+ *
+ * pico-1wire Library is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * pico-1wire Library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with pico-1wire Library. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef PICO_1WIRE_SIM_H
+#define PICO_1WIRE_SIM_H 1
+
+#include "pico_1wire_host.h"
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+
+/**
+ * Simulated bus instance.
+ *
+ * Simulator attaches to the host pin backend and models 1-Wire bus with wired-AND
+ * semantics. Master (library) slots are decoded from pin edges using the virtual clock,
+ * and each simulated device runs its own ROM and function command state machine.
+ */
+typedef struct pico_1wire_sim_t pico_1wire_sim_t;
+
+/** Simulated device. */
+typedef struct pico_1wire_sim_device_t pico_1wire_sim_device_t;
+
+/**
+ * Simulated DS2482 I2C-to-1-Wire bridge.
+ *
+ * Model of DS2482 I2C registers and commands, attached to the host I2C backend.
+ * 1-Wire commands generate slots (with DS2482 timing) on simulated buses attached
+ * to the bridge channels, and status is available immediately after the command.
+ */
+typedef struct pico_1wire_sim_ds2482_t pico_1wire_sim_ds2482_t;
+
+
+/** Line fault: no fault */
+#define PICO_1WIRE_SIM_FAULT_NONE       0
+/** Line fault: data line is held low permanently */
+#define PICO_1WIRE_SIM_FAULT_STUCK_LOW  1
+/** Line fault: data line is held low for 1ms after every reset pulse */
+#define PICO_1WIRE_SIM_FAULT_SHORT      2
+
+
+/**
+ * Simulator statistics.
+ */
+typedef struct pico_1wire_sim_stats_t {
+	uint64_t resets;          /**< Reset pulses */
+	uint64_t presence;        /**< Resets answered with presence pulse */
+	uint64_t write0_slots;    /**< Write "0" slots */
+	uint64_t write1_slots;    /**< Write "1" slots */
+	uint64_t read_slots;      /**< Read slots */
+	uint64_t power_faults;    /**< Conversions (or EEPROM writes) failed due to missing or late (>10us) strong pull-up */
+	uint parasitic_peak;      /**< Highest number of phantom powered devices converting at the same time */
+} pico_1wire_sim_stats_t;
+
+
+/**
+ * Create simulated bus and attach it to the host pin backend.
+ *
+ * @param data_pin GPIO pin used as 1-Wire data (DQ) line.
+ * @param power_pin GPIO pin controlling strong pull-up MOSFET (-1 if none).
+ * @param power_polarity GPIO state that turns strong pull-up on.
+ *
+ * @return Pointer to simulator instance, or NULL on error.
+ */
+pico_1wire_sim_t* pico_1wire_sim_create(uint data_pin, int power_pin, bool power_polarity);
+
+
+/**
+ * Destroy simulated bus (and all devices), and detach it from the host pin backend.
+ *
+ * @param sim Pointer to simulator instance.
+ */
+void pico_1wire_sim_destroy(pico_1wire_sim_t *sim);
+
+
+/**
+ * Add device to simulated bus.
+ *
+ * Device model is selected based on family code of the ROM address. Currently
+ * supported are DS18B20 compatible sensors (families 0x22, 0x28, 0x3B, 0x42),
+ * DS18S20 (0x10), DS2431 EEPROM (0x2D), DS28EC20 EEPROM (0x43), DS2408 (0x29) /
+ * DS2413 (0x3A) switches, DS2438 battery monitor (0x26) and DS2409 MicroLAN coupler (0x1F).
+ *
+ * DS28EA00 devices support chain mode (sequence detection), PIOA/PIOB chain is
+ * wired in the order devices are added.
+ *
+ * @param sim Pointer to simulator instance.
+ * @param addr ROM address (in library format, use @ref pico_1wire_sim_rom() to generate one).
+ * @param parasitic If true, device uses phantom power.
+ *
+ * @return Pointer to simulated device, or NULL if family is not supported.
+ */
+pico_1wire_sim_device_t* pico_1wire_sim_add_device(pico_1wire_sim_t *sim, uint64_t addr, bool parasitic);
+
+
+/**
+ * Add device of specific model to simulated bus.
+ *
+ * This allows adding devices that cannot be selected by family code alone,
+ * such as MAX31850 thermocouple interface (family 0x3B, shared with DS1825).
+ *
+ * @param sim Pointer to simulator instance.
+ * @param addr ROM address (in library format, use @ref pico_1wire_sim_rom() to generate one).
+ * @param name Model name ("DS18B20", "DS18S20", "DS28EA00", "DS2431", "DS28EC20", "DS2408",
+ *        "DS2413", "DS2438", "DS2409", "MAX31850"), or NULL to select model based on family code.
+ * @param parasitic If true, device uses phantom power.
+ *
+ * @return Pointer to simulated device, or NULL if model is not supported.
+ */
+pico_1wire_sim_device_t* pico_1wire_sim_add_device_model(pico_1wire_sim_t *sim, uint64_t addr,
+							 const char *name, bool parasitic);
+
+
+/**
+ * Add multiple devices with pseudo random serial numbers.
+ *
+ * @param sim Pointer to simulator instance.
+ * @param family Family code of the devices.
+ * @param count Number of devices to add.
+ * @param parasitic If true, devices use phantom power.
+ * @param seed Seed for serial number generation.
+ *
+ * @return Number of devices added.
+ */
+uint pico_1wire_sim_add_devices(pico_1wire_sim_t *sim, uint8_t family, uint count, bool parasitic, uint32_t seed);
+
+
+/**
+ * Return number of devices on simulated bus.
+ */
+uint pico_1wire_sim_device_count(pico_1wire_sim_t *sim);
+
+
+/**
+ * Return device on simulated bus.
+ *
+ * @param sim Pointer to simulator instance.
+ * @param index Index of the device (in the order devices were added).
+ *
+ * @return Pointer to simulated device, or NULL if index is out of range.
+ */
+pico_1wire_sim_device_t* pico_1wire_sim_device(pico_1wire_sim_t *sim, uint index);
+
+
+/**
+ * Return ROM address of simulated device.
+ */
+uint64_t pico_1wire_sim_device_addr(pico_1wire_sim_device_t *dev);
+
+
+/**
+ * Connect device behind DS2409 coupler.
+ *
+ * Device is only visible on the bus while given branch of the coupler is switched on.
+ * By default devices are connected to the main trunk.
+ *
+ * @param dev Pointer to simulated device.
+ * @param coupler Pointer to simulated DS2409 device, or NULL to connect device to the main trunk.
+ * @param branch Coupler branch (0 = main, 1 = auxiliary).
+ *
+ * @return Status code,
+ *         - -1, invalid parameters
+ *         - 0, success
+ */
+int pico_1wire_sim_set_branch(pico_1wire_sim_device_t *dev, pico_1wire_sim_device_t *coupler, uint branch);
+
+
+/**
+ * Set temperature measured by simulated sensor (on next conversion).
+ */
+void pico_1wire_sim_set_temperature(pico_1wire_sim_device_t *dev, float temperature);
+
+
+/**
+ * Inject fault on the data line.
+ *
+ * @param sim Pointer to simulator instance.
+ * @param fault Fault type (PICO_1WIRE_SIM_FAULT_xxx), PICO_1WIRE_SIM_FAULT_NONE clears the fault.
+ */
+void pico_1wire_sim_set_line_fault(pico_1wire_sim_t *sim, int fault);
+
+
+/**
+ * Inject bit error in data transmitted by simulated device.
+ *
+ * Inverts one bit of function command layer data (scratchpad, memory, status etc.)
+ * the device transmits next. Error is injected once.
+ *
+ * @param dev Pointer to simulated device.
+ * @param bit Number of transmitted bits to skip before the inverted bit (-1 cancels pending error).
+ *
+ * @return Status code,
+ *         - -1, invalid parameters
+ *         - 0, success
+ */
+int pico_1wire_sim_corrupt_bit(pico_1wire_sim_device_t *dev, int bit);
+
+
+/**
+ * Return pointer to memory of simulated device (EEPROM), or NULL if device has no memory.
+ *
+ * @param dev Pointer to simulated device.
+ * @param size Pointer to variable to store size of the memory (in bytes).
+ */
+uint8_t* pico_1wire_sim_memory(pico_1wire_sim_device_t *dev, uint *size);
+
+
+/**
+ * Generate ROM address (with valid CRC).
+ *
+ * @param family Family code.
+ * @param serial Serial number (48 bits).
+ *
+ * @return ROM address in the format used by the library.
+ */
+uint64_t pico_1wire_sim_rom(uint8_t family, uint64_t serial);
+
+
+/**
+ * Create simulated DS2482 bridge and attach it to the host I2C backend.
+ *
+ * @param i2c_bus I2C controller bridge is connected to.
+ * @param i2c_addr I2C address of the bridge.
+ * @param channels Number of 1-Wire channels (1 = DS2482-100, 8 = DS2482-800).
+ *
+ * @return Pointer to simulated bridge, or NULL if function failed.
+ */
+pico_1wire_sim_ds2482_t* pico_1wire_sim_ds2482_create(uint i2c_bus, uint8_t i2c_addr, uint channels);
+
+
+/**
+ * Destroy simulated DS2482 bridge, and detach it from the host I2C backend.
+ *
+ * Simulated buses attached to the bridge are not destroyed.
+ */
+void pico_1wire_sim_ds2482_destroy(pico_1wire_sim_ds2482_t *bridge);
+
+
+/**
+ * Connect simulated bus to a channel of the bridge.
+ *
+ * Bridge drives the bus data line directly, and provides strong pull-up (SPU),
+ * so bus should be created without power pin. Channels without a bus behave as
+ * an empty bus.
+ *
+ * @param bridge Pointer to simulated bridge.
+ * @param channel Bridge channel (0 for DS2482-100).
+ * @param sim Pointer to simulated bus (NULL to disconnect).
+ *
+ * @return Status code,
+ *         - -1, invalid parameters
+ *         - 0, success
+ */
+int pico_1wire_sim_ds2482_attach(pico_1wire_sim_ds2482_t *bridge, uint channel, pico_1wire_sim_t *sim);
+
+
+/**
+ * Get simulator statistics.
+ */
+void pico_1wire_sim_get_stats(pico_1wire_sim_t *sim, pico_1wire_sim_stats_t *stats);
+
+
+/**
+ * Clear simulator statistics.
+ */
+void pico_1wire_sim_reset_stats(pico_1wire_sim_t *sim);
+
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* PICO_1WIRE_SIM_H */
@@ -0,0 +1,147 @@
+/**
+ * @file pico_1wire_switch.h
+ *
+ * DS2408/DS2413 addressable switch support for pico-1wire Library.
+ *
+ * Copyright (C) 2024 Timo Kokkonen <tjko@iki.fi>
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ *
+ * This file is part of pico-1wire Library.
+ *
+ * pico-1wire Library is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * pico-1wire Library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with pico-1wire Library. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef PICO_1WIRE_SWITCH_H
+#define PICO_1WIRE_SWITCH_H 1
+
+#include "pico_1wire.h"
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+
+/**
+ * Addressable switch device handle.
+ *
+ * Handle is allocated by the caller and initialized using pico_1wire_switch_init().
+ *
+ * PIO channel states are given as bit masks (bit 0 = PIO0/PIOA, bit 1 = PIO1/PIOB, ...).
+ * For output latches, 0 turns output transistor on (pulls PIO pin low) and 1 turns it off.
+ */
+typedef struct pico_1wire_switch_t {
+	pico_1wire_t *ctx;
+	uint64_t addr;
+	uint channels;                /**< Number of PIO channels (8 on DS2408, 2 on DS2413) */
+	uint8_t latch;                /**< Last output latch state written */
+} pico_1wire_switch_t;
+
+
+/**
+ * Initialize switch device handle.
+ *
+ * Supported devices are DS2408 (8 channels, family 0x29) and DS2413 (2 channels, family 0x3A).
+ * This function does not access the bus.
+ *
+ * @param sw Pointer to handle to initialize.
+ * @param ctx Pointer to bus context.
+ * @param addr ROM Address of the device.
+ *
+ * @return Status code,
+ *         - -1, invalid parameters
+ *         - 0, success
+ *         - 2, unsupported device
+ */
+int pico_1wire_switch_init(pico_1wire_switch_t *sw, pico_1wire_t *ctx, uint64_t addr);
+
+
+/**
+ * Read current PIO pin states.
+ *
+ * On DS2408 this reads PIO Logic State register (protected by CRC-16), on DS2413
+ * this uses Channel Access Read (status byte is protected by its complement).
+ *
+ * @param sw Pointer to switch handle.
+ * @param state Pointer to variable to store pin states.
+ *
+ * @return Status code,
+ *         - -1, invalid parameters
+ *         - 0, success
+ *         - 1, no device found
+ *         - 2, CRC error
+ */
+int pico_1wire_switch_read(pico_1wire_switch_t *sw, uint8_t *state);
+
+
+/**
+ * Sample PIO pin states continuously.
+ *
+ * Device is selected once and pin states are then streamed using Channel Access Read,
+ * one sample per byte. On DS2408 samples are read in blocks of 32, each verified
+ * using CRC-16 (extra samples of the last block are discarded).
+ *
+ * @param sw Pointer to switch handle.
+ * @param buf Pointer to buffer to store samples (pin states).
+ * @param count Number of samples to read (nothing is sent to the bus if 0).
+ *
+ * @return Status code,
+ *         - -1, invalid parameters
+ *         - 0, success
+ *         - 1, no device found
+ *         - 2, CRC error
+ */
+int pico_1wire_switch_sample(pico_1wire_switch_t *sw, uint8_t *buf, uint count);
+
+
+/**
+ * Write sequence of output latch states.
+ *
+ * Device is selected once and all values are streamed
+ * using single Channel Access Write command. Each value is sent with its complement,
+ * and device confirms each update (0xAA) before returning new pin state.
+ *
+ * @param sw Pointer to switch handle.
+ * @param values Pointer to output latch states to write (in order).
+ * @param count Number of values (nothing is sent to the bus if 0).
+ * @param state Pointer to variable to store pin states after last update (can be NULL).
+ *
+ * @return Status code,
+ *         - -1, invalid parameters
+ *         - 0, success
+ *         - 1, no device found
+ *         - 3, update not confirmed by device
+ */
+int pico_1wire_switch_write(pico_1wire_switch_t *sw, const uint8_t *values, uint count, uint8_t *state);
+
+
+/**
+ * Set output latch state.
+ *
+ * Convenience wrapper for pico_1wire_switch_write() with single value.
+ *
+ * @param sw Pointer to switch handle.
+ * @param latch Output latch state.
+ *
+ * @return Status code (see pico_1wire_switch_write()).
+ */
+int pico_1wire_switch_set(pico_1wire_switch_t *sw, uint8_t latch);
+
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* PICO_1WIRE_SWITCH_H */
@@ -0,0 +1,144 @@
+/* pico_1wire_host.c
+
+   Copyright (C) 2024 Timo Kokkonen <tjko@iki.fi>
+
+   SPDX-License-Identifier: GPL-3.0-or-later
+
+   This file is part of pico-1wire Library.
+
+   pico-1wire Library is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   pico-1wire Library is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with pico-1wire Library. If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "pico_1wire_host.h"
+
+
+#define MAX_PINS 64
+
+
+static uint64_t virtual_time = 0;
+
+static const pico_1wire_host_backend_t *backend = NULL;
+static void *backend_arg = NULL;
+
+static const pico_1wire_host_i2c_backend_t *i2c_backend = NULL;
+static void *i2c_backend_arg = NULL;
+
+/* Default backend state: pins pulled high, unless driven low. */
+static bool pin_out[MAX_PINS];
+static bool pin_state[MAX_PINS];
+
+
+void pico_1wire_host_set_backend(const pico_1wire_host_backend_t *b, void *arg)
+{
+	backend = b;
+	backend_arg = arg;
+}
+
+
+void pico_1wire_host_set_i2c_backend(const pico_1wire_host_i2c_backend_t *b, void *arg)
+{
+	i2c_backend = b;
+	i2c_backend_arg = arg;
+}
+
+
+uint64_t pico_1wire_host_time_us(void)
+{
+	return virtual_time;
+}
+
+
+void pico_1wire_host_sleep_us(uint64_t us)
+{
+	virtual_time += us;
+}
+
+
+void pico_1wire_host_reset_clock(void)
+{
+	virtual_time = 0;
+}
+
+
+void pico_1wire_host_pin_init(uint pin)
+{
+	if (backend) {
+		if (backend->pin_init)
+			backend->pin_init(backend_arg, pin);
+		return;
+	}
+
+	if (pin < MAX_PINS) {
+		pin_out[pin] = false;
+		pin_state[pin] = false;
+	}
+}
+
+
+void pico_1wire_host_pin_dir(uint pin, bool out)
+{
+	if (backend) {
+		backend->pin_dir(backend_arg, pin, out);
+		return;
+	}
+
+	if (pin < MAX_PINS)
+		pin_out[pin] = out;
+}
+
+
+void pico_1wire_host_pin_put(uint pin, bool value)
+{
+	if (backend) {
+		backend->pin_put(backend_arg, pin, value);
+		return;
+	}
+
+	if (pin < MAX_PINS)
+		pin_state[pin] = value;
+}
+
+
+bool pico_1wire_host_pin_get(uint pin)
+{
+	if (backend)
+		return backend->pin_get(backend_arg, pin);
+
+	if (pin < MAX_PINS && pin_out[pin])
+		return pin_state[pin];
+
+	return true;
+}
+
+
+int pico_1wire_host_i2c_write(uint bus, uint8_t addr, const uint8_t *buf, size_t len)
+{
+	if (i2c_backend)
+		return i2c_backend->write(i2c_backend_arg, bus, addr, buf, len);
+
+	return -1;
+}
+
+
+int pico_1wire_host_i2c_read(uint bus, uint8_t addr, uint8_t *buf, size_t len)
+{
+	if (i2c_backend)
+		return i2c_backend->read(i2c_backend_arg, bus, addr, buf, len);
+
+	return -1;
+}
@@ -0,0 +1,972 @@
+/* pico_1wire_sim.c
+
+   Copyright (C) 2024 Timo Kokkonen <tjko@iki.fi>
+
+   SPDX-License-Identifier: GPL-3.0-or-later
+
+   This file is part of pico-1wire Library.
+
+   pico-1wire Library is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   pico-1wire Library is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with pico-1wire Library. If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "pico_1wire_sim_internal.h"
+
+
+/* ROM Commands */
+#define CMD_SEARCH         0xF0
+#define CMD_READ           0x33
+#define CMD_MATCH          0x55
+#define CMD_SKIP           0xCC
+#define CMD_ALARM_SEARCH   0xEC
+#define CMD_RESUME         0xA5
+#define CMD_COND_READ      0x0F
+
+/* Slot timing (as seen by devices) */
+#define RESET_MIN_LEN      480    /* Reset pulse minimum length */
+#define WRITE_ONE_MAX_LEN  15     /* Low time longer than this is "0" */
+#define PRESENCE_DELAY     30     /* Presence pulse start after reset pulse (15-60us) */
+#define PRESENCE_LEN       120    /* Presence pulse length (60-240us) */
+#define TX_ZERO_LEN        30     /* Time device holds line low when sending "0" (15-60us) */
+#define SHORT_LEN          1000   /* Time line is held low after reset pulse (PICO_1WIRE_SIM_FAULT_SHORT) */
+#define SPU_MAX_DELAY      10     /* Strong pull-up must be on within 10us of operation start */
+
+/* ROM layer states */
+enum {
+	SIM_IDLE = 0,
+	SIM_ROM_CMD,
+	SIM_ROM_MATCH,
+	SIM_ROM_SEARCH,
+	SIM_ROM_READ,
+	SIM_FUNCTION,
+};
+
+
+struct pico_1wire_sim_t {
+	uint data_pin;
+	int power_pin;
+	bool power_polarity;
+
+	/* Master pin state */
+	bool data_out;
+	bool data_val;
+	bool power_out;
+	bool power_val;
+	bool spu;
+	bool master_low;
+	uint64_t t_fall;
+
+	/* Time window when device(s) hold the line low */
+	uint64_t dev_low_from;
+	uint64_t dev_low_until;
+	int line_fault;
+
+	pico_1wire_sim_device_t **devices;
+	uint device_count;
+	uint device_cap;
+
+	/* Devices currently participating in ROM/function command */
+	pico_1wire_sim_device_t **active;
+	uint active_count;
+
+	int state;
+	uint8_t cmd;
+	uint bit_index;
+	uint search_phase;
+
+	/* Phantom powered operations in progress */
+	uint64_t parasitic_busy_until;
+	uint64_t load_time;
+	uint load_count;
+
+	pico_1wire_sim_stats_t stats;
+};
+
+
+static const uint8_t crc8_table[] = {
+	0, 94, 188, 226, 97, 63, 221, 131, 194, 156, 126, 32, 163, 253, 31, 65,
+	157, 195, 33, 127, 252, 162, 64, 30, 95, 1, 227, 189, 62, 96, 130, 220,
+	35, 125, 159, 193, 66, 28, 254, 160, 225, 191, 93, 3, 128, 222, 60, 98,
+	190, 224, 2, 92, 223, 129, 99, 61, 124, 34, 192, 158, 29, 67, 161, 255,
+	70, 24, 250, 164, 39, 121, 155, 197, 132, 218, 56, 102, 229, 187, 89, 7,
+	219, 133, 103, 57, 186, 228, 6, 88, 25, 71, 165, 251, 120, 38, 196, 154,
+	101, 59, 217, 135, 4, 90, 184, 230, 167, 249, 27, 69, 198, 152, 122, 36,
+	248, 166, 68, 26, 153, 199, 37, 123, 58, 100, 134, 216, 91, 5, 231, 185,
+	140, 210, 48, 110, 237, 179, 81, 15, 78, 16, 242, 172, 47, 113, 147, 205,
+	17, 79, 173, 243, 112, 46, 204, 146, 211, 141, 111, 49, 178, 236, 14, 80,
+	175, 241, 19, 77, 206, 144, 114, 44, 109, 51, 209, 143, 12, 82, 176, 238,
+	50, 108, 142, 208, 83, 13, 239, 177, 240, 174, 76, 18, 145, 207, 45, 115,
+	202, 148, 118, 40, 171, 245, 23, 73, 8, 86, 180, 234, 105, 55, 213, 139,
+	87, 9, 235, 181, 54, 104, 138, 212, 149, 203, 41, 119, 244, 170, 72, 22,
+	233, 183, 85, 11, 136, 214, 52, 106, 43, 117, 151, 201, 74, 20, 246, 168,
+	116, 42, 200, 150, 21, 75, 169, 247, 182, 232, 10, 84, 215, 137, 107, 53
+};
+
+
+uint8_t sim_crc8(uint8_t crc, uint8_t data)
+{
+	return crc8_table[crc ^ data];
+}
+
+
+uint16_t sim_crc16(uint16_t crc, uint8_t data)
+{
+	crc ^= data;
+	for (int i = 0; i < 8; i++)
+		crc = (crc & 1) ? (crc >> 1) ^ 0xa001 : crc >> 1;
+
+	return crc;
+}
+
+
+uint64_t sim_time_us(void)
+{
+	return pico_1wire_host_time_us();
+}
+
+
+static inline bool rom_bit(const pico_1wire_sim_device_t *dev, uint bit)
+{
+	return (dev->rom[bit >> 3] >> (bit & 7)) & 1;
+}
+
+
+/* Device transmit/receive helpers */
+
+void sim_tx_queue(pico_1wire_sim_device_t *dev, const uint8_t *buf, uint len)
+{
+	if (dev->tx_pos >= dev->tx_len * 8) {
+		dev->tx_len = 0;
+		dev->tx_pos = 0;
+	}
+	if (dev->tx_len + len > SIM_TX_BUF_SIZE)
+		len = SIM_TX_BUF_SIZE - dev->tx_len;
+	memcpy(&dev->tx_buf[dev->tx_len], buf, len);
+	dev->tx_len += len;
+}
+
+
+void sim_tx_clear(pico_1wire_sim_device_t *dev)
+{
+	dev->tx_len = 0;
+	dev->tx_pos = 0;
+}
+
+
+static int dev_tx_bit(pico_1wire_sim_device_t *dev)
+{
+	if (dev->tx_pos >= dev->tx_len * 8) {
+		sim_tx_clear(dev);
+		if (dev->model->tx_refill)
+			dev->model->tx_refill(dev);
+	}
+	if (dev->tx_pos < dev->tx_len * 8)
+		return (dev->tx_buf[dev->tx_pos >> 3] >> (dev->tx_pos & 7)) & 1;
+
+	return (dev->model->idle_bit ? dev->model->idle_bit(dev) : -1);
+}
+
+
+static void dev_rx_bit(pico_1wire_sim_device_t *dev, bool bit)
+{
+	dev->rx_data |= (bit << dev->rx_bits);
+	if (++dev->rx_bits == 8) {
+		uint8_t data = dev->rx_data;
+		dev->rx_data = 0;
+		dev->rx_bits = 0;
+		dev->model->rx_byte(dev, data);
+	}
+}
+
+
+static void dev_reset(pico_1wire_sim_device_t *dev)
+{
+	dev->rx_data = 0;
+	dev->rx_bits = 0;
+	dev->tx_now = false;
+	sim_tx_clear(dev);
+	if (dev->model->reset)
+		dev->model->reset(dev);
+}
+
+
+/* Operations (conversions, EEPROM writes) */
+
+void sim_start_operation(pico_1wire_sim_device_t *dev, uint64_t duration)
+{
+	pico_1wire_sim_t *sim = dev->sim;
+	uint64_t now = sim_time_us();
+
+	dev->busy_start = now;
+	dev->busy_until = now + duration;
+	dev->power_fault = false;
+	dev->spu_seen = sim->spu;
+
+	if (!dev->parasitic)
+		return;
+
+	if (dev->busy_until > sim->parasitic_busy_until)
+		sim->parasitic_busy_until = dev->busy_until;
+
+	/* Keep track of current drawn from the bus by phantom powered devices. */
+	if (sim->load_time == now) {
+		sim->load_count++;
+	} else {
+		sim->load_time = now;
+		sim->load_count = 0;
+		for (uint i = 0; i < sim->device_count; i++) {
+			if (sim->devices[i]->parasitic && sim_busy(sim->devices[i]))
+				sim->load_count++;
+		}
+	}
+	if (sim->load_count > sim->stats.parasitic_peak)
+		sim->stats.parasitic_peak = sim->load_count;
+}
+
+
+bool sim_busy(pico_1wire_sim_device_t *dev)
+{
+	return (dev->busy_start && sim_time_us() < dev->busy_until);
+}
+
+
+int sim_finish_operation(pico_1wire_sim_device_t *dev)
+{
+	if (!dev->busy_start || sim_time_us() < dev->busy_until)
+		return -1;
+
+	dev->busy_start = 0;
+	if (dev->parasitic && (dev->power_fault || !dev->spu_seen)) {
+		dev->sim->stats.power_faults++;
+		return 0;
+	}
+
+	return 1;
+}
+
+
+static void parasitic_check(pico_1wire_sim_t *sim, bool power_lost)
+{
+	uint64_t now = sim_time_us();
+
+	if (now >= sim->parasitic_busy_until)
+		return;
+
+	for (uint i = 0; i < sim->device_count; i++) {
+		pico_1wire_sim_device_t *dev = sim->devices[i];
+
+		if (!dev->parasitic || !sim_busy(dev))
+			continue;
+		if (power_lost) {
+			dev->power_fault = true;
+		} else if (!dev->spu_seen) {
+			/* Device ran from parasite capacitor too long before strong pull-up. */
+			if (now - dev->busy_start > SPU_MAX_DELAY)
+				dev->power_fault = true;
+			dev->spu_seen = true;
+		}
+	}
+}
+
+
+/* ROM command layer */
+
+static void filter_active(pico_1wire_sim_t *sim, uint bit, bool value)
+{
+	uint n = 0;
+
+	for (uint i = 0; i < sim->active_count; i++) {
+		if (rom_bit(sim->active[i], bit) == value)
+			sim->active[n++] = sim->active[i];
+	}
+	sim->active_count = n;
+}
+
+
+static void enter_function(pico_1wire_sim_t *sim)
+{
+	sim->state = (sim->active_count > 0 ? SIM_FUNCTION : SIM_IDLE);
+}
+
+
+static void rom_selected(pico_1wire_sim_t *sim)
+{
+	/* Device selected by Match ROM or Search ROM can be selected later using Resume */
+	if (sim->active_count == 1)
+		sim->active[0]->rc = true;
+	enter_function(sim);
+}
+
+
+/* Chain mode: device EN input is driven by the previous chain capable device on the bus
+   (devices are wired in the order they were added), first device has EN input active. */
+static bool chain_enabled(pico_1wire_sim_t *sim, pico_1wire_sim_device_t *dev)
+{
+	pico_1wire_sim_device_t *prev = NULL;
+
+	for (uint i = 0; i < sim->device_count && sim->devices[i] != dev; i++) {
+		if (sim->devices[i]->model->chain)
+			prev = sim->devices[i];
+	}
+
+	return (!prev || prev->chain == SIM_CHAIN_DONE);
+}
+
+
+static void rom_command(pico_1wire_sim_t *sim, uint8_t cmd)
+{
+	uint n = 0;
+
+	sim->bit_index = 0;
+	sim->search_phase = 0;
+
+	if (cmd == CMD_RESUME) {
+		for (uint i = 0; i < sim->active_count; i++) {
+			pico_1wire_sim_device_t *dev = sim->active[i];
+			if (dev->rc && dev->model->resume)
+				sim->active[n++] = dev;
+		}
+		sim->active_count = n;
+		enter_function(sim);
+		return;
+	}
+
+	for (uint i = 0; i < sim->device_count; i++)
+		sim->devices[i]->rc = false;
+
+	switch (cmd) {
+	case CMD_READ:
+		sim->state = SIM_ROM_READ;
+		break;
+	case CMD_MATCH:
+		sim->state = SIM_ROM_MATCH;
+		break;
+	case CMD_SKIP:
+		enter_function(sim);
+		break;
+	case CMD_COND_READ:
+		/* Only device in chain mode with active EN input responds */
+		for (uint i = 0; i < sim->active_count; i++) {
+			pico_1wire_sim_device_t *dev = sim->active[i];
+			if (dev->chain == SIM_CHAIN_ON && chain_enabled(sim, dev))
+				sim->active[n++] = dev;
+		}
+		sim->active_count = n;
+		sim->state = SIM_ROM_READ;
+		break;
+	case CMD_ALARM_SEARCH:
+	{
+		uint n = 0;
+		for (uint i = 0; i < sim->active_count; i++) {
+			pico_1wire_sim_device_t *dev = sim->active[i];
+			if (dev->model->alarm && dev->model->alarm(dev))
+				sim->active[n++] = dev;
+		}
+		sim->active_count = n;
+		sim->state = SIM_ROM_SEARCH;
+		break;
+	}
+	case CMD_SEARCH:
+		sim->state = SIM_ROM_SEARCH;
+		break;
+	default:
+		sim->active_count = 0;
+		sim->state = SIM_IDLE;
+		break;
+	}
+
+	if (sim->active_count == 0)
+		sim->state = SIM_IDLE;
+}
+
+
+/* Device is connected to the master if it is on main trunk, or the coupler branch
+   it is behind is connected (and coupler itself is connected). */
+static bool dev_connected(pico_1wire_sim_device_t *dev)
+{
+	for (; dev->coupler; dev = dev->coupler) {
+		if (dev->coupler->branch_on != dev->branch)
+			return false;
+	}
+
+	return true;
+}
+
+
+bool sim_branch_present(pico_1wire_sim_device_t *coupler, int branch)
+{
+	pico_1wire_sim_t *sim = coupler->sim;
+
+	for (uint i = 0; i < sim->device_count; i++) {
+		if (sim->devices[i]->coupler == coupler && sim->devices[i]->branch == branch)
+			return true;
+	}
+
+	return false;
+}
+
+
+static void bus_reset(pico_1wire_sim_t *sim, uint64_t now)
+{
+	sim->stats.resets++;
+
+	for (uint i = 0; i < sim->active_count; i++)
+		dev_reset(sim->active[i]);
+
+	sim->active_count = 0;
+	for (uint i = 0; i < sim->device_count; i++) {
+		pico_1wire_sim_device_t *dev = sim->devices[i];
+		if (!dev_connected(dev))
+			continue;
+		/* Device (re)connected by coupler may not have seen previous reset */
+		if (dev->coupler)
+			dev_reset(dev);
+		sim->active[sim->active_count++] = dev;
+	}
+	sim->state = (sim->active_count > 0 ? SIM_ROM_CMD : SIM_IDLE);
+	sim->cmd = 0;
+	sim->bit_index = 0;
+
+	if (sim->active_count > 0) {
+		sim->stats.presence++;
+		sim->dev_low_from = now + PRESENCE_DELAY;
+		sim->dev_low_until = now + PRESENCE_DELAY + PRESENCE_LEN;
+	}
+	if (sim->line_fault == PICO_1WIRE_SIM_FAULT_SHORT) {
+		sim->dev_low_from = now;
+		sim->dev_low_until = now + SHORT_LEN;
+	}
+}
+
+
+static void slot_start(pico_1wire_sim_t *sim, uint64_t now)
+{
+	bool out = true;
+
+	/* Any bus activity interrupts operations of phantom powered devices. */
+	parasitic_check(sim, true);
+
+	switch (sim->state) {
+	case SIM_ROM_SEARCH:
+		if (sim->search_phase == 0) {
+			for (uint i = 0; i < sim->active_count && out; i++)
+				out = rom_bit(sim->active[i], sim->bit_index);
+		} else if (sim->search_phase == 1) {
+			for (uint i = 0; i < sim->active_count && out; i++)
+				out = !rom_bit(sim->active[i], sim->bit_index);
+		}
+		break;
+
+	case SIM_ROM_READ:
+		for (uint i = 0; i < sim->active_count; i++)
+			out &= rom_bit(sim->active[i], sim->bit_index);
+		break;
+
+	case SIM_FUNCTION:
+		for (uint i = 0; i < sim->active_count; i++) {
+			pico_1wire_sim_device_t *dev = sim->active[i];
+			int b = dev_tx_bit(dev);
+			dev->tx_now = (b >= 0);
+			if (b >= 0 && dev->corrupt_bit >= 0 && dev->corrupt_bit-- == 0)
+				b = !b;
+			if (b == 0)
+				out = false;
+		}
+		break;
+
+	default:
+		break;
+	}
+
+	if (!out) {
+		sim->dev_low_from = now;
+		sim->dev_low_until = now + TX_ZERO_LEN;
+	}
+}
+
+
+static void slot_end(pico_1wire_sim_t *sim, uint64_t now, bool released)
+{
+	uint64_t len = now - sim->t_fall;
+	bool bit;
+
+	if (len >= RESET_MIN_LEN) {
+		bus_reset(sim, now);
+		return;
+	}
+
+	bit = (len < WRITE_ONE_MAX_LEN);
+	if (!bit)
+		sim->stats.write0_slots++;
+	else if (released)
+		sim->stats.read_slots++;
+	else
+		sim->stats.write1_slots++;
+
+	switch (sim->state) {
+	case SIM_ROM_CMD:
+		sim->cmd |= (bit << sim->bit_index);
+		if (++sim->bit_index == 8)
+			rom_command(sim, sim->cmd);
+		break;
+
+	case SIM_ROM_MATCH:
+		filter_active(sim, sim->bit_index, bit);
+		if (++sim->bit_index == 64)
+			rom_selected(sim);
+		else if (sim->active_count == 0)
+			sim->state = SIM_IDLE;
+		break;
+
+	case SIM_ROM_SEARCH:
+		if (sim->search_phase < 2) {
+			sim->search_phase++;
+			break;
+		}
+		sim->search_phase = 0;
+		filter_active(sim, sim->bit_index, bit);
+		if (++sim->bit_index == 64)
+			rom_selected(sim);
+		else if (sim->active_count == 0)
+			sim->state = SIM_IDLE;
+		break;
+
+	case SIM_ROM_READ:
+		if (++sim->bit_index == 64)
+			enter_function(sim);
+		break;
+
+	case SIM_FUNCTION:
+		for (uint i = 0; i < sim->active_count; i++) {
+			pico_1wire_sim_device_t *dev = sim->active[i];
+			if (dev->tx_now) {
+				dev->tx_now = false;
+				if (dev->tx_pos < dev->tx_len * 8)
+					dev->tx_pos++;
+			} else {
+				dev_rx_bit(dev, bit);
+			}
+		}
+		break;
+
+	default:
+		break;
+	}
+}
+
+
+static void update_master(pico_1wire_sim_t *sim, bool released)
+{
+	bool low = sim->data_out && !sim->data_val;
+	uint64_t now = sim_time_us();
+
+	if (low && !sim->master_low) {
+		sim->master_low = true;
+		sim->t_fall = now;
+		slot_start(sim, now);
+	}
+	else if (!low && sim->master_low) {
+		sim->master_low = false;
+		slot_end(sim, now, released);
+	}
+}
+
+
+static void update_power(pico_1wire_sim_t *sim)
+{
+	bool spu = sim->power_out && (sim->power_val == sim->power_polarity);
+
+	if (spu == sim->spu)
+		return;
+	sim->spu = spu;
+	parasitic_check(sim, !spu);
+}
+
+
+/* Host pin backend */
+
+static void sim_pin_init(void *arg, uint pin)
+{
+	pico_1wire_sim_t *sim = arg;
+
+	if (pin == sim->data_pin) {
+		sim->data_out = false;
+		sim->data_val = false;
+		update_master(sim, true);
+	} else if ((int)pin == sim->power_pin) {
+		sim->power_out = false;
+		sim->power_val = false;
+		update_power(sim);
+	}
+}
+
+
+static void sim_pin_dir(void *arg, uint pin, bool out)
+{
+	pico_1wire_sim_t *sim = arg;
+
+	if (pin == sim->data_pin) {
+		sim->data_out = out;
+		update_master(sim, !out);
+	} else if ((int)pin == sim->power_pin) {
+		sim->power_out = out;
+		update_power(sim);
+	}
+}
+
+
+static void sim_pin_put(void *arg, uint pin, bool value)
+{
+	pico_1wire_sim_t *sim = arg;
+
+	if (pin == sim->data_pin) {
+		sim->data_val = value;
+		update_master(sim, false);
+	} else if ((int)pin == sim->power_pin) {
+		sim->power_val = value;
+		update_power(sim);
+	}
+}
+
+
+static bool sim_pin_get(void *arg, uint pin)
+{
+	pico_1wire_sim_t *sim = arg;
+	uint64_t now = sim_time_us();
+
+	if (pin == sim->data_pin) {
+		if (sim->master_low || sim->line_fault == PICO_1WIRE_SIM_FAULT_STUCK_LOW)
+			return false;
+		if (now >= sim->dev_low_from && now < sim->dev_low_until)
+			return false;
+		return true;
+	}
+	if ((int)pin == sim->power_pin)
+		return (sim->power_out ? sim->power_val : true);
+
+	return true;
+}
+
+
+static const pico_1wire_host_backend_t sim_backend = {
+	.pin_init = sim_pin_init,
+	.pin_dir = sim_pin_dir,
+	.pin_put = sim_pin_put,
+	.pin_get = sim_pin_get,
+};
+
+
+/* Bus master other than the library (DS2482 model) */
+
+void sim_master_drive(pico_1wire_sim_t *sim, bool value)
+{
+	sim->data_val = value;
+	sim->data_out = true;
+	update_master(sim, false);
+}
+
+
+void sim_master_release(pico_1wire_sim_t *sim)
+{
+	sim->data_out = false;
+	update_master(sim, true);
+}
+
+
+bool sim_master_sample(pico_1wire_sim_t *sim)
+{
+	return sim_pin_get(sim, sim->data_pin);
+}
+
+
+void sim_master_pullup(pico_1wire_sim_t *sim, bool on)
+{
+	sim->power_out = true;
+	sim->power_val = (on ? sim->power_polarity : !sim->power_polarity);
+	update_power(sim);
+}
+
+
+
+/*****************************/
+/* Exposed Simulator Functions */
+
+
+pico_1wire_sim_t* pico_1wire_sim_create(uint data_pin, int power_pin, bool power_polarity)
+{
+	pico_1wire_sim_t *sim;
+
+	if (!(sim = calloc(1, sizeof(pico_1wire_sim_t))))
+		return NULL;
+
+	sim->data_pin = data_pin;
+	sim->power_pin = power_pin;
+	sim->power_polarity = power_polarity;
+	sim->state = SIM_IDLE;
+
+	pico_1wire_host_set_backend(&sim_backend, sim);
+
+	return sim;
+}
+
+
+void pico_1wire_sim_destroy(pico_1wire_sim_t *sim)
+{
+	if (!sim)
+		return;
+
+	pico_1wire_host_set_backend(NULL, NULL);
+
+	for (uint i = 0; i < sim->device_count; i++) {
+		pico_1wire_sim_device_t *dev = sim->devices[i];
+		if (dev->model->destroy)
+			dev->model->destroy(dev);
+		free(dev);
+	}
+	free(sim->devices);
+	free(sim->active);
+	free(sim);
+}
+
+
+static const sim_model_t *sim_models[] = {
+	&sim_model_ds18b20,
+	&sim_model_ds18s20,
+	&sim_model_ds28ea00,
+	&sim_model_ds2431,
+	&sim_model_ds28ec20,
+	&sim_model_ds2408,
+	&sim_model_ds2413,
+	&sim_model_ds2438,
+	&sim_model_ds2409,
+	&sim_model_max31850,
+};
+
+
+static const sim_model_t* family_model(uint8_t family)
+{
+	switch (family) {
+	case 0x22:
+	case 0x28:
+	case 0x3b:
+		return &sim_model_ds18b20;
+	case 0x42:
+		return &sim_model_ds28ea00;
+	case 0x10:
+		return &sim_model_ds18s20;
+	case 0x2d:
+		return &sim_model_ds2431;
+	case 0x43:
+		return &sim_model_ds28ec20;
+	case 0x29:
+		return &sim_model_ds2408;
+	case 0x3a:
+		return &sim_model_ds2413;
+	case 0x26:
+		return &sim_model_ds2438;
+	case 0x1f:
+		return &sim_model_ds2409;
+	default:
+		return NULL;
+	}
+}
+
+
+pico_1wire_sim_device_t* pico_1wire_sim_add_device(pico_1wire_sim_t *sim, uint64_t addr, bool parasitic)
+{
+	return pico_1wire_sim_add_device_model(sim, addr, NULL, parasitic);
+}
+
+
+pico_1wire_sim_device_t* pico_1wire_sim_add_device_model(pico_1wire_sim_t *sim, uint64_t addr,
+							 const char *name, bool parasitic)
+{
+	const sim_model_t *model = NULL;
+	pico_1wire_sim_device_t *dev;
+
+	if (!sim)
+		return NULL;
+
+	if (!name) {
+		model = family_model(addr >> 56);
+	} else {
+		for (uint i = 0; i < sizeof(sim_models) / sizeof(sim_models[0]); i++) {
+			if (!strcmp(sim_models[i]->name, name))
+				model = sim_models[i];
+		}
+	}
+	if (!model)
+		return NULL;
+
+	if (sim->device_count >= sim->device_cap) {
+		uint cap = (sim->device_cap ? sim->device_cap * 2 : 16);
+		pico_1wire_sim_device_t **d = realloc(sim->devices, cap * sizeof(*d));
+		if (!d)
+			return NULL;
+		sim->devices = d;
+		if (!(d = realloc(sim->active, cap * sizeof(*d))))
+			return NULL;
+		sim->active = d;
+		sim->device_cap = cap;
+	}
+
+	if (!(dev = calloc(1, sizeof(pico_1wire_sim_device_t))))
+		return NULL;
+
+	dev->sim = sim;
+	dev->model = model;
+	dev->addr = addr;
+	dev->parasitic = parasitic;
+	dev->corrupt_bit = -1;
+	dev->branch_on = SIM_BRANCH_NONE;
+	for (int i = 0; i < 8; i++)
+		dev->rom[i] = (addr >> (8 * (7 - i))) & 0xff;
+
+	if (model->init && !model->init(dev)) {
+		free(dev);
+		return NULL;
+	}
+
+	sim->devices[sim->device_count++] = dev;
+
+	return dev;
+}
+
+
+uint pico_1wire_sim_add_devices(pico_1wire_sim_t *sim, uint8_t family, uint count, bool parasitic, uint32_t seed)
+{
+	uint64_t x = ((uint64_t)seed << 32) | 0x9e3779b9;
+	uint added = 0;
+
+	for (uint i = 0; i < count; i++) {
+		/* xorshift64 */
+		x ^= x << 13;
+		x ^= x >> 7;
+		x ^= x << 17;
+		if (!pico_1wire_sim_add_device(sim, pico_1wire_sim_rom(family, x), parasitic))
+			break;
+		added++;
+	}
+
+	return added;
+}
+
+
+uint pico_1wire_sim_device_count(pico_1wire_sim_t *sim)
+{
+	return (sim ? sim->device_count : 0);
+}
+
+
+pico_1wire_sim_device_t* pico_1wire_sim_device(pico_1wire_sim_t *sim, uint index)
+{
+	if (!sim || index >= sim->device_count)
+		return NULL;
+
+	return sim->devices[index];
+}
+
+
+uint64_t pico_1wire_sim_device_addr(pico_1wire_sim_device_t *dev)
+{
+	return (dev ? dev->addr : 0);
+}
+
+
+int pico_1wire_sim_set_branch(pico_1wire_sim_device_t *dev, pico_1wire_sim_device_t *coupler, uint branch)
+{
+	if (!dev || dev == coupler || branch > SIM_BRANCH_AUX)
+		return -1;
+	if (coupler && coupler->model != &sim_model_ds2409)
+		return -1;
+
+	dev->coupler = coupler;
+	dev->branch = branch;
+
+	return 0;
+}
+
+
+void pico_1wire_sim_set_temperature(pico_1wire_sim_device_t *dev, float temperature)
+{
+	if (dev && dev->model->set_temperature)
+		dev->model->set_temperature(dev, temperature);
+}
+
+
+void pico_1wire_sim_set_line_fault(pico_1wire_sim_t *sim, int fault)
+{
+	if (!sim)
+		return;
+
+	sim->line_fault = fault;
+	if (fault == PICO_1WIRE_SIM_FAULT_NONE)
+		sim->dev_low_until = 0;
+}
+
+
+int pico_1wire_sim_corrupt_bit(pico_1wire_sim_device_t *dev, int bit)
+{
+	if (!dev || bit < -1)
+		return -1;
+
+	dev->corrupt_bit = bit;
+	return 0;
+}
+
+
+uint8_t* pico_1wire_sim_memory(pico_1wire_sim_device_t *dev, uint *size)
+{
+	if (!dev || !size || !dev->model->memory)
+		return NULL;
+
+	return dev->model->memory(dev, size);
+}
+
+
+uint64_t pico_1wire_sim_rom(uint8_t family, uint64_t serial)
+{
+	uint8_t rom[8];
+	uint8_t crc = 0;
+	uint64_t addr = 0;
+
+	rom[0] = family;
+	for (int i = 1; i < 7; i++)
+		rom[i] = (serial >> (8 * (i - 1))) & 0xff;
+	for (int i = 0; i < 7; i++)
+		crc = sim_crc8(crc, rom[i]);
+	rom[7] = crc;
+
+	for (int i = 0; i < 8; i++)
+		addr = (addr << 8) | rom[i];
+
+	return addr;
+}
+
+
+void pico_1wire_sim_get_stats(pico_1wire_sim_t *sim, pico_1wire_sim_stats_t *stats)
+{
+	if (sim && stats)
+		*stats = sim->stats;
+}
+
+
+void pico_1wire_sim_reset_stats(pico_1wire_sim_t *sim)
+{
+	if (sim)
+		memset(&sim->stats, 0, sizeof(sim->stats));
+}
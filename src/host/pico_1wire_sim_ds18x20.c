@@ -0,0 +1,349 @@
+/* pico_1wire_sim_ds18x20.c
+
+   Copyright (C) 2024 Timo Kokkonen <tjko@iki.fi>
+
+   SPDX-License-Identifier: GPL-3.0-or-later
+
+   This file is part of pico-1wire Library.
+
+   pico-1wire Library is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   pico-1wire Library is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with pico-1wire Library. If not, see <https://www.gnu.org/licenses/>.
+*/
+
+/* DS18B20 (and compatible), DS28EA00 and DS18S20 temperature sensor models. */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+#include "pico_1wire_sim_internal.h"
+
+
+/* Function Commands */
+#define CMD_CONVERT            0x44
+#define CMD_WRITE_SCRATCHPAD   0x4E
+#define CMD_READ_SCRATCHPAD    0xBE
+#define CMD_COPY_SCRATCHPAD    0x48
+#define CMD_RECALL             0xB8
+#define CMD_READ_POWER_SUPPLY  0xB4
+#define CMD_CHAIN              0x99
+
+#define CHAIN_OFF              0x3C
+#define CHAIN_ON               0x5A
+#define CHAIN_DONE             0x96
+#define CHAIN_CONFIRM          0xAA
+
+#define COPY_TIME              10000   /* 10ms */
+#define POWER_ON_TEMP          85.0
+
+
+typedef struct ds18x20_t {
+	bool ds18s20;
+	float temperature;
+	uint8_t scratch[9];
+	uint8_t eeprom[3];     /* TH, TL, Configuration */
+	uint8_t cmd;
+	uint rx_count;
+	uint8_t chain_ctrl;
+	bool converting;
+	bool copying;
+	bool alarm;
+} ds18x20_t;
+
+
+static uint resolution(ds18x20_t *s)
+{
+	return (s->ds18s20 ? 9 : ((s->scratch[4] >> 5) & 0x03) + 9);
+}
+
+
+static void update_crc(ds18x20_t *s)
+{
+	uint8_t crc = 0;
+
+	for (int i = 0; i < 8; i++)
+		crc = sim_crc8(crc, s->scratch[i]);
+	s->scratch[8] = crc;
+}
+
+
+static void store_temperature(ds18x20_t *s, float temp)
+{
+	int integer;
+
+	if (s->ds18s20) {
+		/* Temperature is reported in 0.5C units, with count remain register
+		   providing higher resolution. */
+		int base = (int)floorf(temp + 0.25f);
+		int remain = 16 - (int)((temp - base + 0.25f) * 16);
+		int16_t raw = base * 2;
+		if (remain < 1)
+			remain = 1;
+		s->scratch[0] = raw & 0xff;
+		s->scratch[1] = (raw >> 8) & 0xff;
+		s->scratch[6] = remain;
+		s->scratch[7] = 16;
+		integer = base;
+	} else {
+		static const int16_t mask[] = { ~7, ~3, ~1, ~0 };
+		int16_t raw = (int16_t)floorf(temp * 16) & mask[resolution(s) - 9];
+		s->scratch[0] = raw & 0xff;
+		s->scratch[1] = (raw >> 8) & 0xff;
+		integer = raw >> 4;
+	}
+
+	s->alarm = (integer >= (int8_t)s->scratch[2] || integer <= (int8_t)s->scratch[3]);
+	update_crc(s);
+}
+
+
+static void complete(pico_1wire_sim_device_t *dev)
+{
+	ds18x20_t *s = dev->priv;
+	int res = sim_finish_operation(dev);
+
+	if (res < 0)
+		return;
+
+	if (s->converting) {
+		s->converting = false;
+		/* Device that lost power during conversion resets to power-on value. */
+		store_temperature(s, (res ? s->temperature : POWER_ON_TEMP));
+	}
+	if (s->copying) {
+		s->copying = false;
+		if (res)
+			memcpy(s->eeprom, &s->scratch[2], (s->ds18s20 ? 2 : 3));
+	}
+}
+
+
+static bool init(pico_1wire_sim_device_t *dev, bool ds18s20)
+{
+	ds18x20_t *s;
+
+	if (!(s = calloc(1, sizeof(ds18x20_t))))
+		return false;
+
+	s->ds18s20 = ds18s20;
+	s->temperature = 25.0;
+	s->eeprom[0] = 75;
+	s->eeprom[1] = 70;
+	s->eeprom[2] = 0x7f;
+
+	s->scratch[2] = s->eeprom[0];
+	s->scratch[3] = s->eeprom[1];
+	s->scratch[4] = (ds18s20 ? 0xff : s->eeprom[2]);
+	s->scratch[5] = 0xff;
+	s->scratch[6] = 0x0c;
+	s->scratch[7] = 0x10;
+	store_temperature(s, POWER_ON_TEMP);
+	s->alarm = false;
+
+	dev->priv = s;
+
+	return true;
+}
+
+
+static bool ds18b20_init(pico_1wire_sim_device_t *dev)
+{
+	return init(dev, false);
+}
+
+
+static bool ds18s20_init(pico_1wire_sim_device_t *dev)
+{
+	return init(dev, true);
+}
+
+
+static void destroy(pico_1wire_sim_device_t *dev)
+{
+	free(dev->priv);
+}
+
+
+static void reset(pico_1wire_sim_device_t *dev)
+{
+	ds18x20_t *s = dev->priv;
+
+	s->cmd = 0;
+	s->rx_count = 0;
+}
+
+
+static void chain_control(pico_1wire_sim_device_t *dev, uint8_t data)
+{
+	ds18x20_t *s = dev->priv;
+	static const uint8_t confirm = CHAIN_CONFIRM;
+
+	/* Control byte followed by its complement */
+	if (s->rx_count++ == 0) {
+		s->chain_ctrl = data;
+		return;
+	}
+	if (s->rx_count != 2 || (uint8_t)(data ^ s->chain_ctrl) != 0xff)
+		return;
+
+	switch (s->chain_ctrl) {
+	case CHAIN_OFF:
+		dev->chain = SIM_CHAIN_OFF;
+		break;
+	case CHAIN_ON:
+		dev->chain = SIM_CHAIN_ON;
+		break;
+	case CHAIN_DONE:
+		dev->chain = SIM_CHAIN_DONE;
+		break;
+	default:
+		return;
+	}
+	sim_tx_queue(dev, &confirm, 1);
+}
+
+
+static void rx_byte(pico_1wire_sim_device_t *dev, uint8_t data)
+{
+	ds18x20_t *s = dev->priv;
+	static const uint conv_time[] = { 93750, 187500, 375000, 750000 };
+
+	complete(dev);
+
+	if (s->cmd == CMD_CHAIN) {
+		chain_control(dev, data);
+		return;
+	}
+
+	if (s->cmd == CMD_WRITE_SCRATCHPAD) {
+		if (s->rx_count == 0)
+			s->scratch[2] = data;
+		else if (s->rx_count == 1)
+			s->scratch[3] = data;
+		else if (s->rx_count == 2 && !s->ds18s20)
+			s->scratch[4] = (data & 0x60) | 0x1f;
+		s->rx_count++;
+		update_crc(s);
+		return;
+	}
+	if (s->cmd)
+		return;
+
+	s->cmd = data;
+	s->rx_count = 0;
+
+	switch (data) {
+	case CMD_CONVERT:
+		s->converting = true;
+		sim_start_operation(dev, conv_time[resolution(s) - 9]);
+		break;
+	case CMD_READ_SCRATCHPAD:
+		sim_tx_queue(dev, s->scratch, sizeof(s->scratch));
+		break;
+	case CMD_COPY_SCRATCHPAD:
+		s->copying = true;
+		sim_start_operation(dev, COPY_TIME);
+		break;
+	case CMD_RECALL:
+		memcpy(&s->scratch[2], s->eeprom, (s->ds18s20 ? 2 : 3));
+		update_crc(s);
+		break;
+	case CMD_WRITE_SCRATCHPAD:
+	case CMD_READ_POWER_SUPPLY:
+		break;
+	case CMD_CHAIN:
+		if (!dev->model->chain)
+			s->cmd = 0xff;
+		break;
+	default:
+		s->cmd = 0xff;
+		break;
+	}
+}
+
+
+static int idle_bit(pico_1wire_sim_device_t *dev)
+{
+	ds18x20_t *s = dev->priv;
+
+	switch (s->cmd) {
+	case CMD_CONVERT:
+	case CMD_COPY_SCRATCHPAD:
+		/* Completion polling (only possible when externally powered). */
+		if (dev->parasitic)
+			return -1;
+		if (sim_busy(dev))
+			return 0;
+		complete(dev);
+		return 1;
+	case CMD_READ_POWER_SUPPLY:
+		return (dev->parasitic ? 0 : 1);
+	default:
+		return -1;
+	}
+}
+
+
+static bool alarm(pico_1wire_sim_device_t *dev)
+{
+	ds18x20_t *s = dev->priv;
+
+	complete(dev);
+	return s->alarm;
+}
+
+
+static void set_temperature(pico_1wire_sim_device_t *dev, float temperature)
+{
+	ds18x20_t *s = dev->priv;
+
+	s->temperature = temperature;
+}
+
+
+const sim_model_t sim_model_ds18b20 = {
+	.name = "DS18B20",
+	.init = ds18b20_init,
+	.destroy = destroy,
+	.reset = reset,
+	.rx_byte = rx_byte,
+	.idle_bit = idle_bit,
+	.alarm = alarm,
+	.set_temperature = set_temperature,
+};
+
+
+const sim_model_t sim_model_ds28ea00 = {
+	.name = "DS28EA00",
+	.chain = true,
+	.init = ds18b20_init,
+	.destroy = destroy,
+	.reset = reset,
+	.rx_byte = rx_byte,
+	.idle_bit = idle_bit,
+	.alarm = alarm,
+	.set_temperature = set_temperature,
+};
+
+
+const sim_model_t sim_model_ds18s20 = {
+	.name = "DS18S20",
+	.init = ds18s20_init,
+	.destroy = destroy,
+	.reset = reset,
+	.rx_byte = rx_byte,
+	.idle_bit = idle_bit,
+	.alarm = alarm,
+	.set_temperature = set_temperature,
+};
@@ -0,0 +1,274 @@
+/* pico_1wire_sim_ds2408.c
+
+   Copyright (C) 2024 Timo Kokkonen <tjko@iki.fi>
+
+   SPDX-License-Identifier: GPL-3.0-or-later
+
+   This file is part of pico-1wire Library.
+
+   pico-1wire Library is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   pico-1wire Library is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with pico-1wire Library. If not, see <https://www.gnu.org/licenses/>.
+*/
+
+
+/* DS2408 8-channel and DS2413 2-channel addressable switch models. */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "pico_1wire_sim_internal.h"
+
+
+/* Function Commands */
+#define CMD_READ_PIO_REGISTERS     0xF0
+#define CMD_CHANNEL_ACCESS_READ    0xF5
+#define CMD_CHANNEL_ACCESS_WRITE   0x5A
+#define CMD_RESET_ACTIVITY_LATCHES 0xC3
+
+#define CONFIRMATION           0xAA
+#define REG_BASE               0x88    /* DS2408 PIO registers 0x88..0x8F */
+#define SAMPLE_BLOCK           32      /* DS2408 Channel Access Read CRC interval */
+
+
+typedef struct ds2408_t {
+	bool ds2413;
+	uint8_t latch;         /* PIO output latch (1 = transistor off) */
+	uint8_t activity;      /* PIO activity latch */
+	uint8_t regs[8];       /* DS2408 registers 0x88..0x8F */
+	uint8_t cmd;
+	uint rx_count;
+	uint8_t rx_value;
+	uint16_t crc;
+	uint16_t ta;
+	bool first_block;
+} ds2408_t;
+
+
+/* Pin state: output transistor pulls pin low when latch bit is 0, pins have pull-ups. */
+static uint8_t pin_state(ds2408_t *s)
+{
+	return s->latch;
+}
+
+
+static uint8_t ds2413_status(ds2408_t *s)
+{
+	uint8_t pins = pin_state(s);
+	uint8_t status = (pins & 0x01) | ((s->latch & 0x01) << 1)
+		| ((pins & 0x02) << 1) | ((s->latch & 0x02) << 2);
+
+	return (status & 0x0f) | ((~status & 0x0f) << 4);
+}
+
+
+static void update_regs(ds2408_t *s)
+{
+	s->regs[0] = pin_state(s);
+	s->regs[1] = s->latch;
+	s->regs[2] = s->activity;
+}
+
+
+static bool init(pico_1wire_sim_device_t *dev, bool ds2413)
+{
+	ds2408_t *s;
+
+	if (!(s = calloc(1, sizeof(ds2408_t))))
+		return false;
+
+	s->ds2413 = ds2413;
+	s->latch = (ds2413 ? 0x03 : 0xff);
+	s->activity = 0;
+	memset(s->regs, 0, sizeof(s->regs));
+	s->regs[5] = 0x88;     /* Control/Status: VCC powered, power-on reset */
+	s->regs[6] = 0xff;
+	s->regs[7] = 0xff;
+	update_regs(s);
+	dev->priv = s;
+
+	return true;
+}
+
+
+static bool ds2408_init(pico_1wire_sim_device_t *dev)
+{
+	return init(dev, false);
+}
+
+
+static bool ds2413_init(pico_1wire_sim_device_t *dev)
+{
+	return init(dev, true);
+}
+
+
+static void destroy(pico_1wire_sim_device_t *dev)
+{
+	free(dev->priv);
+}
+
+
+static void reset(pico_1wire_sim_device_t *dev)
+{
+	ds2408_t *s = dev->priv;
+
+	s->cmd = 0;
+	s->rx_count = 0;
+}
+
+
+static void queue_crc(pico_1wire_sim_device_t *dev, uint16_t crc)
+{
+	uint8_t buf[2];
+
+	crc = ~crc;
+	buf[0] = crc & 0xff;
+	buf[1] = crc >> 8;
+	sim_tx_queue(dev, buf, 2);
+}
+
+
+static void channel_write(pico_1wire_sim_device_t *dev, uint8_t value)
+{
+	ds2408_t *s = dev->priv;
+	uint8_t buf[2];
+
+	if (s->ds2413) {
+		s->latch = value & 0x03;
+		buf[1] = ds2413_status(s);
+	} else {
+		s->activity |= s->latch ^ value;
+		s->latch = value;
+		update_regs(s);
+		buf[1] = pin_state(s);
+	}
+	buf[0] = CONFIRMATION;
+	sim_tx_queue(dev, buf, 2);
+}
+
+
+static void rx_byte(pico_1wire_sim_device_t *dev, uint8_t data)
+{
+	ds2408_t *s = dev->priv;
+
+	if (!s->cmd) {
+		s->cmd = data;
+		s->rx_count = 0;
+		s->crc = sim_crc16(0, data);
+		s->first_block = true;
+		switch (data) {
+		case CMD_CHANNEL_ACCESS_READ:
+		case CMD_CHANNEL_ACCESS_WRITE:
+			break;
+		case CMD_READ_PIO_REGISTERS:
+		case CMD_RESET_ACTIVITY_LATCHES:
+			if (!s->ds2413)
+				break;
+			/* fall through */
+		default:
+			s->cmd = 0xff;
+			break;
+		}
+		if (s->cmd == CMD_RESET_ACTIVITY_LATCHES) {
+			s->activity = 0;
+			update_regs(s);
+		}
+		return;
+	}
+
+	s->rx_count++;
+
+	switch (s->cmd) {
+	case CMD_CHANNEL_ACCESS_WRITE:
+		/* Data byte followed by its complement, device confirms with 0xAA and PIO state */
+		if (s->rx_count & 1) {
+			s->rx_value = data;
+		} else if ((uint8_t)(data ^ s->rx_value) == 0xff) {
+			channel_write(dev, s->rx_value);
+		} else {
+			/* Invalid complement: device stops responding until next reset */
+			s->cmd = 0xff;
+		}
+		break;
+
+	case CMD_READ_PIO_REGISTERS:
+		s->crc = sim_crc16(s->crc, data);
+		if (s->rx_count == 1) {
+			s->ta = data;
+		} else if (s->rx_count == 2) {
+			s->ta |= data << 8;
+			if (s->ta < REG_BASE || s->ta >= REG_BASE + sizeof(s->regs)) {
+				s->cmd = 0xff;
+				break;
+			}
+			for (uint i = s->ta - REG_BASE; i < sizeof(s->regs); i++)
+				s->crc = sim_crc16(s->crc, s->regs[i]);
+			sim_tx_queue(dev, &s->regs[s->ta - REG_BASE], sizeof(s->regs) - (s->ta - REG_BASE));
+			queue_crc(dev, s->crc);
+		}
+		break;
+
+	default:
+		break;
+	}
+}
+
+
+static void tx_refill(pico_1wire_sim_device_t *dev)
+{
+	ds2408_t *s = dev->priv;
+	static const uint8_t confirm[4] = { CONFIRMATION, CONFIRMATION, CONFIRMATION, CONFIRMATION };
+
+	if (s->cmd == CMD_CHANNEL_ACCESS_READ) {
+		if (s->ds2413) {
+			uint8_t status = ds2413_status(s);
+			sim_tx_queue(dev, &status, 1);
+		} else {
+			/* Block of samples followed by CRC-16 (first block includes command byte) */
+			uint8_t buf[SAMPLE_BLOCK];
+			uint16_t crc = (s->first_block ? s->crc : 0);
+			memset(buf, pin_state(s), sizeof(buf));
+			for (uint i = 0; i < sizeof(buf); i++)
+				crc = sim_crc16(crc, buf[i]);
+			sim_tx_queue(dev, buf, sizeof(buf));
+			queue_crc(dev, crc);
+			s->first_block = false;
+		}
+	}
+	else if (s->cmd == CMD_RESET_ACTIVITY_LATCHES) {
+		sim_tx_queue(dev, confirm, sizeof(confirm));
+	}
+}
+
+
+const sim_model_t sim_model_ds2408 = {
+	.name = "DS2408",
+	.resume = true,
+	.init = ds2408_init,
+	.destroy = destroy,
+	.reset = reset,
+	.rx_byte = rx_byte,
+	.tx_refill = tx_refill,
+};
+
+
+const sim_model_t sim_model_ds2413 = {
+	.name = "DS2413",
+	.resume = true,
+	.init = ds2413_init,
+	.destroy = destroy,
+	.reset = reset,
+	.rx_byte = rx_byte,
+	.tx_refill = tx_refill,
+};
@@ -0,0 +1,114 @@
+/* pico_1wire_sim_ds2409.c
+
+   Copyright (C) 2024 Timo Kokkonen <tjko@iki.fi>
+
+   SPDX-License-Identifier: GPL-3.0-or-later
+
+   This file is part of pico-1wire Library.
+
+   pico-1wire Library is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   pico-1wire Library is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with pico-1wire Library. If not, see <https://www.gnu.org/licenses/>.
+*/
+
+
+/* DS2409 MicroLAN coupler model. */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "pico_1wire_sim_internal.h"
+
+
+/* Function Commands */
+#define CMD_ALL_LINES_OFF      0x66
+#define CMD_DIRECT_ON_MAIN     0xA5
+#define CMD_SMART_ON_MAIN      0xCC
+#define CMD_SMART_ON_AUX       0x33
+
+
+typedef struct ds2409_t {
+	uint8_t cmd;
+} ds2409_t;
+
+
+static bool init(pico_1wire_sim_device_t *dev)
+{
+	ds2409_t *s;
+
+	if (!(s = calloc(1, sizeof(ds2409_t))))
+		return false;
+
+	dev->priv = s;
+
+	return true;
+}
+
+
+static void destroy(pico_1wire_sim_device_t *dev)
+{
+	free(dev->priv);
+}
+
+
+static void reset(pico_1wire_sim_device_t *dev)
+{
+	ds2409_t *s = dev->priv;
+
+	s->cmd = 0;
+}
+
+
+static void rx_byte(pico_1wire_sim_device_t *dev, uint8_t data)
+{
+	ds2409_t *s = dev->priv;
+	uint8_t buf[3];
+
+	if (s->cmd)
+		return;
+
+	s->cmd = data;
+
+	switch (data) {
+	case CMD_ALL_LINES_OFF:
+		dev->branch_on = SIM_BRANCH_NONE;
+		sim_tx_queue(dev, &data, 1);
+		break;
+	case CMD_DIRECT_ON_MAIN:
+		dev->branch_on = SIM_BRANCH_MAIN;
+		sim_tx_queue(dev, &data, 1);
+		break;
+	case CMD_SMART_ON_MAIN:
+	case CMD_SMART_ON_AUX:
+		/* Reset stimulus, presence detect (0 = presence pulse seen on branch), confirmation */
+		dev->branch_on = (data == CMD_SMART_ON_MAIN ? SIM_BRANCH_MAIN : SIM_BRANCH_AUX);
+		buf[0] = 0xff;
+		buf[1] = (sim_branch_present(dev, dev->branch_on) ? 0x00 : 0xff);
+		buf[2] = data;
+		sim_tx_queue(dev, buf, 3);
+		break;
+	default:
+		s->cmd = 0xff;
+		break;
+	}
+}
+
+
+const sim_model_t sim_model_ds2409 = {
+	.name = "DS2409",
+	.resume = false,
+	.init = init,
+	.destroy = destroy,
+	.reset = reset,
+	.rx_byte = rx_byte,
+};
@@ -0,0 +1,272 @@
+/* pico_1wire_sim_ds2431.c
+
+   Copyright (C) 2024 Timo Kokkonen <tjko@iki.fi>
+
+   SPDX-License-Identifier: GPL-3.0-or-later
+
+   This file is part of pico-1wire Library.
+
+   pico-1wire Library is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   pico-1wire Library is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with pico-1wire Library. If not, see <https://www.gnu.org/licenses/>.
+*/
+
+/* DS2431 1024-bit and DS28EC20 20480-bit EEPROM models. */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "pico_1wire_sim_internal.h"
+
+
+/* Memory Function Commands */
+#define CMD_WRITE_SCRATCHPAD   0x0F
+#define CMD_READ_SCRATCHPAD    0xAA
+#define CMD_COPY_SCRATCHPAD    0x55
+#define CMD_READ_MEMORY        0xF0
+
+#define MAX_MEMORY_SIZE        0xa20   /* DS28EC20: 2560 bytes data + 32 bytes registers */
+#define PROGRAM_TIME           10000   /* 10ms */
+
+#define ES_AA                  0x80    /* Authorization Accepted */
+#define ES_PF                  0x20    /* Partial (byte) Flag */
+
+
+typedef struct ds2431_t {
+	uint data_size;        /* data memory size (registers follow data memory) */
+	uint mem_size;         /* total memory size */
+	uint row_size;         /* scratchpad size */
+	uint8_t mem[MAX_MEMORY_SIZE];
+	uint8_t scratch[32];
+	uint16_t ta;
+	uint8_t es;
+	uint8_t cmd;
+	uint rx_count;
+	uint16_t crc;
+	uint16_t read_addr;
+	bool copying;
+	bool copy_ok;
+} ds2431_t;
+
+
+static void complete(pico_1wire_sim_device_t *dev)
+{
+	ds2431_t *s = dev->priv;
+	int res = sim_finish_operation(dev);
+
+	if (res < 0 || !s->copying)
+		return;
+
+	s->copying = false;
+	s->copy_ok = res;
+	if (res) {
+		memcpy(&s->mem[s->ta & ~(s->row_size - 1)], s->scratch, s->row_size);
+		s->es |= ES_AA;
+	}
+}
+
+
+static bool init(pico_1wire_sim_device_t *dev, uint data_size, uint reg_size, uint row_size)
+{
+	ds2431_t *s;
+
+	if (!(s = calloc(1, sizeof(ds2431_t))))
+		return false;
+
+	s->data_size = data_size;
+	s->mem_size = data_size + reg_size;
+	s->row_size = row_size;
+	memset(s->mem, 0xff, sizeof(s->mem));
+	memset(s->scratch, 0xff, sizeof(s->scratch));
+	s->es = row_size - 1;
+	dev->priv = s;
+
+	return true;
+}
+
+
+static bool ds2431_init(pico_1wire_sim_device_t *dev)
+{
+	return init(dev, 0x80, 0x10, 8);
+}
+
+
+static bool ds28ec20_init(pico_1wire_sim_device_t *dev)
+{
+	return init(dev, 0xa00, 0x20, 32);
+}
+
+
+static void destroy(pico_1wire_sim_device_t *dev)
+{
+	free(dev->priv);
+}
+
+
+static void reset(pico_1wire_sim_device_t *dev)
+{
+	ds2431_t *s = dev->priv;
+
+	s->cmd = 0;
+	s->rx_count = 0;
+}
+
+
+static void queue_crc(pico_1wire_sim_device_t *dev, uint16_t crc)
+{
+	uint8_t buf[2];
+
+	crc = ~crc;
+	buf[0] = crc & 0xff;
+	buf[1] = crc >> 8;
+	sim_tx_queue(dev, buf, 2);
+}
+
+
+static void rx_byte(pico_1wire_sim_device_t *dev, uint8_t data)
+{
+	ds2431_t *s = dev->priv;
+
+	complete(dev);
+
+	if (!s->cmd) {
+		s->cmd = data;
+		s->rx_count = 0;
+		s->crc = sim_crc16(0, data);
+		if (data == CMD_READ_SCRATCHPAD) {
+			uint8_t hdr[3] = { s->ta & 0xff, s->ta >> 8, s->es };
+			uint start = s->ta & (s->row_size - 1);
+			uint end = s->es & (s->row_size - 1);
+			for (int i = 0; i < 3; i++)
+				s->crc = sim_crc16(s->crc, hdr[i]);
+			sim_tx_queue(dev, hdr, 3);
+			for (uint i = start; i <= end; i++)
+				s->crc = sim_crc16(s->crc, s->scratch[i]);
+			if (end >= start)
+				sim_tx_queue(dev, &s->scratch[start], end - start + 1);
+			queue_crc(dev, s->crc);
+		}
+		else if (data != CMD_WRITE_SCRATCHPAD && data != CMD_COPY_SCRATCHPAD
+			&& data != CMD_READ_MEMORY) {
+			s->cmd = 0xff;
+		}
+		return;
+	}
+
+	s->rx_count++;
+	s->crc = sim_crc16(s->crc, data);
+
+	switch (s->cmd) {
+	case CMD_WRITE_SCRATCHPAD:
+		if (s->rx_count == 1) {
+			s->ta = data;
+		} else if (s->rx_count == 2) {
+			s->ta |= data << 8;
+			s->es = (s->ta & (s->row_size - 1)) | ES_PF;
+			if (s->ta >= s->mem_size)
+				s->cmd = 0xff;
+		} else {
+			uint offset = (s->ta & (s->row_size - 1)) + s->rx_count - 3;
+			if (offset >= s->row_size)
+				break;
+			s->scratch[offset] = data;
+			s->es = offset;
+			if (offset == s->row_size - 1)
+				queue_crc(dev, s->crc);
+		}
+		break;
+
+	case CMD_COPY_SCRATCHPAD:
+		if ((s->rx_count == 1 && data != (s->ta & 0xff))
+			|| (s->rx_count == 2 && data != (s->ta >> 8))
+			|| (s->rx_count == 3 && data != s->es)) {
+			/* Authorization pattern does not match */
+			s->cmd = 0xff;
+			break;
+		}
+		if (s->rx_count == 3) {
+			if ((s->ta & (s->row_size - 1)) || (s->es & (ES_PF | (s->row_size - 1))) != s->row_size - 1
+				|| s->ta >= s->data_size) {
+				s->cmd = 0xff;
+				break;
+			}
+			s->copying = true;
+			s->copy_ok = false;
+			sim_start_operation(dev, PROGRAM_TIME);
+		}
+		break;
+
+	case CMD_READ_MEMORY:
+		if (s->rx_count == 1)
+			s->read_addr = data;
+		else if (s->rx_count == 2)
+			s->read_addr |= data << 8;
+		break;
+
+	default:
+		break;
+	}
+}
+
+
+static void tx_refill(pico_1wire_sim_device_t *dev)
+{
+	ds2431_t *s = dev->priv;
+	static const uint8_t pattern[4] = { 0xaa, 0xaa, 0xaa, 0xaa };
+
+	if (s->cmd == CMD_READ_MEMORY && s->rx_count >= 2 && s->read_addr < s->mem_size) {
+		uint len = s->mem_size - s->read_addr;
+		if (len > SIM_TX_BUF_SIZE)
+			len = SIM_TX_BUF_SIZE;
+		sim_tx_queue(dev, &s->mem[s->read_addr], len);
+		s->read_addr += len;
+	}
+	else if (s->cmd == CMD_COPY_SCRATCHPAD && s->rx_count >= 3) {
+		complete(dev);
+		if (!s->copying && s->copy_ok)
+			sim_tx_queue(dev, pattern, sizeof(pattern));
+	}
+}
+
+
+static uint8_t* memory(pico_1wire_sim_device_t *dev, uint *size)
+{
+	ds2431_t *s = dev->priv;
+
+	*size = s->data_size;
+	return s->mem;
+}
+
+
+const sim_model_t sim_model_ds2431 = {
+	.name = "DS2431",
+	.resume = true,
+	.init = ds2431_init,
+	.destroy = destroy,
+	.reset = reset,
+	.rx_byte = rx_byte,
+	.tx_refill = tx_refill,
+	.memory = memory,
+};
+
+
+const sim_model_t sim_model_ds28ec20 = {
+	.name = "DS28EC20",
+	.resume = true,
+	.init = ds28ec20_init,
+	.destroy = destroy,
+	.reset = reset,
+	.rx_byte = rx_byte,
+	.tx_refill = tx_refill,
+	.memory = memory,
+};
@@ -0,0 +1,226 @@
+/* pico_1wire_sim_ds2438.c
+
+   Copyright (C) 2024 Timo Kokkonen <tjko@iki.fi>
+
+   SPDX-License-Identifier: GPL-3.0-or-later
+
+   This file is part of pico-1wire Library.
+
+   pico-1wire Library is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   pico-1wire Library is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with pico-1wire Library. If not, see <https://www.gnu.org/licenses/>.
+*/
+
+
+/* DS2438 smart battery monitor model. */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+#include "pico_1wire_sim_internal.h"
+
+
+/* Function Commands */
+#define CMD_CONVERT_T          0x44
+#define CMD_CONVERT_V          0xB4
+#define CMD_WRITE_SCRATCHPAD   0x4E
+#define CMD_READ_SCRATCHPAD    0xBE
+#define CMD_COPY_SCRATCHPAD    0x48
+#define CMD_RECALL             0xB8
+
+#define PAGES                  8
+#define PAGE_SIZE              8
+#define CONVERSION_TIME        10000   /* 10ms */
+#define COPY_TIME              10000   /* 10ms */
+
+#define CONFIG_AD              0x08    /* Voltage A/D input: 1 = VDD, 0 = VAD */
+#define STATUS_TB              0x10    /* Temperature conversion busy */
+#define STATUS_ADB             0x40    /* A/D conversion busy */
+
+#define VDD_MV                 5000
+#define VAD_MV                 3700
+#define CURRENT_RAW            25
+#define ICA_RAW                0x10
+
+
+typedef struct ds2438_t {
+	float temperature;
+	uint8_t mem[PAGES][PAGE_SIZE];
+	uint8_t scratch[PAGES][PAGE_SIZE];
+	uint8_t cmd;
+	uint8_t page;
+	uint rx_count;
+	uint8_t pending;       /* operation in progress (command) */
+} ds2438_t;
+
+
+static void complete(pico_1wire_sim_device_t *dev)
+{
+	ds2438_t *s = dev->priv;
+	int res = sim_finish_operation(dev);
+
+	if (res < 0)
+		return;
+
+	switch (s->pending) {
+	case CMD_CONVERT_T:
+		if (res) {
+			int16_t raw = (int16_t)floorf(s->temperature * 32) << 3;
+			s->mem[0][1] = raw & 0xff;
+			s->mem[0][2] = (raw >> 8) & 0xff;
+		}
+		s->mem[0][0] &= ~STATUS_TB;
+		break;
+	case CMD_CONVERT_V:
+		if (res) {
+			uint16_t raw = ((s->mem[0][0] & CONFIG_AD) ? VDD_MV : VAD_MV) / 10;
+			s->mem[0][3] = raw & 0xff;
+			s->mem[0][4] = raw >> 8;
+		}
+		s->mem[0][0] &= ~STATUS_ADB;
+		break;
+	case CMD_COPY_SCRATCHPAD:
+		if (res)
+			memcpy(s->mem[s->page], s->scratch[s->page], PAGE_SIZE);
+		break;
+	}
+	s->pending = 0;
+}
+
+
+static bool init(pico_1wire_sim_device_t *dev)
+{
+	ds2438_t *s;
+
+	if (!(s = calloc(1, sizeof(ds2438_t))))
+		return false;
+
+	s->temperature = 25.0;
+	s->mem[0][0] = CONFIG_AD | 0x07;   /* IAD, CA, EE enabled, VDD input */
+	s->mem[0][5] = CURRENT_RAW & 0xff;
+	s->mem[0][6] = (CURRENT_RAW >> 8) & 0xff;
+	s->mem[1][4] = ICA_RAW;
+	memcpy(s->scratch, s->mem, sizeof(s->scratch));
+	dev->priv = s;
+
+	return true;
+}
+
+
+static void destroy(pico_1wire_sim_device_t *dev)
+{
+	free(dev->priv);
+}
+
+
+static void reset(pico_1wire_sim_device_t *dev)
+{
+	ds2438_t *s = dev->priv;
+
+	s->cmd = 0;
+	s->rx_count = 0;
+}
+
+
+static void start(pico_1wire_sim_device_t *dev, uint8_t op, uint64_t duration)
+{
+	ds2438_t *s = dev->priv;
+
+	/* Commands are ignored while previous operation is in progress. */
+	if (s->pending)
+		return;
+
+	s->pending = op;
+	if (op == CMD_CONVERT_T)
+		s->mem[0][0] |= STATUS_TB;
+	else if (op == CMD_CONVERT_V)
+		s->mem[0][0] |= STATUS_ADB;
+	sim_start_operation(dev, duration);
+}
+
+
+static void rx_byte(pico_1wire_sim_device_t *dev, uint8_t data)
+{
+	ds2438_t *s = dev->priv;
+
+	complete(dev);
+
+	if (!s->cmd) {
+		s->cmd = data;
+		s->rx_count = 0;
+		switch (data) {
+		case CMD_CONVERT_T:
+		case CMD_CONVERT_V:
+			start(dev, data, CONVERSION_TIME);
+			break;
+		case CMD_WRITE_SCRATCHPAD:
+		case CMD_READ_SCRATCHPAD:
+		case CMD_COPY_SCRATCHPAD:
+		case CMD_RECALL:
+			break;
+		default:
+			s->cmd = 0xff;
+			break;
+		}
+		return;
+	}
+
+	if (s->rx_count++ == 0) {
+		/* Page number */
+		if (data >= PAGES) {
+			s->cmd = 0xff;
+			return;
+		}
+		s->page = data;
+		switch (s->cmd) {
+		case CMD_READ_SCRATCHPAD: {
+			uint8_t crc = 0;
+			for (int i = 0; i < PAGE_SIZE; i++)
+				crc = sim_crc8(crc, s->scratch[s->page][i]);
+			sim_tx_queue(dev, s->scratch[s->page], PAGE_SIZE);
+			sim_tx_queue(dev, &crc, 1);
+			break;
+		}
+		case CMD_RECALL:
+			memcpy(s->scratch[s->page], s->mem[s->page], PAGE_SIZE);
+			break;
+		case CMD_COPY_SCRATCHPAD:
+			start(dev, CMD_COPY_SCRATCHPAD, COPY_TIME);
+			break;
+		}
+		return;
+	}
+
+	if (s->cmd == CMD_WRITE_SCRATCHPAD && s->rx_count - 2 < PAGE_SIZE)
+		s->scratch[s->page][s->rx_count - 2] = data;
+}
+
+
+static void set_temperature(pico_1wire_sim_device_t *dev, float temperature)
+{
+	ds2438_t *s = dev->priv;
+
+	s->temperature = temperature;
+}
+
+
+const sim_model_t sim_model_ds2438 = {
+	.name = "DS2438",
+	.resume = false,
+	.init = init,
+	.destroy = destroy,
+	.reset = reset,
+	.rx_byte = rx_byte,
+	.set_temperature = set_temperature,
+};
@@ -0,0 +1,402 @@
+/* pico_1wire_sim_ds2482.c
+
+   Copyright (C) 2024 Timo Kokkonen <tjko@iki.fi>
+
+   SPDX-License-Identifier: GPL-3.0-or-later
+
+   This file is part of pico-1wire Library.
+
+   pico-1wire Library is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   pico-1wire Library is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with pico-1wire Library. If not, see <https://www.gnu.org/licenses/>.
+*/
+
+
+/* DS2482-100/-800 I2C-to-1-Wire bridge model. */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "pico_1wire_sim_internal.h"
+
+
+/* DS2482 Commands */
+#define CMD_DEVICE_RESET       0xF0
+#define CMD_SET_READ_POINTER   0xE1
+#define CMD_WRITE_CONFIG       0xD2
+#define CMD_CHANNEL_SELECT     0xC3
+#define CMD_1WIRE_RESET        0xB4
+#define CMD_1WIRE_SINGLE_BIT   0x87
+#define CMD_1WIRE_WRITE_BYTE   0xA5
+#define CMD_1WIRE_READ_BYTE    0x96
+#define CMD_1WIRE_TRIPLET      0x78
+
+/* Read Pointer Codes */
+#define REG_STATUS             0xF0
+#define REG_DATA               0xE1
+#define REG_CHANNEL            0xD2
+#define REG_CONFIG             0xC3
+
+/* Status Register */
+#define STATUS_PPD             0x02
+#define STATUS_SD              0x04
+#define STATUS_LL              0x08
+#define STATUS_RST             0x10
+#define STATUS_SBR             0x20
+#define STATUS_TSB             0x40
+#define STATUS_DIR             0x80
+
+/* Device Configuration Register */
+#define CONFIG_SPU             0x04
+
+/* 1-Wire timing (standard speed) */
+#define RESET_LOW_LEN          560
+#define RESET_SAMPLE_TIME      70
+#define RESET_HIGH_LEN         584
+#define SLOT_LEN               72
+#define WRITE1_LOW_LEN         8
+#define WRITE0_LOW_LEN         64
+#define READ_SAMPLE_TIME       14
+
+#define I2C_BYTE_TIME          23     /* 9 bits at 400kHz */
+
+#define MAX_CHANNELS           8
+
+
+struct pico_1wire_sim_ds2482_t {
+	uint i2c_bus;
+	uint8_t i2c_addr;
+	uint channels;
+	pico_1wire_sim_t *sim[MAX_CHANNELS];
+
+	uint channel;
+	uint8_t pointer;
+	uint8_t status;
+	uint8_t data;
+	uint8_t config;
+	bool spu_active;
+};
+
+
+static const uint8_t channel_code[MAX_CHANNELS] = { 0xF0, 0xE1, 0xD2, 0xC3, 0xB4, 0xA5, 0x96, 0x87 };
+static const uint8_t channel_readback[MAX_CHANNELS] = { 0xB8, 0xB1, 0xAA, 0xA3, 0x9C, 0x95, 0x8E, 0x87 };
+
+
+static pico_1wire_sim_t* bus(pico_1wire_sim_ds2482_t *b)
+{
+	return b->sim[b->channel];
+}
+
+
+static void pullup(pico_1wire_sim_ds2482_t *b, bool on)
+{
+	if (b->spu_active == on)
+		return;
+
+	b->spu_active = on;
+	if (bus(b))
+		sim_master_pullup(bus(b), on);
+	if (!on)
+		b->config &= ~CONFIG_SPU;
+}
+
+
+static void line_status(pico_1wire_sim_ds2482_t *b)
+{
+	b->status &= ~STATUS_LL;
+	if (!bus(b) || sim_master_sample(bus(b)))
+		b->status |= STATUS_LL;
+}
+
+
+static void onewire_reset(pico_1wire_sim_ds2482_t *b)
+{
+	pico_1wire_sim_t *sim = bus(b);
+
+	b->status &= ~(STATUS_PPD | STATUS_SD);
+
+	if (!sim) {
+		pico_1wire_host_sleep_us(RESET_LOW_LEN + RESET_HIGH_LEN);
+		return;
+	}
+
+	if (!sim_master_sample(sim))
+		b->status |= STATUS_SD;
+
+	sim_master_drive(sim, false);
+	pico_1wire_host_sleep_us(RESET_LOW_LEN);
+	sim_master_release(sim);
+	pico_1wire_host_sleep_us(RESET_SAMPLE_TIME);
+	if (!sim_master_sample(sim))
+		b->status |= STATUS_PPD;
+	pico_1wire_host_sleep_us(RESET_HIGH_LEN - RESET_SAMPLE_TIME);
+}
+
+
+static bool onewire_bit(pico_1wire_sim_ds2482_t *b, bool bit)
+{
+	pico_1wire_sim_t *sim = bus(b);
+	bool result = bit;
+
+	if (!sim) {
+		pico_1wire_host_sleep_us(SLOT_LEN);
+		return true;
+	}
+
+	sim_master_drive(sim, false);
+	if (bit) {
+		pico_1wire_host_sleep_us(WRITE1_LOW_LEN);
+		sim_master_release(sim);
+		pico_1wire_host_sleep_us(READ_SAMPLE_TIME - WRITE1_LOW_LEN);
+		result = sim_master_sample(sim);
+		pico_1wire_host_sleep_us(SLOT_LEN - READ_SAMPLE_TIME);
+	} else {
+		pico_1wire_host_sleep_us(WRITE0_LOW_LEN);
+		sim_master_release(sim);
+		pico_1wire_host_sleep_us(SLOT_LEN - WRITE0_LOW_LEN);
+	}
+
+	return result;
+}
+
+
+static void onewire_command(pico_1wire_sim_ds2482_t *b, uint8_t cmd, uint8_t param)
+{
+	bool spu, id, cmp, dir;
+
+	/* Any 1-Wire command ends strong pull-up (and clears SPU). */
+	pullup(b, false);
+	spu = (b->config & CONFIG_SPU);
+
+	switch (cmd) {
+	case CMD_1WIRE_RESET:
+		onewire_reset(b);
+		spu = false;
+		break;
+
+	case CMD_1WIRE_SINGLE_BIT:
+		b->status &= ~STATUS_SBR;
+		if (onewire_bit(b, param & 0x80))
+			b->status |= STATUS_SBR;
+		break;
+
+	case CMD_1WIRE_WRITE_BYTE:
+		for (int i = 0; i < 8; i++)
+			onewire_bit(b, (param >> i) & 0x01);
+		break;
+
+	case CMD_1WIRE_READ_BYTE:
+		b->data = 0;
+		for (int i = 0; i < 8; i++) {
+			if (onewire_bit(b, true))
+				b->data |= (1 << i);
+		}
+		break;
+
+	case CMD_1WIRE_TRIPLET:
+		id = onewire_bit(b, true);
+		cmp = onewire_bit(b, true);
+		if (id != cmp)
+			dir = id;
+		else
+			dir = (id ? true : (param & 0x80));
+		onewire_bit(b, dir);
+		b->status &= ~(STATUS_SBR | STATUS_TSB | STATUS_DIR);
+		b->status |= (id ? STATUS_SBR : 0) | (cmp ? STATUS_TSB : 0) | (dir ? STATUS_DIR : 0);
+		spu = false;
+		break;
+	}
+
+	/* Strong pull-up (if enabled) turns on after Write Byte, Read Byte or Single Bit. */
+	if (spu)
+		pullup(b, true);
+
+	line_status(b);
+	b->pointer = REG_STATUS;
+}
+
+
+static void device_reset(pico_1wire_sim_ds2482_t *b)
+{
+	pullup(b, false);
+	b->channel = 0;
+	b->config = 0;
+	b->status = STATUS_RST;
+	line_status(b);
+	b->pointer = REG_STATUS;
+}
+
+
+static int channel_index(uint8_t code)
+{
+	for (int i = 0; i < MAX_CHANNELS; i++) {
+		if (channel_code[i] == code)
+			return i;
+	}
+
+	return -1;
+}
+
+
+/* Host I2C backend */
+
+static int i2c_write(void *arg, uint i2c_bus, uint8_t addr, const uint8_t *buf, size_t len)
+{
+	pico_1wire_sim_ds2482_t *b = arg;
+	int ch;
+
+	pico_1wire_host_sleep_us(I2C_BYTE_TIME * (len + 1));
+
+	if (i2c_bus != b->i2c_bus || addr != b->i2c_addr || len < 1)
+		return -1;
+
+	switch (buf[0]) {
+	case CMD_DEVICE_RESET:
+		device_reset(b);
+		break;
+
+	case CMD_SET_READ_POINTER:
+		if (len < 2)
+			return -1;
+		if (buf[1] != REG_STATUS && buf[1] != REG_DATA && buf[1] != REG_CONFIG &&
+			!(buf[1] == REG_CHANNEL && b->channels > 1))
+			return -1;
+		b->pointer = buf[1];
+		break;
+
+	case CMD_WRITE_CONFIG:
+		if (len < 2)
+			return -1;
+		/* Upper nibble must be one's complement of lower nibble. */
+		if ((((buf[1] >> 4) ^ buf[1]) & 0x0f) != 0x0f)
+			return -1;
+		b->config = buf[1] & 0x0f;
+		if (!(b->config & CONFIG_SPU))
+			pullup(b, false);
+		b->status &= ~STATUS_RST;
+		b->pointer = REG_CONFIG;
+		break;
+
+	case CMD_CHANNEL_SELECT:
+		if (len < 2 || b->channels < 2 || (ch = channel_index(buf[1])) < 0 || (uint)ch >= b->channels)
+			return -1;
+		pullup(b, false);
+		b->channel = ch;
+		line_status(b);
+		b->pointer = REG_CHANNEL;
+		break;
+
+	case CMD_1WIRE_RESET:
+	case CMD_1WIRE_READ_BYTE:
+		onewire_command(b, buf[0], 0);
+		break;
+
+	case CMD_1WIRE_SINGLE_BIT:
+	case CMD_1WIRE_WRITE_BYTE:
+	case CMD_1WIRE_TRIPLET:
+		if (len < 2)
+			return -1;
+		onewire_command(b, buf[0], buf[1]);
+		break;
+
+	default:
+		return -1;
+	}
+
+	return len;
+}
+
+
+static int i2c_read(void *arg, uint i2c_bus, uint8_t addr, uint8_t *buf, size_t len)
+{
+	pico_1wire_sim_ds2482_t *b = arg;
+	uint8_t val;
+
+	pico_1wire_host_sleep_us(I2C_BYTE_TIME * (len + 1));
+
+	if (i2c_bus != b->i2c_bus || addr != b->i2c_addr)
+		return -1;
+
+	switch (b->pointer) {
+	case REG_DATA:
+		val = b->data;
+		break;
+	case REG_CONFIG:
+		val = b->config;
+		break;
+	case REG_CHANNEL:
+		val = channel_readback[b->channel];
+		break;
+	default:
+		val = b->status;
+		break;
+	}
+	memset(buf, val, len);
+
+	return len;
+}
+
+
+static const pico_1wire_host_i2c_backend_t ds2482_backend = {
+	.write = i2c_write,
+	.read = i2c_read,
+};
+
+
+/*****************************/
+/* Exposed Simulator Functions */
+
+
+pico_1wire_sim_ds2482_t* pico_1wire_sim_ds2482_create(uint i2c_bus, uint8_t i2c_addr, uint channels)
+{
+	pico_1wire_sim_ds2482_t *b;
+
+	if (channels != 1 && channels != MAX_CHANNELS)
+		return NULL;
+	if (!(b = calloc(1, sizeof(pico_1wire_sim_ds2482_t))))
+		return NULL;
+
+	b->i2c_bus = i2c_bus;
+	b->i2c_addr = i2c_addr;
+	b->channels = channels;
+	device_reset(b);
+
+	pico_1wire_host_set_i2c_backend(&ds2482_backend, b);
+
+	return b;
+}
+
+
+void pico_1wire_sim_ds2482_destroy(pico_1wire_sim_ds2482_t *bridge)
+{
+	if (!bridge)
+		return;
+
+	pico_1wire_host_set_i2c_backend(NULL, NULL);
+	free(bridge);
+}
+
+
+int pico_1wire_sim_ds2482_attach(pico_1wire_sim_ds2482_t *bridge, uint channel, pico_1wire_sim_t *sim)
+{
+	if (!bridge || channel >= bridge->channels)
+		return -1;
+
+	if (channel == bridge->channel)
+		pullup(bridge, false);
+	bridge->sim[channel] = sim;
+	if (channel == bridge->channel)
+		line_status(bridge);
+
+	return 0;
+}
@@ -0,0 +1,128 @@
+/* pico_1wire_sim_internal.h
+
+   Copyright (C) 2024 Timo Kokkonen <tjko@iki.fi>
+
+   SPDX-License-Identifier: GPL-3.0-or-later
+
+   This file is part of pico-1wire Library.
+
+   pico-1wire Library is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   pico-1wire Library is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with pico-1wire Library. If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#ifndef PICO_1WIRE_SIM_INTERNAL_H
+#define PICO_1WIRE_SIM_INTERNAL_H 1
+
+#include "pico_1wire_sim.h"
+
+
+#define SIM_TX_BUF_SIZE  64
+
+
+/* Device model (function command layer). ROM command layer is handled by the simulator. */
+typedef struct sim_model_t {
+	const char *name;
+	bool resume;                 /* device supports Resume command */
+	bool chain;                  /* device supports Chain mode (Conditional Read ROM) */
+	bool (*init)(pico_1wire_sim_device_t *dev);
+	void (*destroy)(pico_1wire_sim_device_t *dev);
+	/* Bus reset (device returns to ROM command layer) */
+	void (*reset)(pico_1wire_sim_device_t *dev);
+	/* Byte received from the master (function command layer) */
+	void (*rx_byte)(pico_1wire_sim_device_t *dev, uint8_t data);
+	/* Transmit queue is empty, device may queue more data (optional) */
+	void (*tx_refill)(pico_1wire_sim_device_t *dev);
+	/* Bit to send when transmit queue is empty: 0, 1 or -1 when not transmitting (optional) */
+	int (*idle_bit)(pico_1wire_sim_device_t *dev);
+	/* Device alarm flag for Alarm Search (optional) */
+	bool (*alarm)(pico_1wire_sim_device_t *dev);
+	/* Device temperature setting (optional) */
+	void (*set_temperature)(pico_1wire_sim_device_t *dev, float temperature);
+	/* Device memory (optional) */
+	uint8_t* (*memory)(pico_1wire_sim_device_t *dev, uint *size);
+} sim_model_t;
+
+
+struct pico_1wire_sim_device_t {
+	pico_1wire_sim_t *sim;
+	const sim_model_t *model;
+	void *priv;                  /* model state */
+
+	uint64_t addr;               /* ROM address (library format) */
+	uint8_t rom[8];              /* ROM address in wire order */
+	bool parasitic;
+	bool rc;                     /* resume flag (device was last selected by Match/Search ROM) */
+	uint8_t chain;               /* chain state (SIM_CHAIN_xxx) */
+	pico_1wire_sim_device_t *coupler; /* DS2409 coupler the device is connected behind (NULL = main trunk) */
+	uint8_t branch;              /* coupler branch the device is connected to (SIM_BRANCH_MAIN/AUX) */
+	int branch_on;               /* coupler: branch currently connected (SIM_BRANCH_xxx) */
+
+	/* Function layer receive/transmit state */
+	uint8_t rx_data;
+	uint rx_bits;
+	uint8_t tx_buf[SIM_TX_BUF_SIZE];
+	uint tx_len;                 /* bytes in tx_buf */
+	uint tx_pos;                 /* bits already sent */
+	bool tx_now;                 /* device transmitted during current slot */
+	int corrupt_bit;             /* invert transmitted bit after this many bits (-1 = none) */
+
+	/* Operation (conversion, EEPROM write) in progress */
+	uint64_t busy_start;
+	uint64_t busy_until;
+	bool power_fault;            /* phantom powered device lost power during operation */
+	bool spu_seen;               /* strong pull-up was enabled during operation */
+};
+
+
+/* Chain states (DS28EA00 sequence detection) */
+#define SIM_CHAIN_OFF   0
+#define SIM_CHAIN_ON    1
+#define SIM_CHAIN_DONE  2
+
+
+/* Coupler branches (DS2409) */
+#define SIM_BRANCH_NONE -1
+#define SIM_BRANCH_MAIN 0
+#define SIM_BRANCH_AUX  1
+
+
+/* Helpers for device models */
+void sim_tx_queue(pico_1wire_sim_device_t *dev, const uint8_t *buf, uint len);
+void sim_tx_clear(pico_1wire_sim_device_t *dev);
+void sim_start_operation(pico_1wire_sim_device_t *dev, uint64_t duration);
+bool sim_busy(pico_1wire_sim_device_t *dev);
+int sim_finish_operation(pico_1wire_sim_device_t *dev);
+uint64_t sim_time_us(void);
+uint8_t sim_crc8(uint8_t crc, uint8_t data);
+uint16_t sim_crc16(uint16_t crc, uint8_t data);
+bool sim_branch_present(pico_1wire_sim_device_t *coupler, int branch);
+
+/* Data line access for bus masters other than the library (DS2482 model) */
+void sim_master_drive(pico_1wire_sim_t *sim, bool value);
+void sim_master_release(pico_1wire_sim_t *sim);
+bool sim_master_sample(pico_1wire_sim_t *sim);
+void sim_master_pullup(pico_1wire_sim_t *sim, bool on);
+
+extern const sim_model_t sim_model_ds18b20;
+extern const sim_model_t sim_model_ds18s20;
+extern const sim_model_t sim_model_ds28ea00;
+extern const sim_model_t sim_model_ds2431;
+extern const sim_model_t sim_model_ds28ec20;
+extern const sim_model_t sim_model_ds2408;
+extern const sim_model_t sim_model_ds2413;
+extern const sim_model_t sim_model_ds2438;
+extern const sim_model_t sim_model_ds2409;
+extern const sim_model_t sim_model_max31850;
+
+
+#endif /* PICO_1WIRE_SIM_INTERNAL_H */
@@ -0,0 +1,182 @@
+/* pico_1wire_sim_max31850.c
+
+   Copyright (C) 2024 Timo Kokkonen <tjko@iki.fi>
+
+   SPDX-License-Identifier: GPL-3.0-or-later
+
+   This file is part of pico-1wire Library.
+
+   pico-1wire Library is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   pico-1wire Library is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with pico-1wire Library. If not, see <https://www.gnu.org/licenses/>.
+*/
+
+
+/* MAX31850 thermocouple interface model. */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+#include "pico_1wire_sim_internal.h"
+
+
+/* Function Commands */
+#define CMD_CONVERT            0x44
+#define CMD_READ_SCRATCHPAD    0xBE
+#define CMD_READ_POWER_SUPPLY  0xB4
+
+#define CONVERSION_TIME        100000  /* 100ms */
+#define COLD_JUNCTION_TEMP     25.0
+
+
+typedef struct max31850_t {
+	float temperature;
+	uint8_t scratch[9];
+	uint8_t cmd;
+	bool converting;
+} max31850_t;
+
+
+static void store_temperature(max31850_t *s, float temp)
+{
+	int16_t tc = (int16_t)floorf(temp * 4) << 2;
+	int16_t cj = (int16_t)floorf(COLD_JUNCTION_TEMP * 16) << 4;
+	uint8_t crc = 0;
+
+	s->scratch[0] = tc & 0xff;
+	s->scratch[1] = (tc >> 8) & 0xff;
+	s->scratch[2] = cj & 0xff;
+	s->scratch[3] = (cj >> 8) & 0xff;
+	for (int i = 0; i < 8; i++)
+		crc = sim_crc8(crc, s->scratch[i]);
+	s->scratch[8] = crc;
+}
+
+
+static void complete(pico_1wire_sim_device_t *dev)
+{
+	max31850_t *s = dev->priv;
+	int res = sim_finish_operation(dev);
+
+	if (res < 0)
+		return;
+
+	if (s->converting) {
+		s->converting = false;
+		if (res)
+			store_temperature(s, s->temperature);
+	}
+}
+
+
+static bool init(pico_1wire_sim_device_t *dev)
+{
+	max31850_t *s;
+
+	if (!(s = calloc(1, sizeof(max31850_t))))
+		return false;
+
+	s->temperature = 25.0;
+	/* Configuration: bit 7 and reserved bits set, hardware address 0. */
+	s->scratch[4] = 0xf0;
+	s->scratch[5] = 0xff;
+	s->scratch[6] = 0xff;
+	s->scratch[7] = 0xff;
+	store_temperature(s, 0.0);
+
+	dev->priv = s;
+
+	return true;
+}
+
+
+static void destroy(pico_1wire_sim_device_t *dev)
+{
+	free(dev->priv);
+}
+
+
+static void reset(pico_1wire_sim_device_t *dev)
+{
+	max31850_t *s = dev->priv;
+
+	s->cmd = 0;
+}
+
+
+static void rx_byte(pico_1wire_sim_device_t *dev, uint8_t data)
+{
+	max31850_t *s = dev->priv;
+
+	complete(dev);
+
+	if (s->cmd)
+		return;
+
+	s->cmd = data;
+
+	switch (data) {
+	case CMD_CONVERT:
+		s->converting = true;
+		sim_start_operation(dev, CONVERSION_TIME);
+		break;
+	case CMD_READ_SCRATCHPAD:
+		sim_tx_queue(dev, s->scratch, sizeof(s->scratch));
+		break;
+	case CMD_READ_POWER_SUPPLY:
+		break;
+	default:
+		s->cmd = 0xff;
+		break;
+	}
+}
+
+
+static int idle_bit(pico_1wire_sim_device_t *dev)
+{
+	max31850_t *s = dev->priv;
+
+	switch (s->cmd) {
+	case CMD_CONVERT:
+		if (dev->parasitic)
+			return -1;
+		if (sim_busy(dev))
+			return 0;
+		complete(dev);
+		return 1;
+	case CMD_READ_POWER_SUPPLY:
+		return (dev->parasitic ? 0 : 1);
+	default:
+		return -1;
+	}
+}
+
+
+static void set_temperature(pico_1wire_sim_device_t *dev, float temperature)
+{
+	max31850_t *s = dev->priv;
+
+	s->temperature = temperature;
+}
+
+
+const sim_model_t sim_model_max31850 = {
+	.name = "MAX31850",
+	.init = init,
+	.destroy = destroy,
+	.reset = reset,
+	.rx_byte = rx_byte,
+	.idle_bit = idle_bit,
+	.set_temperature = set_temperature,
+};
@@ -24,10 +24,11 @@
 #include <stdlib.h>
 #include <string.h>
 #include <math.h>
-#include "pico/stdlib.h"
-#include "hardware/gpio.h"
 
 #include "pico_1wire.h"
+#include "pico_1wire_hal.h"
+#include "pico_1wire_drivers.h"
+#include "pico_1wire_ds2482.h"
 
 
 /* ROM Commands */
@@ -36,6 +37,8 @@
 #define CMD_MATCH          0x55
 #define CMD_SKIP           0xCC
 #define CMD_ALARM_SEARCH   0xEC
+#define CMD_RESUME         0xA5
+#define CMD_COND_READ      0x0F
 
 /* Function Commands */
 #define CMD_CONVERT            0x44
@@ -44,15 +47,20 @@
 #define CMD_COPY_SCRATCHPAD    0x48
 #define CMD_RECALL             0xB8
 #define CMD_READ_POWER_SUPPLY  0xB4
+#define CMD_CHAIN              0x99
 
-/* 1-Wire Device Family Codes */
-#define FAMILY_CODE_DS18S20      0x10  /* Temperature (9bit) */
-#define FAMILY_CODE_DS1822       0x22  /* Temperature (9-12bit) */
-#define FAMILY_CODE_DS18B20      0x28  /* Temperature (9-12bit) */
-#define FAMILY_CODE_MAX31820     0x28  /* Temperature (9-12bit) */
-#define FAMILY_CODE_DS1825       0x3B  /* Temperature (9-12bit) */
-#define FAMILY_CODE_MAX31826     0x3B  /* Temperature (12bit) + 1k EEPROM */
-#define FAMILY_CODE_DS28EA00     0x42  /* Temperature (9-12bit) + IO */
+/* MicroLAN coupler (DS2409) commands */
+#define CMD_ALL_LINES_OFF      0x66
+#define CMD_SMART_ON_MAIN      0xCC
+#define CMD_SMART_ON_AUX       0x33
+
+/* Chain control codes (DS28EA00) */
+#define CHAIN_OFF              0x3C
+#define CHAIN_ON               0x5A
+#define CHAIN_DONE             0x96
+#define CHAIN_CONFIRM          0xAA
+
+#define COPY_SCRATCHPAD_TIME   10      /* 10ms max (EEPROM write) */
 
 /* Timings */
 #define RESET_PULSE_TX_MIN_LEN   480    /* 480us min */
@@ -64,13 +72,53 @@
 
 #define MAX_TEMP_CONVERSION_TIME 750    /* 750ms */
 
+/* Current drawn from the bus by phantom powered sensor during conversion */
+#define PARASITIC_CONVERT_CURRENT 1500  /* 1.5mA max (DS18B20) */
+
+
+/* Protocol limits for timing-critical edges (jitter statistics) */
+#define WRITE1_LOW_MAX_LEN       15     /* 15us max */
+#define WRITE0_LOW_MAX_LEN       120    /* 120us max */
+#define READ_SAMPLE_MAX_TIME     15     /* 15us max */
+#define RESET_PULSE_MAX_LEN      960    /* 960us max */
+
+#define LINE_RECOVERY_TIME       120    /* max time (us) a slot may hold the line low */
+
+#if PICO_1WIRE_STATS
+#define STATS_ADD(ctx, field, n) ((ctx)->stats.field += (n))
+#define JITTER_START(ctx) uint32_t jitter_start = hal_time_us32()
+#define JITTER(ctx, field, intended, limit) \
+	record_jitter(&(ctx)->stats.field, hal_time_us32() - jitter_start, intended, limit)
+#else
+#define STATS_ADD(ctx, field, n)
+#define JITTER_START(ctx)
+#define JITTER(ctx, field, intended, limit)
+#endif
+
+#if PICO_1WIRE_TRACE_SIZE > 0
+#define TRACE_START(ctx) uint32_t trace_ts = hal_time_us32()
+#define TRACE(ctx, type, driven, sampled) trace_record(ctx, trace_ts, type, driven, sampled)
+#else
+#define TRACE_START(ctx)
+#define TRACE(ctx, type, driven, sampled)
+#endif
+
+/* Bus context storage (pico_1wire_t.storage) */
+#define CTX_STORAGE_FREE    0
+#define CTX_STORAGE_HEAP    1
+#define CTX_STORAGE_POOL    2
+#define CTX_STORAGE_CALLER  3
 
 #define ADDR_FAMILY_CODE(x) ((uint64_t)(x) >> 56)
 #define NULL_BUS_ADDRESS  (uint64_t)0
 
 
 
-static const uint8_t pico_1wire_crc8_lookup_table[] = {
+#if PICO_1WIRE_STATIC_POOL_SIZE > 0
+static pico_1wire_t ctx_pool[PICO_1WIRE_STATIC_POOL_SIZE];
+#endif
+
+static const uint8_t HAL_RAM_DATA("pico_1wire_crc8") pico_1wire_crc8_lookup_table[] = {
 	0, 94, 188, 226, 97, 63, 221, 131, 194, 156, 126, 32, 163, 253, 31, 65,
 	157, 195, 33, 127, 252, 162, 64, 30, 95, 1, 227, 189, 62, 96, 130, 220,
 	35, 125, 159, 193, 66, 28, 254, 160, 225, 191, 93, 3, 128, 222, 60, 98,
@@ -96,86 +144,381 @@ static inline uint8_t crc8(uint8_t crc, uint8_t data)
 }
 
 
+static inline uint16_t crc16(uint16_t crc, uint8_t data)
+{
+	static const uint8_t odd_parity[16] = { 0, 1, 1, 0, 1, 0, 0, 1, 1, 0, 0, 1, 0, 1, 1, 0 };
+	uint16_t d = (data ^ crc) & 0xff;
+
+	crc >>= 8;
+	if (odd_parity[d & 0x0f] ^ odd_parity[d >> 4])
+		crc ^= 0xc001;
+	d <<= 6;
+	crc ^= d;
+	d <<= 1;
+	crc ^= d;
+
+	return crc;
+}
+
+
+/* Device families that support Resume command (not supported by DS18x20, DS2438, DS2409, ...) */
+static const uint8_t resume_families[] = {
+	FAMILY_CODE_DS28EA00,
+	FAMILY_CODE_DS2431,
+	FAMILY_CODE_DS28EC20,
+	FAMILY_CODE_DS2408,
+	FAMILY_CODE_DS2413,
+};
+
+
+/* Device family drivers, driver_index maps family code to drivers[] (0 = no driver) */
+static const pico_1wire_driver_t *builtin_drivers[] = {
+	&pico_1wire_driver_ds18s20,
+	&pico_1wire_driver_ds1822,
+	&pico_1wire_driver_ds18b20,
+	&pico_1wire_driver_ds1825,
+	&pico_1wire_driver_ds28ea00,
+};
+static const pico_1wire_driver_t *drivers[PICO_1WIRE_MAX_DRIVERS + 1];
+static uint8_t driver_index[256];
+static uint driver_count = 0;
+
+
+static int add_driver(const pico_1wire_driver_t *driver)
+{
+	uint8_t i = driver_index[driver->family];
+
+	if (!i) {
+		if (driver_count >= PICO_1WIRE_MAX_DRIVERS)
+			return 1;
+		i = ++driver_count;
+		driver_index[driver->family] = i;
+	}
+	drivers[i] = driver;
+
+	return 0;
+}
+
+
+static void init_drivers()
+{
+	if (driver_count > 0)
+		return;
+
+	for (uint i = 0; i < sizeof(builtin_drivers) / sizeof(builtin_drivers[0]); i++)
+		add_driver(builtin_drivers[i]);
+}
+
+
+static inline const pico_1wire_driver_t* find_driver(uint64_t addr)
+{
+	return drivers[driver_index[ADDR_FAMILY_CODE(addr)]];
+}
+
+
+static inline uint conversion_time(pico_1wire_device_t *dev)
+{
+	const pico_1wire_driver_t *drv = (dev->driver ? dev->driver : find_driver(dev->addr));
+
+	if (drv && drv->conversion_time)
+		return drv->conversion_time(drv->resolution ? drv->resolution : dev->resolution);
+
+	return MAX_TEMP_CONVERSION_TIME;
+}
+
+
 static inline void uint64_set_bit(uint64_t *var, uint bit, bool value)
 {
 	*var = (*var & ~((uint64_t)1 << bit)) | ((uint64_t)value << bit);
 }
 
 
-static inline void power_mosfet_on(pico_1wire_t *ctx)
+static pico_1wire_device_t* find_device(pico_1wire_t *ctx, uint64_t addr);
+static void discover_power(pico_1wire_t *ctx);
+
+
+/* Return driver for a device. Devices sharing family code are identified using scratchpad
+   contents (read if not given), identified driver is cached in the device registry. */
+const pico_1wire_driver_t* find_device_driver(pico_1wire_t *ctx, uint64_t addr, const uint8_t *scratch)
+{
+	const pico_1wire_driver_t *drv = find_driver(addr);
+	const pico_1wire_driver_t *id;
+	pico_1wire_device_t *dev;
+	uint8_t buf[9];
+
+	if (!drv || !drv->identify)
+		return drv;
+
+	if ((dev = find_device(ctx, addr)) && dev->driver)
+		return dev->driver;
+
+	if (!scratch) {
+		if (pico_1wire_read_scratch_pad(ctx, addr, buf))
+			return drv;
+		scratch = buf;
+	}
+
+	if ((id = drv->identify(scratch)))
+		drv = id;
+	if (dev)
+		dev->driver = drv;
+
+	return drv;
+}
+
+
+static pico_1wire_device_t* find_device(pico_1wire_t *ctx, uint64_t addr)
+{
+	for (uint i = 0; i < ctx->device_count; i++) {
+		if (ctx->devices[i].addr == addr)
+			return &ctx->devices[i];
+	}
+
+	return NULL;
+}
+
+
+static uint branch_group(pico_1wire_t *ctx, uint64_t addr, uint64_t *coupler)
+{
+	pico_1wire_device_t *dev = find_device(ctx, addr);
+
+	*coupler = (dev ? dev->coupler : 0);
+	return (dev && dev->coupler ? dev->branch + 1 : 0);
+}
+
+
+/* Compare devices by coupler branch (main trunk first, then by coupler address and branch). */
+static int branch_cmp(pico_1wire_t *ctx, uint64_t a, uint64_t b)
+{
+	uint64_t ca, cb;
+	uint ga = branch_group(ctx, a, &ca);
+	uint gb = branch_group(ctx, b, &cb);
+
+	if (ca != cb)
+		return (ca < cb ? -1 : 1);
+
+	return (ga > gb) - (ga < gb);
+}
+
+
+/* Find next coupler branch (in branch_cmp() order) that has devices in the registry.
+   Start with coupler and group set to 0. */
+static bool next_branch_group(pico_1wire_t *ctx, uint64_t *coupler, uint *group)
+{
+	uint64_t best_c = 0;
+	uint best_g = 0;
+	bool found = false;
+
+	for (uint i = 0; i < ctx->device_count; i++) {
+		pico_1wire_device_t *dev = &ctx->devices[i];
+		uint64_t c = dev->coupler;
+		uint g = dev->branch + 1;
+
+		if (!c || c < *coupler || (c == *coupler && g <= *group))
+			continue;
+		if (!found || c < best_c || (c == best_c && g < best_g)) {
+			best_c = c;
+			best_g = g;
+			found = true;
+		}
+	}
+
+	if (found) {
+		*coupler = best_c;
+		*group = best_g;
+	}
+	return found;
+}
+
+
+/* Switch on coupler branch of the device, or switch all branches off for main trunk devices. */
+static int branch_group_on(pico_1wire_t *ctx, uint64_t addr)
+{
+	uint64_t coupler;
+	uint group = branch_group(ctx, addr, &coupler);
+
+	if (!group)
+		return (ctx->branch_coupler ? pico_1wire_branch_off(ctx) : 0);
+
+	return pico_1wire_branch_on(ctx, coupler, group - 1);
+}
+
+
+static bool needs_strong_pullup(pico_1wire_t *ctx, uint64_t addr)
+{
+	pico_1wire_device_t *dev;
+
+	if (addr && (dev = find_device(ctx, addr)))
+		return dev->parasitic;
+
+	/* Deferred power supply discovery (lazy initialization) */
+	if (!ctx->power_known)
+		discover_power(ctx);
+
+	return !ctx->psu_present;
+}
+
+
+HAL_INLINE void power_mosfet_on(pico_1wire_t *ctx)
 {
 	if (ctx->power_available)
-		gpio_put(ctx->power_pin, ctx->power_state);
+		hal_gpio_put(ctx->power_pin, ctx->power_state);
 }
 
 
-static inline void power_mosfet_off(pico_1wire_t *ctx)
+HAL_INLINE void power_mosfet_off(pico_1wire_t *ctx)
 {
 	if (ctx->power_available)
-		gpio_put(ctx->power_pin, !ctx->power_state);
+		hal_gpio_put(ctx->power_pin, !ctx->power_state);
 }
 
 
-static void write_bit(pico_1wire_t *ctx, bool data)
+/* Turn strong pull-up off (power MOSFET, or DS2482 strong pull-up on bridge bus). */
+static void pullup_off(pico_1wire_t *ctx)
+{
+	if (ctx->bridge)
+		ds2482_pullup(ctx, false);
+	else
+		power_mosfet_off(ctx);
+}
+
+
+#if PICO_1WIRE_STATS
+HAL_INLINE void record_jitter(pico_1wire_jitter_t *j, uint32_t actual, uint intended, uint limit)
+{
+	uint32_t late = (actual > intended ? actual - intended : 0);
+
+	j->count++;
+	j->total += late;
+	if (late > j->max)
+		j->max = late;
+	if (actual >= limit)
+		j->late++;
+}
+#endif
+
+
+HAL_INLINE bool irq_mask(pico_1wire_t *ctx, uint policy, uint32_t *state)
+{
+	if (ctx->irq_policy < policy)
+		return false;
+
+	*state = hal_irq_save();
+	return true;
+}
+
+
+#if PICO_1WIRE_TRACE_SIZE > 0
+HAL_INLINE void trace_record(pico_1wire_t *ctx, uint32_t timestamp, uint8_t type,
+				bool driven, bool sampled)
+{
+	pico_1wire_trace_t *t = &ctx->trace[ctx->trace_pos];
+
+	t->timestamp = timestamp;
+	t->type = type;
+	t->driven = driven;
+	t->sampled = sampled;
+
+	if (++ctx->trace_pos >= PICO_1WIRE_TRACE_SIZE)
+		ctx->trace_pos = 0;
+	ctx->trace_count++;
+}
+#endif
+
+
+/* Slot-level GPIO functions (placed in RAM when PICO_1WIRE_RAM_FUNCS is enabled).
+ * Bus contexts driven by DS2482 bridge are dispatched to the bridge backend
+ * by the byte/bit level functions below, so these never test ctx->bridge. */
+
+static void HAL_RAM_FUNC(gpio_write_bit)(pico_1wire_t *ctx, bool data)
 {
+	uint32_t irq_state = 0;
+	bool masked = irq_mask(ctx, (data ? PICO_1WIRE_IRQ_CRITICAL : PICO_1WIRE_IRQ_SLOT), &irq_state);
+
+	TRACE_START(ctx);
+
 	/* Start "Write" Slot */
-	gpio_set_dir(ctx->data_pin, GPIO_OUT);
-	gpio_put(ctx->data_pin, false);
-	sleep_us(3);
+	hal_gpio_set_dir(ctx->data_pin, HAL_GPIO_OUT);
+	hal_gpio_put(ctx->data_pin, false);
+	JITTER_START(ctx);
+	hal_sleep_us(3);
 
 	if (data) {
 		/* Write "1" */
-		gpio_put(ctx->data_pin, true);
-		sleep_us(WRITE_SLOT_LEN - 3);
+		hal_gpio_put(ctx->data_pin, true);
+		JITTER(ctx, write1_jitter, 3, WRITE1_LOW_MAX_LEN);
+		if (masked)
+			hal_irq_restore(irq_state);
+		hal_sleep_us(WRITE_SLOT_LEN - 3);
 	} else {
 		/* Write "0" */
-		sleep_us(WRITE_SLOT_LEN - 3);
-		gpio_put(ctx->data_pin, true);
+		hal_sleep_us(WRITE_SLOT_LEN - 3);
+		hal_gpio_put(ctx->data_pin, true);
+		JITTER(ctx, write0_jitter, WRITE_SLOT_LEN, WRITE0_LOW_MAX_LEN);
+		if (masked)
+			hal_irq_restore(irq_state);
 	}
 
 	/* Allow recovery time after write slot (1us minimum) */
-	sleep_us(WRITE_SLOT_RECOVERY_TIME);
+	hal_sleep_us(WRITE_SLOT_RECOVERY_TIME);
+
+	STATS_ADD(ctx, bits_written, 1);
+	STATS_ADD(ctx, bus_time, WRITE_SLOT_LEN + WRITE_SLOT_RECOVERY_TIME);
+	TRACE(ctx, PICO_1WIRE_TRACE_WRITE, data, hal_gpio_get(ctx->data_pin));
 }
 
 
-static void write_byte(pico_1wire_t *ctx, uint8_t data)
+static void HAL_RAM_FUNC(gpio_write_byte)(pico_1wire_t *ctx, uint8_t data)
 {
 	for (int i = 0; i < 8; i++) {
-		write_bit(ctx, data & 0x01);
+		gpio_write_bit(ctx, data & 0x01);
 		data >>= 1;
 	}
 }
 
 
-static bool read_bit(pico_1wire_t *ctx)
+static bool HAL_RAM_FUNC(gpio_read_bit)(pico_1wire_t *ctx)
 {
+	uint32_t irq_state = 0;
+	bool masked = irq_mask(ctx, PICO_1WIRE_IRQ_CRITICAL, &irq_state);
+
+	TRACE_START(ctx);
+
 	/* Start "Read" Slot */
-	gpio_set_dir(ctx->data_pin, GPIO_OUT);
-	gpio_put(ctx->data_pin, false);
-	sleep_us(3);
+	hal_gpio_set_dir(ctx->data_pin, HAL_GPIO_OUT);
+	hal_gpio_put(ctx->data_pin, false);
+	JITTER_START(ctx);
+	hal_sleep_us(3);
 
 	/* Release bus and let pull-up bring it high */
-	gpio_set_dir(ctx->data_pin, GPIO_IN);
+	hal_gpio_set_dir(ctx->data_pin, HAL_GPIO_IN);
 
 	/* Wait and read data from the device */
-	sleep_us(7);
-	bool result = gpio_get(ctx->data_pin);
-	sleep_us(READ_SLOT_LEN - 10);
+	hal_sleep_us(7);
+	bool result = hal_gpio_get(ctx->data_pin);
+	JITTER(ctx, read_jitter, 10, READ_SAMPLE_MAX_TIME);
+	if (masked)
+		hal_irq_restore(irq_state);
+	hal_sleep_us(READ_SLOT_LEN - 10);
 
 	/* Allow recovery time after read slot (1us minimum) */
-	sleep_us(READ_SLOT_RECOVERY_TIME);
+	hal_sleep_us(READ_SLOT_RECOVERY_TIME);
+
+	STATS_ADD(ctx, bits_read, 1);
+	STATS_ADD(ctx, bus_time, READ_SLOT_LEN + READ_SLOT_RECOVERY_TIME);
+	TRACE(ctx, PICO_1WIRE_TRACE_READ, true, result);
 
 	return result;
 }
 
 
-static uint8_t read_byte(pico_1wire_t *ctx)
+static uint8_t HAL_RAM_FUNC(gpio_read_byte)(pico_1wire_t *ctx)
 {
 	uint8_t result = 0;
 
 	for (int i = 0; i < 8; i++) {
 		result >>= 1;
-		if (read_bit(ctx)) {
+		if (gpio_read_bit(ctx)) {
 			result |= 0x80;
 		}
 	}
@@ -184,7 +527,69 @@ static uint8_t read_byte(pico_1wire_t *ctx)
 }
 
 
-static bool find_next_device(pico_1wire_t *ctx, uint64_t *addr, bool *done, uint *last_discrepancy)
+static void write_bit(pico_1wire_t *ctx, bool data)
+{
+	if (!ctx->bridge) {
+		gpio_write_bit(ctx, data);
+		return;
+	}
+
+	ds2482_bit(ctx, data);
+	STATS_ADD(ctx, bits_written, 1);
+	STATS_ADD(ctx, bus_time, WRITE_SLOT_LEN + WRITE_SLOT_RECOVERY_TIME);
+}
+
+
+static void write_byte(pico_1wire_t *ctx, uint8_t data)
+{
+	if (!ctx->bridge) {
+		gpio_write_byte(ctx, data);
+		return;
+	}
+
+	ds2482_write_byte(ctx, data);
+	STATS_ADD(ctx, bits_written, 8);
+	STATS_ADD(ctx, bus_time, 8 * (WRITE_SLOT_LEN + WRITE_SLOT_RECOVERY_TIME));
+}
+
+
+static bool read_bit(pico_1wire_t *ctx)
+{
+	if (!ctx->bridge)
+		return gpio_read_bit(ctx);
+
+	STATS_ADD(ctx, bits_read, 1);
+	STATS_ADD(ctx, bus_time, READ_SLOT_LEN + READ_SLOT_RECOVERY_TIME);
+	return ds2482_bit(ctx, true);
+}
+
+
+static uint8_t read_byte(pico_1wire_t *ctx)
+{
+	if (!ctx->bridge)
+		return gpio_read_byte(ctx);
+
+	STATS_ADD(ctx, bits_read, 8);
+	STATS_ADD(ctx, bus_time, 8 * (READ_SLOT_LEN + READ_SLOT_RECOVERY_TIME));
+	return ds2482_read_byte(ctx);
+}
+
+
+/* Write byte, and turn strong pull-up on right after the last bit if requested. */
+static void write_byte_pullup(pico_1wire_t *ctx, uint8_t data, bool pullup)
+{
+	/* DS2482 strong pull-up must be armed before the byte is written. */
+	if (pullup && ctx->bridge)
+		ds2482_pullup(ctx, true);
+
+	write_byte(ctx, data);
+
+	if (pullup)
+		power_mosfet_on(ctx);
+}
+
+
+static bool find_next_device(pico_1wire_t *ctx, uint8_t cmd, uint64_t *addr, bool *done, uint *last_discrepancy)
 {
 	bool result = false;
 	uint rom_bit_index = 1;
@@ -203,10 +608,30 @@ static bool find_next_device(pico_1wire_t *ctx, uint64_t *addr, bool *done, uint
 		return result;
 	}
 
-	/* Send Search ROM command */
-	write_byte(ctx, CMD_SEARCH);
+	/* Send Search ROM (or Alarm Search) command */
+	write_byte(ctx, cmd);
 
 	do {
+		if (ctx->bridge) {
+			/* DS2482 1-Wire Triplet: read both bits and write the chosen direction in one command. */
+			bool dir = (rom_bit_index == *last_discrepancy ||
+				(rom_bit_index < *last_discrepancy && (*addr & ((uint64_t)1 << (rom_bit_index - 1)))));
+
+			dir = ds2482_triplet(ctx, dir, &bit_a, &bit_b);
+			STATS_ADD(ctx, bits_read, 2);
+			STATS_ADD(ctx, bits_written, 1);
+			STATS_ADD(ctx, bus_time, 3 * (READ_SLOT_LEN + READ_SLOT_RECOVERY_TIME));
+			if (bit_a & bit_b) {
+				*last_discrepancy = 0;
+				return result;
+			}
+			if (bit_a == bit_b && !dir)
+				discrepancy = rom_bit_index;
+			uint64_set_bit(addr, rom_bit_index - 1, dir);
+			rom_bit_index++;
+			continue;
+		}
+
 		/* Read Responses */
 		bit_a = read_bit(ctx);
 		bit_b = read_bit(ctx);
@@ -242,8 +667,23 @@ static bool find_next_device(pico_1wire_t *ctx, uint64_t *addr, bool *done, uint
 }
 
 
+static bool resume_supported(uint64_t addr)
+{
+	for (uint i = 0; i < sizeof(resume_families); i++) {
+		if (ADDR_FAMILY_CODE(addr) == resume_families[i])
+			return true;
+	}
+
+	return false;
+}
+
+
 static int match_rom(pico_1wire_t *ctx, uint64_t addr)
 {
+	/* Devices behind a coupler are only reachable when their branch is on. */
+	if (addr && pico_1wire_branch_select(ctx, addr))
+		return 1;
+
 	if (!pico_1wire_reset_bus(ctx))
 		return 1;
 
@@ -258,135 +698,340 @@ static int match_rom(pico_1wire_t *ctx, uint64_t addr)
 		}
 	}
 
+	/* Only matched device (if any) can now be selected using Resume command */
+	ctx->resume_addr = (resume_supported(addr) ? addr : 0);
+
 	return 0;
 }
 
 
 
-/*****************************/
-/* Exposed Library Functions */
+static void track_conversion(pico_1wire_t *ctx, uint64_t addr, uint64_t start, bool done)
+{
+	pico_1wire_device_t *dev;
+	uint64_t now = hal_time_us();
+
+	/* If conversion is not known to be complete, estimate completion time based on device resolution. */
+	for (uint i = 0; i < ctx->device_count; i++) {
+		dev = &ctx->devices[i];
+		if (addr && dev->addr != addr)
+			continue;
+		/* Broadcast only reaches main trunk and the branch that is on. */
+		if (!addr && dev->coupler && (dev->coupler != ctx->branch_coupler || dev->branch != ctx->branch))
+			continue;
+		dev->conv_pending = true;
+		dev->conv_start = start;
+		dev->conv_ready = (done ? now :
+				start + (uint64_t)conversion_time(dev) * 1000);
+		if (addr)
+			break;
+	}
+}
 
 
-pico_1wire_t* pico_1wire_init(int data_pin, int power_pin, bool power_polarity)
+static int start_conversion(pico_1wire_t *ctx, uint64_t addr, bool pullup, uint wait)
 {
-	pico_1wire_t *ctx;
-
-	if (data_pin < 0)
-		return NULL;
+	/* Send Match ROM or Skip ROM command as needed... */
+	if (match_rom(ctx, addr))
+		return 1;
 
-	if (!(ctx = calloc(1, sizeof(pico_1wire_t))))
-		return NULL;
+	/* Send Convert Temperature command. */
+	write_byte_pullup(ctx, CMD_CONVERT, pullup);
 
-	ctx->data_pin = data_pin;
-	gpio_init(data_pin);
-	gpio_set_dir(data_pin, GPIO_IN);
+	uint64_t t_start = hal_time_us();
 
-	if (power_pin >= 0) {
-		ctx->power_available = true;
-		ctx->power_pin = power_pin;
-		ctx->power_state = power_polarity;
-		gpio_init(power_pin);
-		gpio_set_dir(power_pin, GPIO_OUT);
-		power_mosfet_off(ctx);
+	if (wait) {
+		if (pullup) {
+			hal_sleep_ms(wait);
+			pullup_off(ctx);
+		} else {
+			/* Poll for completion: device(s) respond with 0 while conversion is in progress. */
+			uint64_t t_end = t_start + (uint64_t)wait * 1000;
+			while (!read_bit(ctx) && hal_time_us() < t_end)
+				;
+		}
+		track_conversion(ctx, addr, t_start, true);
+	} else {
+		track_conversion(ctx, addr, t_start, false);
 	}
 
-	ctx->psu_present = true;
+	return 0;
+}
 
-	/* Check if any device in the bus uses phantom power. */
-	pico_1wire_read_power_supply(ctx, 0, NULL);
 
-	return ctx;
+
+/* Broadcast conversion. Skip ROM only reaches main trunk and the coupler branch that is on,
+   so when devices behind couplers are known, main trunk and each branch are converted in turn. */
+static int convert_all(pico_1wire_t *ctx, bool pullup, uint wait)
+{
+	uint64_t coupler = 0;
+	uint group = 0;
+	int res;
+
+	if (!next_branch_group(ctx, &coupler, &group))
+		return start_conversion(ctx, 0, pullup, wait);
+
+	/* Strong pull-up must stay on until conversion completes, so each conversion is then waited for. */
+	if (pico_1wire_branch_off(ctx))
+		return 1;
+	if (start_conversion(ctx, 0, pullup, (pullup ? MAX_TEMP_CONVERSION_TIME : 0)))
+		return 1;
+
+	do {
+		if ((res = pico_1wire_branch_on(ctx, coupler, group - 1))) {
+			if (res == 2)
+				continue; /* Empty branch */
+			return 1;
+		}
+		if (start_conversion(ctx, 0, pullup, (pullup ? MAX_TEMP_CONVERSION_TIME : 0)))
+			return 1;
+	} while (next_branch_group(ctx, &coupler, &group));
+
+	if (wait && !pullup)
+		hal_sleep_ms(wait);
+
+	return 0;
 }
 
 
-void pico_1wire_destroy(pico_1wire_t *ctx)
+static int plan_device_info(pico_1wire_t *ctx, uint64_t addr, bool *parasitic, uint *duration)
 {
-	if (!ctx)
-		return;
-
-	gpio_set_dir(ctx->data_pin, GPIO_IN);
+	pico_1wire_device_t *dev;
+	bool present;
 
-	if (ctx->power_available) {
-		gpio_set_dir(ctx->data_pin, GPIO_IN);
+	if ((dev = find_device(ctx, addr))) {
+		*parasitic = dev->parasitic;
+	} else {
+		if (pico_1wire_read_power_supply(ctx, addr, &present))
+			return 1;
+		*parasitic = !present;
 	}
+	if (pico_1wire_convert_duration(ctx, addr, duration))
+		return 1;
 
-	free(ctx);
+	return 0;
 }
 
 
-bool pico_1wire_reset_bus(pico_1wire_t *ctx)
+static inline void plan_step(pico_1wire_plan_step_t *step, uint8_t type, uint index,
+			bool strong_pullup, uint duration)
 {
-	bool device_found = false;
-	int i;
-
-	if (!ctx)
-		return device_found;
+	step->type = type;
+	step->index = index;
+	step->branch = index;
+	step->strong_pullup = strong_pullup;
+	step->duration = duration;
+}
 
-	/* Make sure power MOSFET is off (if one is present) */
-	power_mosfet_off(ctx);
 
-	/* Transmit Reset Pulse (480us minimum) */
-	gpio_set_dir(ctx->data_pin, GPIO_OUT);
-	gpio_put(ctx->data_pin, false);
-	sleep_us(RESET_PULSE_TX_MIN_LEN);
+static int plan_cmp(pico_1wire_t *ctx, const uint64_t *addr_list, const pico_1wire_plan_step_t *a,
+		const pico_1wire_plan_step_t *b)
+{
+	return branch_cmp(ctx, addr_list[a->index], addr_list[b->index]);
+}
 
-	/* Release bus and let pull-up bring it high */
-	gpio_set_dir(ctx->data_pin, GPIO_IN);
 
-	/* Listen for Presense Pulses from any devices (480us minimum) */
-	sleep_us(15);
-	for (i = 0; i <= 240; i+=10) {
-		if (!gpio_get(ctx->data_pin)) {
-			device_found = true;
-			break;
+/* Insertion sort (stable) of device steps by coupler branch. */
+static void plan_sort(pico_1wire_t *ctx, const uint64_t *addr_list, pico_1wire_plan_step_t *steps,
+		uint count)
+{
+	pico_1wire_plan_step_t tmp;
+
+	for (uint i = 1; i < count; i++) {
+		uint j = i;
+		tmp = steps[i];
+		while (j > 0 && plan_cmp(ctx, addr_list, &steps[j - 1], &tmp) > 0) {
+			steps[j] = steps[j - 1];
+			j--;
 		}
-		sleep_us(10);
+		steps[j] = tmp;
 	}
-	sleep_us(RESET_PULSE_RX_MIN_LEN - 15 - i);
-
-	return device_found;
 }
 
 
-int pico_1wire_read_rom(pico_1wire_t *ctx, uint64_t *addr)
+/* Return index of the first device (in sorted steps) not on the same coupler branch as steps[first]. */
+static uint plan_group_end(pico_1wire_t *ctx, const uint64_t *addr_list, const pico_1wire_plan_step_t *steps,
+		uint count, uint first)
 {
-	uint8_t crc = 0;
-	uint8_t b;
+	uint i = first + 1;
 
-	if (!ctx || !addr)
-		return -1;
+	while (i < count && !plan_cmp(ctx, addr_list, &steps[first], &steps[i]))
+		i++;
 
-	/* Reset bus and check if any devices present. */
-	if (!pico_1wire_reset_bus(ctx))
-		return 1;
+	return i;
+}
 
-	/* Send Read ROM command */
-	write_byte(ctx, CMD_READ);
 
-	/* Read ROM Address (64bit) */
-	*addr = 0;
-	for (int i = 0; i < 8; i++) {
-		b = read_byte(ctx);
-		if (i < 7)
-			crc = crc8(crc, b);
-		*addr <<= 8;
-		*addr |= b;
+/* Count phantom powered sensors in the registry that broadcast conversion reaches when
+   coupler branch of the device is on (main trunk and the branch). Returns false if
+   any of them is not in addr_list. */
+static bool plan_broadcast_load(pico_1wire_t *ctx, const uint64_t *addr_list, uint count,
+				uint64_t addr, uint *load)
+{
+	uint64_t coupler;
+	uint group = branch_group(ctx, addr, &coupler);
+	bool listed;
+
+	*load = 0;
+	for (uint i = 0; i < ctx->device_count; i++) {
+		pico_1wire_device_t *dev = &ctx->devices[i];
+
+		if (!dev->parasitic || !find_driver(dev->addr))
+			continue;
+		if (dev->coupler && (dev->coupler != coupler || dev->branch + 1 != group))
+			continue;
+		listed = false;
+		for (uint j = 0; j < count && !listed; j++)
+			listed = (addr_list[j] == dev->addr);
+		if (!listed)
+			return false;
+		(*load)++;
 	}
 
-	/* Check ROM checksum */
-	if (b != crc)
-		return 2;
+	return true;
+}
 
-	return 0;
+
+/* Add broadcast conversion step for main trunk devices (info[0...trunk_count-1])
+   and devices info[first...last-1], with coupler branch of info[first] on. */
+static uint plan_convert_all(pico_1wire_t *ctx, const uint64_t *addr_list, uint count,
+			const pico_1wire_plan_step_t *info, uint first, uint last, uint trunk_count,
+			pico_1wire_plan_step_t *steps, uint n)
+{
+	uint duration = 0, load;
+
+	for (uint i = 0; i < last; i++) {
+		if ((i < trunk_count || i >= first) && info[i].duration > duration)
+			duration = info[i].duration;
+	}
+	plan_broadcast_load(ctx, addr_list, count, addr_list[info[first].index], &load);
+	plan_step(&steps[n], PICO_1WIRE_STEP_CONVERT, PICO_1WIRE_ALL_DEVICES, load > 0, duration);
+	steps[n].branch = info[first].index;
+
+	return n + 1;
 }
 
 
-int pico_1wire_search_rom(pico_1wire_t *ctx, uint64_t  *addr_list, uint addr_list_size, uint *devices_found)
+/* Add read steps for externally powered devices converted using Match ROM. */
+static uint plan_ext_reads(const pico_1wire_plan_step_t *info, uint count, pico_1wire_plan_step_t *steps, uint n)
+{
+	for (uint i = 0; i < count; i++) {
+		if (info[i].branch != PICO_1WIRE_ALL_DEVICES && !info[i].strong_pullup)
+			plan_step(&steps[n++], PICO_1WIRE_STEP_READ, info[i].index, false, info[i].duration);
+	}
+
+	return n;
+}
+
+
+
+static void register_device(pico_1wire_t *ctx, uint64_t addr, uint n)
+{
+	pico_1wire_device_t tmp;
+
+	/* Registry is rebuilt during search, entries from n onwards are from previous search.
+	   Keep existing entry for the device if found, so that cached state is preserved. */
+	for (uint i = n; i < ctx->device_count; i++) {
+		if (ctx->devices[i].addr == addr) {
+			if (i != n) {
+				tmp = ctx->devices[n];
+				ctx->devices[n] = ctx->devices[i];
+				ctx->devices[i] = tmp;
+			}
+			return;
+		}
+	}
+
+	/* Move entry out of the way, if there is still room in the registry. */
+	if (n < ctx->device_count && ctx->device_count < PICO_1WIRE_MAX_DEVICES)
+		ctx->devices[ctx->device_count++] = ctx->devices[n];
+
+	memset(&ctx->devices[n], 0, sizeof(pico_1wire_device_t));
+	ctx->devices[n].addr = addr;
+	if (n >= ctx->device_count)
+		ctx->device_count = n + 1;
+}
+
+
+static void update_power_status(pico_1wire_t *ctx, bool complete)
+{
+	bool sensors_only = complete;
+	bool present = false;
+
+	/* Read Power Supply (0xB4) is a different command on other families (Convert V on DS2438),
+	   so bus wide status is only read when registry holds all devices and all are sensors. */
+	for (uint i = 0; i < ctx->device_count && sensors_only; i++) {
+		if (!find_driver(ctx->devices[i].addr))
+			sensors_only = false;
+	}
+	if (sensors_only && pico_1wire_read_power_supply(ctx, 0, &present))
+		return;
+
+	/* Check power supply status of each sensor in the registry (using Match ROM),
+	   unless all devices have power. */
+	for (uint i = 0; i < ctx->device_count; i++) {
+		pico_1wire_device_t *dev = &ctx->devices[i];
+
+		if (present || !find_driver(dev->addr))
+			dev->parasitic = false;
+		else if (pico_1wire_read_power_supply(ctx, dev->addr, NULL))
+			dev->parasitic = true;
+	}
+
+	if (!sensors_only) {
+		/* Bus wide status from the registry. Devices that did not fit
+		   in the registry are assumed to use phantom power. */
+		ctx->psu_present = complete;
+		for (uint i = 0; i < ctx->device_count; i++) {
+			if (ctx->devices[i].parasitic)
+				ctx->psu_present = false;
+		}
+		ctx->power_known = true;
+	}
+}
+
+
+
+static void adaptive_resolution(pico_1wire_t *ctx, const pico_1wire_driver_t *drv, pico_1wire_device_t *dev,
+			uint8_t *scratch, float temp)
+{
+	const pico_1wire_adaptive_config_t *cfg = &ctx->adaptive_config;
+	uint resolution = cfg->min_resolution;
+	bool precise = false;
+
+	if (!dev->prev_valid || fabsf(temp - dev->prev_temp) > cfg->stable_delta)
+		precise = true;
+	else if (!isnan(cfg->threshold_low) && fabsf(temp - cfg->threshold_low) <= cfg->threshold_margin)
+		precise = true;
+	else if (!isnan(cfg->threshold_high) && fabsf(temp - cfg->threshold_high) <= cfg->threshold_margin)
+		precise = true;
+
+	dev->prev_temp = temp;
+	dev->prev_valid = true;
+
+	if (precise) {
+		/* Find lowest resolution that meets the accuracy target (9bit = 0.5C ... 12bit = 0.0625C) */
+		while (resolution < 12 && (0.5f / (1 << (resolution - 9))) > cfg->accuracy)
+			resolution++;
+	}
+
+	if (resolution == dev->resolution)
+		return;
+
+	if (drv->set_resolution(scratch, resolution))
+		return;
+	if (!pico_1wire_write_scratch_pad(ctx, dev->addr, scratch))
+		dev->resolution = resolution;
+}
+
+
+static int search_devices(pico_1wire_t *ctx, uint8_t cmd, uint64_t  *addr_list, uint addr_list_size,
+			uint *devices_found, bool update_registry)
 {
 	bool done = false;
 	uint last_discrepancy = 0;
 	uint64_t rom_addr = 0;
-
+	uint registered = 0;
 
 	if (!ctx || !addr_list || !devices_found || addr_list_size < 1)
 		return -1;
@@ -397,8 +1042,9 @@ int pico_1wire_search_rom(pico_1wire_t *ctx, uint64_t  *addr_list, uint addr_lis
 	/* Reset bus and check if any devices are present. */
 	if (!pico_1wire_reset_bus(ctx))
 		return 1;
+	ctx->resume_addr = 0;
 
-	while (find_next_device(ctx, &rom_addr, &done, &last_discrepancy)) {
+	while (find_next_device(ctx, cmd, &rom_addr, &done, &last_discrepancy)) {
 		/* Check CRC and reverse byte order at the same time... */
 		uint64_t new_addr = 0;
 		uint8_t *p = &((uint8_t*)&new_addr)[7];
@@ -412,262 +1058,1522 @@ int pico_1wire_search_rom(pico_1wire_t *ctx, uint64_t  *addr_list, uint addr_lis
 		}
 		if (crc == byte) {
 			//printf("Found device: %016llX\n", new_addr);
-			if (*devices_found >= addr_list_size)
+			if (*devices_found >= addr_list_size) {
+				if (update_registry) {
+					ctx->device_count = registered;
+					ctx->registry_complete = false;
+					update_power_status(ctx, false);
+				}
 				return 2;
+			}
 			addr_list[*devices_found] = new_addr;
 			*devices_found = *devices_found + 1;
+			if (update_registry && registered < PICO_1WIRE_MAX_DEVICES)
+				register_device(ctx, new_addr, registered++);
 		} else {
 			//printf("Bad CRC: %016llX\n", new_addr);
+			STATS_ADD(ctx, search_crc_failures, 1);
 		}
 	}
 
+	if (update_registry) {
+		ctx->device_count = registered;
+		ctx->registry_complete = (*devices_found <= PICO_1WIRE_MAX_DEVICES);
+		update_power_status(ctx, ctx->registry_complete);
+	}
+
 	return 0;
 }
 
 
-int pico_1wire_read_power_supply(pico_1wire_t *ctx, uint64_t addr, bool *present)
+
+/* Bus wide power supply discovery. Search fills the device registry, and power
+   supply status is then checked based on device families found (see above). */
+static void discover_power(pico_1wire_t *ctx)
 {
-	if (!ctx)
-		return -1;
+	uint64_t addr_list[PICO_1WIRE_MAX_DEVICES + 1];
+	uint found;
+	int res;
+
+	ctx->power_known = false;
+	res = search_devices(ctx, CMD_SEARCH, addr_list, PICO_1WIRE_MAX_DEVICES + 1, &found, true);
+	if (res == 1) {
+		/* No devices */
+		ctx->psu_present = true;
+		ctx->power_known = true;
+	} else if (res && !ctx->power_known) {
+		ctx->psu_present = false;
+	}
+}
 
-	if (match_rom(ctx, addr))
-		return 1;
 
-	/* Send Read Power Supply command */
-	write_byte(ctx, CMD_READ_POWER_SUPPLY);
 
-	ctx->psu_present = read_bit(ctx);
+/*****************************/
+static pico_1wire_t* alloc_context(void)
+{
+	pico_1wire_t *ctx = NULL;
+
+#if PICO_1WIRE_STATIC_POOL_SIZE > 0
+	for (int i = 0; i < PICO_1WIRE_STATIC_POOL_SIZE; i++) {
+		if (ctx_pool[i].storage == CTX_STORAGE_FREE) {
+			ctx = &ctx_pool[i];
+			break;
+		}
+	}
+	if (!ctx)
+		return NULL;
+	memset(ctx, 0, sizeof(pico_1wire_t));
+	ctx->storage = CTX_STORAGE_POOL;
+#else
+	if (!(ctx = calloc(1, sizeof(pico_1wire_t))))
+		return NULL;
+	ctx->storage = CTX_STORAGE_HEAP;
+#endif
+
+	return ctx;
+}
 
-	if (present)
-		*present = ctx->psu_present;
 
-	return 0;
+static void free_context(pico_1wire_t *ctx)
+{
+	switch (ctx->storage) {
+	case CTX_STORAGE_HEAP:
+		free(ctx);
+		break;
+	case CTX_STORAGE_POOL:
+		ctx->storage = CTX_STORAGE_FREE;
+		break;
+	default:
+		/* Caller provided storage */
+		break;
+	}
 }
 
 
-int pico_1wire_read_scratch_pad(pico_1wire_t *ctx, uint64_t addr, uint8_t *buf)
+static void init_bus(pico_1wire_t *ctx, uint flags)
 {
-	const uint len = 9;
-	uint8_t crc = 0;
+	init_drivers();
 
-	if (!ctx || !buf)
-		return -1;
+	ctx->psu_present = true;
 
-	if (match_rom(ctx, addr))
-		return 1;
+	/* Check if any device in the bus uses phantom power. */
+	if (!(flags & PICO_1WIRE_INIT_LAZY))
+		discover_power(ctx);
+}
 
-	/* Send Read Scratch Pad command. */
-	write_byte(ctx, CMD_READ_SCRATCHPAD);
 
-	/* Read response and calculate CRC */
-	for (int i = 0; i < len; i++) {
-		buf[i] = read_byte(ctx);
-		if (i < (len - 1))
-			crc = crc8(crc, buf[i]);
+static void init_context(pico_1wire_t *ctx, int data_pin, int power_pin, bool power_polarity, uint flags)
+{
+	ctx->data_pin = data_pin;
+	hal_gpio_init(data_pin);
+	hal_gpio_set_dir(data_pin, HAL_GPIO_IN);
+
+	if (power_pin >= 0) {
+		ctx->power_available = true;
+		ctx->power_pin = power_pin;
+		ctx->power_state = power_polarity;
+		hal_gpio_init(power_pin);
+		hal_gpio_set_dir(power_pin, HAL_GPIO_OUT);
+		power_mosfet_off(ctx);
 	}
 
-	/* Check CRC checksum */
-	if (crc != buf[len - 1])
-		return 2;
+	init_bus(ctx, flags);
+}
 
-	return 0;
+
+/* Exposed Library Functions */
+
+
+pico_1wire_t* pico_1wire_init(int data_pin, int power_pin, bool power_polarity)
+{
+	return pico_1wire_init_ex(data_pin, power_pin, power_polarity, 0);
 }
 
 
-int pico_1wire_write_scratch_pad(pico_1wire_t *ctx, uint64_t addr, uint8_t *buf)
+pico_1wire_t* pico_1wire_init_ex(int data_pin, int power_pin, bool power_polarity, uint flags)
 {
-	if (!ctx || !buf)
-		return -1;
+	pico_1wire_t *ctx;
 
-	if (match_rom(ctx, addr))
-		return 1;
+	if (data_pin < 0)
+		return NULL;
+	if (!(ctx = alloc_context()))
+		return NULL;
 
+	init_context(ctx, data_pin, power_pin, power_polarity, flags);
 
-	/* Send Read Scratch Pad command. */
-	write_byte(ctx, CMD_WRITE_SCRATCHPAD);
+	return ctx;
+}
 
-	write_byte(ctx, buf[2]); /* T(H) register */
-	write_byte(ctx, buf[3]); /* T(L) register */
 
-	if (ADDR_FAMILY_CODE(addr) != FAMILY_CODE_DS18S20)
-		write_byte(ctx, buf[4]); /* Configuration register */
+pico_1wire_t* pico_1wire_init_static(void *buf, size_t size, int data_pin, int power_pin, bool power_polarity,
+				uint flags)
+{
+	pico_1wire_t *ctx = buf;
 
-	return 0;
+	if (!buf || size < sizeof(pico_1wire_t) || data_pin < 0)
+		return NULL;
+	if ((uintptr_t)buf % _Alignof(pico_1wire_t))
+		return NULL;
+
+	memset(ctx, 0, sizeof(pico_1wire_t));
+	ctx->storage = CTX_STORAGE_CALLER;
+
+	init_context(ctx, data_pin, power_pin, power_polarity, flags);
+
+	return ctx;
 }
 
 
-int pico_1wire_convert_duration(pico_1wire_t *ctx, uint64_t addr, uint *duration)
+pico_1wire_t* pico_1wire_init_ds2482(uint i2c_bus, uint8_t i2c_addr, int channel, uint flags)
 {
-	uint delay = MAX_TEMP_CONVERSION_TIME;
-	uint8_t scratch[9];
+	pico_1wire_t *ctx;
 
-	if (!ctx || !duration)
-		return -1;
+	if (channel < -1 || channel > 7)
+		return NULL;
+	if (!(ctx = alloc_context()))
+		return NULL;
 
-	if (addr) {
-		switch(ADDR_FAMILY_CODE(addr)) {
-
-		case FAMILY_CODE_DS18B20:
-		case FAMILY_CODE_DS1822:
-		case FAMILY_CODE_DS1825:
-		case FAMILY_CODE_DS28EA00:
-			if (!pico_1wire_read_scratch_pad(ctx, addr, scratch)) {
-				uint8_t resolution = ((scratch[4] & 0x7f) >> 5) + 9;
-				if (resolution == 9)
-					delay = 95;
-				else if (resolution == 10)
-					delay = 190;
-				else if (resolution == 11)
-					delay = 375;
-			}
-			break;
+	ctx->bridge = true;
+	ctx->i2c_bus = i2c_bus;
+	ctx->i2c_addr = i2c_addr;
+	ctx->channel = channel;
 
-		default:
-			break;
-		}
+	if (!ds2482_init(ctx)) {
+		free_context(ctx);
+		return NULL;
 	}
 
-	*duration = delay;
-	return 0;
+	init_bus(ctx, flags);
+
+	return ctx;
 }
 
 
-int pico_1wire_convert_temperature(pico_1wire_t *ctx, uint64_t addr, bool wait)
+void pico_1wire_destroy(pico_1wire_t *ctx)
 {
-	uint delay = MAX_TEMP_CONVERSION_TIME;
-
 	if (!ctx)
-		return -1;
-
-	/* Send Match ROM or Skip ROM command as needed... */
-	if (match_rom(ctx, addr))
-		return 1;
-
-	/* Send Convert Temperature command. */
-	write_byte(ctx, CMD_CONVERT);
+		return;
 
-	if (!ctx->psu_present)
-		power_mosfet_on(ctx);
+	if (!ctx->bridge) {
+		hal_gpio_set_dir(ctx->data_pin, HAL_GPIO_IN);
 
-	if (wait) {
-		sleep_ms(delay);
-		if (!ctx->psu_present)
-			power_mosfet_off(ctx);
+		if (ctx->power_available) {
+			hal_gpio_set_dir(ctx->power_pin, HAL_GPIO_IN);
+		}
 	}
 
-	return 0;
+	free_context(ctx);
 }
 
 
-int pico_1wire_get_temperature(pico_1wire_t *ctx, uint64_t addr, float *temperature)
+static int HAL_RAM_FUNC(gpio_reset_bus)(pico_1wire_t *ctx)
 {
-	uint8_t scratch[9];
-	int temp_read;
-	float temp;
-	int result = 0;
-
-	if (!ctx || !temperature)
-		return -1;
-
-	if (pico_1wire_read_scratch_pad(ctx, addr, scratch))
-		return 1;
+	bool device_found = false;
+	uint32_t irq_state = 0;
+	bool masked;
+	int i;
 
-	/* Convert reading to integer */
-	temp_read = (scratch[1] << 8) | scratch[0];
-	if (temp_read & 0x8000)
-		temp_read = - ((temp_read ^ 0xffff) + 1);
+	/* Make sure power MOSFET is off (if one is present) */
+	power_mosfet_off(ctx);
 
+	/* Line should be idle (high) before reset. If it is low, give possible
+	   slot in progress time to complete. (Fail fast if fault already known.) */
+	hal_gpio_set_dir(ctx->data_pin, HAL_GPIO_IN);
+	if (!hal_gpio_get(ctx->data_pin)) {
+		if (ctx->bus_fault < PICO_1WIRE_RESET_STUCK_LOW)
+			hal_sleep_us(LINE_RECOVERY_TIME);
+		if (!hal_gpio_get(ctx->data_pin)) {
+			STATS_ADD(ctx, line_faults, 1);
+			ctx->bus_fault = PICO_1WIRE_RESET_STUCK_LOW;
+			return ctx->bus_fault;
+		}
+	}
 
-	switch(ADDR_FAMILY_CODE(addr)) {
+	TRACE_START(ctx);
 
-	case FAMILY_CODE_DS1822:
-	case FAMILY_CODE_DS18B20:
-	case FAMILY_CODE_DS1825:
-	case FAMILY_CODE_DS28EA00:
-		temp =  (float)temp_read / 16.0;
-		break;
+	/* Transmit Reset Pulse (480us minimum) */
+	hal_gpio_set_dir(ctx->data_pin, HAL_GPIO_OUT);
+	hal_gpio_put(ctx->data_pin, false);
+	JITTER_START(ctx);
+	hal_sleep_us(RESET_PULSE_TX_MIN_LEN);
 
-	case FAMILY_CODE_DS18S20:
-		int count_remain = scratch[6];
-		int count_per_degree = scratch[7];
-		temp = (temp_read / 2) - 0.25 + (count_per_degree - count_remain) / (float)count_per_degree;
-		break;
+	/* Release bus and let pull-up bring it high */
+	masked = irq_mask(ctx, PICO_1WIRE_IRQ_SLOT, &irq_state);
+	hal_gpio_set_dir(ctx->data_pin, HAL_GPIO_IN);
+	JITTER(ctx, reset_jitter, RESET_PULSE_TX_MIN_LEN, RESET_PULSE_MAX_LEN);
 
-	default:
-		temp = (float)temp_read / 16.0; /* Best quess... */
-		result = 2; /* Return error code on unsupported sensors. */
-		break;
+	/* Listen for Presense Pulses from any devices (480us minimum) */
+	hal_sleep_us(15);
+	for (i = 0; i <= 240; i+=10) {
+		if (!hal_gpio_get(ctx->data_pin)) {
+			device_found = true;
+			break;
+		}
+		hal_sleep_us(10);
+	}
+	if (masked)
+		hal_irq_restore(irq_state);
+	hal_sleep_us(RESET_PULSE_RX_MIN_LEN - 15 - i);
+
+	/* Presence pulse is 240us max, so line must be back high by now */
+	bool shorted = !hal_gpio_get(ctx->data_pin);
+
+	STATS_ADD(ctx, resets, 1);
+	STATS_ADD(ctx, bus_time, RESET_PULSE_TX_MIN_LEN + RESET_PULSE_RX_MIN_LEN);
+	TRACE(ctx, PICO_1WIRE_TRACE_RESET, false, device_found && !shorted);
+
+	if (shorted) {
+		STATS_ADD(ctx, line_faults, 1);
+		ctx->bus_fault = PICO_1WIRE_RESET_SHORT;
+	} else if (!device_found) {
+		STATS_ADD(ctx, presence_failures, 1);
+		ctx->bus_fault = PICO_1WIRE_RESET_NO_PRESENCE;
+	} else {
+		ctx->bus_fault = PICO_1WIRE_RESET_OK;
 	}
 
-	*temperature = temp;
-
-	return result;
+	return ctx->bus_fault;
 }
 
 
-int pico_1wire_get_resolution(pico_1wire_t *ctx, uint64_t addr, uint *resolution)
+int pico_1wire_reset_bus_ex(pico_1wire_t *ctx)
 {
-	uint8_t scratch[9];
-
-	if (!ctx || !addr || !resolution)
+	if (!ctx)
 		return -1;
 
-	if (pico_1wire_read_scratch_pad(ctx, addr, scratch))
-		return 1;
-
-	switch(ADDR_FAMILY_CODE(addr)) {
-
-	case FAMILY_CODE_DS18B20:
-	case FAMILY_CODE_DS1822:
-	case FAMILY_CODE_DS1825:
-	case FAMILY_CODE_DS28EA00:
-		uint8_t res = ((scratch[4] & 0x7f) >> 5) + 9;
-		//printf("config: %02x, res=%u\n", scratch[4], res);
-		*resolution = res;
-		break;
-
-	case FAMILY_CODE_DS18S20:
-		*resolution = 9;
-		break;
+	if (!ctx->bridge)
+		return gpio_reset_bus(ctx);
 
-	default:
-		*resolution = 0;
-		return 2;
+	ctx->bus_fault = ds2482_reset(ctx);
+	STATS_ADD(ctx, resets, 1);
+	STATS_ADD(ctx, bus_time, RESET_PULSE_TX_MIN_LEN + RESET_PULSE_RX_MIN_LEN);
+	if (ctx->bus_fault == PICO_1WIRE_RESET_SHORT) {
+		STATS_ADD(ctx, line_faults, 1);
+	} else if (ctx->bus_fault == PICO_1WIRE_RESET_NO_PRESENCE) {
+		STATS_ADD(ctx, presence_failures, 1);
 	}
 
-	return 0;
+	return ctx->bus_fault;
 }
 
 
-int pico_1wire_set_resolution(pico_1wire_t *ctx, uint64_t addr, uint resolution)
+bool pico_1wire_reset_bus(pico_1wire_t *ctx)
 {
-	uint8_t scratch[9];
-	uint8_t new_cfg;
+	return (pico_1wire_reset_bus_ex(ctx) == PICO_1WIRE_RESET_OK);
+}
 
-	if (!ctx || !addr || resolution < 9 || resolution > 12)
+
+int pico_1wire_get_bus_fault(pico_1wire_t *ctx)
+{
+	if (!ctx)
 		return -1;
 
-	if (pico_1wire_read_scratch_pad(ctx, addr, scratch))
-		return 1;
+	return ctx->bus_fault;
+}
 
-	switch(ADDR_FAMILY_CODE(addr)) {
 
-	case FAMILY_CODE_DS18B20:
-	case FAMILY_CODE_DS1822:
-	case FAMILY_CODE_DS1825:
-	case FAMILY_CODE_DS28EA00:
-		new_cfg = (scratch[4] & 0x9f) | ((resolution - 9) << 5);
-		//printf("config: %02x, new config: %02x\n", scratch[4], new_cfg);
-		scratch[4] = new_cfg;
-		if (pico_1wire_write_scratch_pad(ctx, addr, scratch))
-			return 2;
-		break;
+int pico_1wire_read_rom(pico_1wire_t *ctx, uint64_t *addr)
+{
+	uint8_t crc = 0;
+	uint8_t b;
 
-	default:
-		return 3;
-	}
+	if (!ctx || !addr)
+		return -1;
 
-	return 0;
-}
+	/* Reset bus and check if any devices present. */
+	if (!pico_1wire_reset_bus(ctx))
+		return 1;
 
+	/* Send Read ROM command */
+	write_byte(ctx, CMD_READ);
+	ctx->resume_addr = 0;
 
+	/* Read ROM Address (64bit) */
+	*addr = 0;
+	for (int i = 0; i < 8; i++) {
+		b = read_byte(ctx);
+		if (i < 7)
+			crc = crc8(crc, b);
+		*addr <<= 8;
+		*addr |= b;
+	}
+
+	/* Check ROM checksum */
+	if (b != crc)
+		return 2;
+
+	return 0;
+}
+
+
+int pico_1wire_search_rom(pico_1wire_t *ctx, uint64_t  *addr_list, uint addr_list_size, uint *devices_found)
+{
+	return search_devices(ctx, CMD_SEARCH, addr_list, addr_list_size, devices_found, true);
+}
+
+
+static int chain_control(pico_1wire_t *ctx, uint64_t addr, uint8_t control)
+{
+	/* Send Match ROM or Skip ROM command as needed... */
+	if (match_rom(ctx, addr))
+		return 1;
+
+	/* Send Chain command, control byte and its inverse. */
+	write_byte(ctx, CMD_CHAIN);
+	write_byte(ctx, control);
+	write_byte(ctx, ~control);
+
+	return (read_byte(ctx) == CHAIN_CONFIRM ? 0 : 3);
+}
+
+
+int pico_1wire_sequence_discovery(pico_1wire_t *ctx, uint64_t *addr_list, uint addr_list_size, uint *devices_found)
+{
+	pico_1wire_device_t *dev;
+	uint64_t addr;
+	uint8_t crc, b;
+	int res;
+
+	if (!ctx || !addr_list || !devices_found || addr_list_size < 1)
+		return -1;
+
+	*devices_found = 0;
+	memset(addr_list, 0, addr_list_size * sizeof(uint64_t));
+	for (uint i = 0; i < ctx->device_count; i++)
+		ctx->devices[i].position = 0;
+
+	if ((res = chain_control(ctx, 0, CHAIN_ON)))
+		return res;
+
+	while (1) {
+		/* Only the first device in chain (not yet done) responds to Conditional Read ROM. */
+		if (!pico_1wire_reset_bus(ctx)) {
+			res = 1;
+			break;
+		}
+		write_byte(ctx, CMD_COND_READ);
+		ctx->resume_addr = 0;
+
+		addr = 0;
+		crc = 0;
+		for (int i = 0; i < 8; i++) {
+			b = read_byte(ctx);
+			if (i < 7)
+				crc = crc8(crc, b);
+			addr <<= 8;
+			addr |= b;
+		}
+		if (addr == ~(uint64_t)0)
+			break; /* No response, all devices done */
+		if (b != crc) {
+			STATS_ADD(ctx, search_crc_failures, 1);
+			res = 3;
+			break;
+		}
+		if (*devices_found >= addr_list_size) {
+			res = 2;
+			break;
+		}
+		addr_list[(*devices_found)++] = addr;
+
+		if (!(dev = find_device(ctx, addr))) {
+			/* Device was not found by previous search (power status not known). */
+			ctx->registry_complete = false;
+			if (ctx->device_count < PICO_1WIRE_MAX_DEVICES) {
+				register_device(ctx, addr, ctx->device_count);
+				dev = &ctx->devices[ctx->device_count - 1];
+			}
+		}
+		if (dev)
+			dev->position = *devices_found;
+
+		/* Mark device done, this enables next device in the chain. */
+		if ((res = chain_control(ctx, addr, CHAIN_DONE)))
+			break;
+	}
+
+	/* Turn chain mode off (on all devices). */
+	if (chain_control(ctx, 0, CHAIN_OFF) && !res)
+		res = 3;
+
+	return res;
+}
+
+
+int pico_1wire_get_position(pico_1wire_t *ctx, uint64_t addr, uint *position)
+{
+	pico_1wire_device_t *dev;
+
+	if (!ctx || !position)
+		return -1;
+
+	if (!(dev = find_device(ctx, addr)) || !dev->position)
+		return 1;
+
+	*position = dev->position;
+	return 0;
+}
+
+
+static int coupler_command(pico_1wire_t *ctx, uint64_t coupler, uint8_t cmd, bool *presence)
+{
+	uint8_t response;
+
+	/* Send Match ROM or Skip ROM command as needed... */
+	if (match_rom(ctx, coupler))
+		return 1;
+
+	write_byte(ctx, cmd);
+	if (presence) {
+		/* Smart-On: reset stimulus, then presence detect result from the branch */
+		read_byte(ctx);
+		*presence = (read_byte(ctx) == 0);
+	}
+
+	/* Coupler confirms the command by echoing it */
+	response = read_byte(ctx);
+
+	return (response == cmd ? 0 : 3);
+}
+
+
+int pico_1wire_branch_discovery(pico_1wire_t *ctx, uint64_t *addr_list, uint addr_list_size, uint *devices_found)
+{
+	pico_1wire_device_t *dev;
+	uint trunk, base, n;
+	int res;
+
+	if (!ctx || !addr_list || !devices_found || addr_list_size < 1)
+		return -1;
+
+	/* Search main trunk, with all branches off. */
+	for (uint i = 0; i < ctx->device_count; i++) {
+		ctx->devices[i].coupler = 0;
+		ctx->devices[i].branch = 0;
+	}
+	pico_1wire_branch_off(ctx);
+	if ((res = search_devices(ctx, CMD_SEARCH, addr_list, addr_list_size, devices_found, true)))
+		return res;
+	trunk = *devices_found;
+
+	for (uint c = 0; c < trunk && !res; c++) {
+		if ((addr_list[c] >> 56) != FAMILY_CODE_DS2409)
+			continue;
+
+		for (uint branch = PICO_1WIRE_BRANCH_MAIN; branch <= PICO_1WIRE_BRANCH_AUX && !res; branch++) {
+			if ((res = pico_1wire_branch_on(ctx, addr_list[c], branch))) {
+				if (res == 2)
+					res = 0; /* Empty branch */
+				continue;
+			}
+			if (*devices_found >= addr_list_size) {
+				res = 2;
+				break;
+			}
+			base = *devices_found;
+			res = search_devices(ctx, CMD_SEARCH, &addr_list[base], addr_list_size - base, &n, false);
+			if (res && res != 2)
+				break;
+
+			/* Keep only devices behind the branch (main trunk devices are visible too). */
+			for (uint i = 0; i < n; i++) {
+				uint64_t addr = addr_list[base + i];
+				bool on_trunk = false;
+				for (uint j = 0; j < trunk && !on_trunk; j++)
+					on_trunk = (addr_list[j] == addr);
+				if (on_trunk)
+					continue;
+				addr_list[(*devices_found)++] = addr;
+
+				if (!(dev = find_device(ctx, addr)) && ctx->device_count < PICO_1WIRE_MAX_DEVICES) {
+					register_device(ctx, addr, ctx->device_count);
+					dev = &ctx->devices[ctx->device_count - 1];
+				}
+				if (!dev)
+					ctx->registry_complete = false;
+				if (dev) {
+					dev->coupler = addr_list[c];
+					dev->branch = branch;
+					/* Read Power Supply is only sent to sensors (0xB4 is Convert V on DS2438...) */
+					if (find_driver(addr))
+						pico_1wire_read_power_supply(ctx, addr, NULL);
+				}
+			}
+			memset(&addr_list[*devices_found], 0, (addr_list_size - *devices_found) * sizeof(uint64_t));
+		}
+	}
+
+	if (pico_1wire_branch_off(ctx) && !res)
+		res = 1;
+	if (res)
+		ctx->registry_complete = false;
+
+	return res;
+}
+
+
+int pico_1wire_branch_on(pico_1wire_t *ctx, uint64_t coupler, uint branch)
+{
+	bool presence;
+	int res;
+
+	if (!ctx || branch > PICO_1WIRE_BRANCH_AUX)
+		return -1;
+
+	if (!coupler)
+		return pico_1wire_branch_off(ctx);
+
+	if (ctx->branch_coupler == coupler && ctx->branch == branch)
+		return 0;
+
+	if (ctx->branch_coupler && ctx->branch_coupler != coupler) {
+		if ((res = coupler_command(ctx, ctx->branch_coupler, CMD_ALL_LINES_OFF, NULL)))
+			return res;
+		ctx->branch_coupler = 0;
+	}
+
+	res = coupler_command(ctx, coupler, (branch == PICO_1WIRE_BRANCH_MAIN ?
+				CMD_SMART_ON_MAIN : CMD_SMART_ON_AUX), &presence);
+	if (res)
+		return res;
+	ctx->branch_coupler = coupler;
+	ctx->branch = branch;
+
+	return (presence ? 0 : 2);
+}
+
+
+int pico_1wire_branch_off(pico_1wire_t *ctx)
+{
+	if (!ctx)
+		return -1;
+
+	ctx->branch_coupler = 0;
+
+	/* Skip ROM + All Lines Off, confirmation is ignored as there may be no couplers on the bus. */
+	return (coupler_command(ctx, 0, CMD_ALL_LINES_OFF, NULL) == 1 ? 1 : 0);
+}
+
+
+int pico_1wire_branch_select(pico_1wire_t *ctx, uint64_t addr)
+{
+	uint64_t coupler;
+	uint group;
+
+	if (!ctx)
+		return -1;
+
+	if (!(group = branch_group(ctx, addr, &coupler)))
+		return 0;
+
+	return pico_1wire_branch_on(ctx, coupler, group - 1);
+}
+
+
+int pico_1wire_branch_sort(pico_1wire_t *ctx, uint64_t *addr_list, uint count)
+{
+	if (!ctx || (!addr_list && count > 0))
+		return -1;
+
+	/* Insertion sort (stable) by coupler address and branch, main trunk first. */
+	for (uint i = 1; i < count; i++) {
+		uint64_t addr = addr_list[i];
+		uint j = i;
+		while (j > 0 && branch_cmp(ctx, addr_list[j - 1], addr) > 0) {
+			addr_list[j] = addr_list[j - 1];
+			j--;
+		}
+		addr_list[j] = addr;
+	}
+
+	return 0;
+}
+
+
+int pico_1wire_read_power_supply(pico_1wire_t *ctx, uint64_t addr, bool *present)
+{
+	if (!ctx)
+		return -1;
+
+	if (match_rom(ctx, addr))
+		return 1;
+
+	/* Send Read Power Supply command */
+	write_byte(ctx, CMD_READ_POWER_SUPPLY);
+
+	bool psu = read_bit(ctx);
+
+	if (addr) {
+		pico_1wire_device_t *dev = find_device(ctx, addr);
+		if (dev)
+			dev->parasitic = !psu;
+		if (!psu)
+			ctx->psu_present = false;
+	} else {
+		ctx->psu_present = psu;
+		ctx->power_known = true;
+	}
+
+	if (present)
+		*present = psu;
+
+	return 0;
+}
+
+
+int pico_1wire_read_scratch_pad(pico_1wire_t *ctx, uint64_t addr, uint8_t *buf)
+{
+	const uint len = 9;
+	uint8_t crc = 0;
+
+	if (!ctx || !buf)
+		return -1;
+
+	if (match_rom(ctx, addr))
+		return 1;
+
+	/* Send Read Scratch Pad command. */
+	write_byte(ctx, CMD_READ_SCRATCHPAD);
+
+	/* Read response and calculate CRC */
+	for (int i = 0; i < len; i++) {
+		buf[i] = read_byte(ctx);
+		if (i < (len - 1))
+			crc = crc8(crc, buf[i]);
+	}
+
+	/* Check CRC checksum */
+	if (crc != buf[len - 1]) {
+		STATS_ADD(ctx, crc_failures, 1);
+		return 2;
+	}
+
+	return 0;
+}
+
+
+/* Write scratchpad of a device using given driver (NULL if device is not known). */
+static int write_scratch(pico_1wire_t *ctx, uint64_t addr, const uint8_t *buf, const pico_1wire_driver_t *drv)
+{
+	/* Device without writable scratchpad (MAX31850/MAX31851). */
+	if (drv && drv->config_len == 0)
+		return 3;
+
+	if (match_rom(ctx, addr))
+		return 1;
+
+	/* Send Write Scratch Pad command. */
+	write_byte(ctx, CMD_WRITE_SCRATCHPAD);
+
+	write_byte(ctx, buf[2]); /* T(H) register */
+	write_byte(ctx, buf[3]); /* T(L) register */
+
+	if (!drv || drv->config_len > 2)
+		write_byte(ctx, buf[4]); /* Configuration register */
+
+	return 0;
+}
+
+
+int pico_1wire_write_scratch_pad(pico_1wire_t *ctx, uint64_t addr, uint8_t *buf)
+{
+	if (!ctx || !buf)
+		return -1;
+
+	/* Devices sharing family code (DS1825/MAX31850) are told apart by the driver lookup. */
+	return write_scratch(ctx, addr, buf, find_device_driver(ctx, addr, NULL));
+}
+
+
+int pico_1wire_convert_duration(pico_1wire_t *ctx, uint64_t addr, uint *duration)
+{
+	uint delay = MAX_TEMP_CONVERSION_TIME;
+	const pico_1wire_driver_t *drv;
+	pico_1wire_device_t *dev;
+	uint8_t scratch[9];
+
+	if (!ctx || !duration)
+		return -1;
+
+	if (addr && (drv = find_device_driver(ctx, addr, NULL)) && drv->conversion_time) {
+		uint res = drv->resolution;
+
+		if (!res) {
+			if ((dev = find_device(ctx, addr)) && dev->resolution) {
+				res = dev->resolution;
+			}
+			else if (drv->get_resolution && !pico_1wire_read_scratch_pad(ctx, addr, scratch)) {
+				res = drv->get_resolution(scratch);
+				if (dev)
+					dev->resolution = res;
+			}
+		}
+		delay = drv->conversion_time(res);
+	}
+
+	*duration = delay;
+	return 0;
+}
+
+
+int pico_1wire_convert_temperature(pico_1wire_t *ctx, uint64_t addr, bool wait)
+{
+	if (!ctx)
+		return -1;
+
+	if (!addr)
+		return convert_all(ctx, needs_strong_pullup(ctx, 0), (wait ? MAX_TEMP_CONVERSION_TIME : 0));
+
+	return start_conversion(ctx, addr, needs_strong_pullup(ctx, addr),
+				(wait ? MAX_TEMP_CONVERSION_TIME : 0));
+}
+
+
+int pico_1wire_get_temperature(pico_1wire_t *ctx, uint64_t addr, float *temperature)
+{
+	const pico_1wire_driver_t *drv;
+	pico_1wire_device_t *dev;
+	uint8_t scratch[9];
+	float temp;
+	int result = 0;
+
+	if (!ctx || !temperature)
+		return -1;
+
+	if (pico_1wire_read_scratch_pad(ctx, addr, scratch))
+		return 1;
+
+	if ((drv = find_device_driver(ctx, addr, scratch)) && drv->decode) {
+		result = drv->decode(scratch, &temp);
+	} else {
+		/* Convert reading to integer */
+		int temp_read = (scratch[1] << 8) | scratch[0];
+		if (temp_read & 0x8000)
+			temp_read = - ((temp_read ^ 0xffff) + 1);
+		temp = (float)temp_read / 16.0; /* Best quess... */
+		result = 2; /* Return error code on unsupported sensors. */
+	}
+
+	*temperature = temp;
+
+	if (!result && (dev = find_device(ctx, addr))) {
+		/* Update temperature cache, if reading is result of a known conversion. */
+		if (dev->conv_pending && hal_time_us() >= dev->conv_ready) {
+			dev->temperature = temp;
+			dev->timestamp = dev->conv_start;
+			dev->temp_valid = true;
+			dev->conv_pending = false;
+		}
+		if (drv->get_resolution) {
+			dev->resolution = drv->get_resolution(scratch);
+			if (ctx->adaptive && drv->set_resolution)
+				adaptive_resolution(ctx, drv, dev, scratch, temp);
+		}
+	}
+
+	return result;
+}
+
+
+int pico_1wire_get_temperature_cached(pico_1wire_t *ctx, uint64_t addr, uint max_age, float *temperature)
+{
+	pico_1wire_device_t *dev;
+	uint64_t max_age_us = (uint64_t)max_age * 1000;
+	uint64_t now;
+	int res;
+
+	if (!ctx || !addr || !temperature)
+		return -1;
+
+	if (!(dev = find_device(ctx, addr))) {
+		/* Device not in registry, no caching possible. */
+		if ((res = pico_1wire_convert_temperature(ctx, addr, true)))
+			return res;
+		return pico_1wire_get_temperature(ctx, addr, temperature);
+	}
+
+	now = hal_time_us();
+
+	if (dev->temp_valid && now - dev->timestamp <= max_age_us) {
+		*temperature = dev->temperature;
+		return 0;
+	}
+
+	if (!dev->conv_pending || now - dev->conv_start > max_age_us) {
+		/* Start new conversion and wait for it to complete. */
+		if (start_conversion(ctx, addr, dev->parasitic, conversion_time(dev)))
+			return 1;
+	} else if (now < dev->conv_ready) {
+		/* Recent enough conversion already in progress, wait for it to complete. */
+		hal_sleep_us(dev->conv_ready - now);
+	}
+
+	return pico_1wire_get_temperature(ctx, addr, temperature);
+}
+
+
+int pico_1wire_get_resolution(pico_1wire_t *ctx, uint64_t addr, uint *resolution)
+{
+	const pico_1wire_driver_t *drv;
+	uint8_t scratch[9];
+
+	if (!ctx || !addr || !resolution)
+		return -1;
+
+	if (pico_1wire_read_scratch_pad(ctx, addr, scratch))
+		return 1;
+
+	drv = find_device_driver(ctx, addr, scratch);
+	if (drv && drv->resolution) {
+		*resolution = drv->resolution;
+	} else if (drv && drv->get_resolution) {
+		*resolution = drv->get_resolution(scratch);
+	} else {
+		*resolution = 0;
+		return 2;
+	}
+
+	return 0;
+}
+
+
+int pico_1wire_set_resolution(pico_1wire_t *ctx, uint64_t addr, uint resolution)
+{
+	const pico_1wire_driver_t *drv;
+	pico_1wire_device_t *dev;
+	uint8_t scratch[9];
+
+	if (!ctx || !addr || resolution < 9 || resolution > 12)
+		return -1;
+
+	if (pico_1wire_read_scratch_pad(ctx, addr, scratch))
+		return 1;
+
+	drv = find_device_driver(ctx, addr, scratch);
+	if (!drv || !drv->set_resolution || drv->set_resolution(scratch, resolution))
+		return 3;
+
+	if (write_scratch(ctx, addr, scratch, drv))
+		return 2;
+	if ((dev = find_device(ctx, addr)))
+		dev->resolution = resolution;
+
+	return 0;
+}
+
+
+
+
+int pico_1wire_plan_conversions(pico_1wire_t *ctx, const uint64_t *addr_list, uint count,
+				uint current_budget, pico_1wire_plan_step_t *steps,
+				uint max_steps, uint *step_count)
+{
+	pico_1wire_plan_step_t *info;
+	uint64_t coupler;
+	uint cap = current_budget / PARASITIC_CONVERT_CURRENT;
+	uint trunk_count = 0;
+	uint n = 0, load, duration;
+	bool broadcast, branch_broadcast = false, trunk_read = false;
+	bool any_parasitic = false, ext_pending = false;
+	bool parasitic;
+
+	if (!ctx || !addr_list || !steps || !step_count || count < 1
+		|| count >= PICO_1WIRE_ALL_DEVICES
+		|| max_steps < PICO_1WIRE_PLAN_MAX_STEPS(count))
+		return -1;
+
+	*step_count = 0;
+	memset(steps, 0, max_steps * sizeof(pico_1wire_plan_step_t));
+
+	/* Query each device only once. Power supply status and conversion time are kept
+	   in a work area at the end of steps[] (plan itself never has more than 2 * count steps). */
+	info = &steps[max_steps - count];
+	for (uint i = 0; i < count; i++) {
+		if (plan_device_info(ctx, addr_list[i], &parasitic, &duration))
+			return 1;
+		plan_step(&info[i], PICO_1WIRE_STEP_CONVERT, i, parasitic, duration);
+		any_parasitic |= parasitic;
+	}
+
+	/* Budget does not cover even a single phantom powered sensor. */
+	if (any_parasitic && cap < 1)
+		return 2;
+
+	/* Broadcast conversion reaches every device on main trunk (and the branch that is on),
+	   so it is only used when all devices are known. */
+	broadcast = ctx->registry_complete;
+	for (uint i = 0; i < count && broadcast; i++) {
+		if (!find_device(ctx, addr_list[i]))
+			broadcast = false;
+	}
+
+	/* Group devices by coupler branch (main trunk first), and mark devices converted
+	   by broadcast (branch set to PICO_1WIRE_ALL_DEVICES): each branch where phantom powered
+	   sensors (on main trunk and the branch) fit in the budget, and main trunk along with
+	   those (or alone, if it fits). */
+	plan_sort(ctx, addr_list, info, count);
+	if (!branch_group(ctx, addr_list[info[0].index], &coupler))
+		trunk_count = plan_group_end(ctx, addr_list, info, count, 0);
+	for (uint i = trunk_count, j; i < count && broadcast; i = j) {
+		j = plan_group_end(ctx, addr_list, info, count, i);
+		if (plan_broadcast_load(ctx, addr_list, count, addr_list[info[i].index], &load) && load <= cap) {
+			for (uint k = i; k < j; k++)
+				info[k].branch = PICO_1WIRE_ALL_DEVICES;
+			branch_broadcast = true;
+		}
+	}
+	if (trunk_count > 0 && (branch_broadcast || (broadcast
+			&& plan_broadcast_load(ctx, addr_list, count, addr_list[info[0].index], &load)
+			&& load <= cap))) {
+		for (uint k = 0; k < trunk_count; k++)
+			info[k].branch = PICO_1WIRE_ALL_DEVICES;
+	}
+
+	/* Externally powered sensors not converted by broadcast: conversions are started first,
+	   and sensors are read during the first gap between strong pull-up periods. */
+	for (uint i = 0; i < count; i++) {
+		if (info[i].branch != PICO_1WIRE_ALL_DEVICES && !info[i].strong_pullup) {
+			plan_step(&steps[n++], PICO_1WIRE_STEP_CONVERT, info[i].index, false, 0);
+			ext_pending = true;
+		}
+	}
+
+	/* Broadcast conversions (one per branch, or main trunk alone), each followed by reading
+	   sensors converted (main trunk sensors are read after the first one). */
+	for (uint i = (branch_broadcast ? trunk_count : 0), j; i < count; i = j) {
+		j = plan_group_end(ctx, addr_list, info, count, i);
+		if (info[i].branch != PICO_1WIRE_ALL_DEVICES)
+			continue;
+
+		n = plan_convert_all(ctx, addr_list, count, info, i, j, trunk_count, steps, n);
+		if (ext_pending)
+			n = plan_ext_reads(info, count, steps, n);
+		ext_pending = false;
+		if (!trunk_read) {
+			for (uint k = 0; k < trunk_count; k++)
+				plan_step(&steps[n++], PICO_1WIRE_STEP_READ, info[k].index, false, 0);
+			trunk_read = true;
+		}
+		for (uint k = (i < trunk_count ? trunk_count : i); k < j; k++)
+			plan_step(&steps[n++], PICO_1WIRE_STEP_READ, info[k].index, false, 0);
+	}
+
+	/* Remaining phantom powered sensors one at a time (selected conversions cannot
+	   overlap, as strong pull-up keeps the bus busy): conversion followed by read. */
+	for (uint i = 0; i < count; i++) {
+		if (info[i].branch == PICO_1WIRE_ALL_DEVICES || !info[i].strong_pullup)
+			continue;
+		plan_step(&steps[n++], PICO_1WIRE_STEP_CONVERT, info[i].index, true, info[i].duration);
+		if (ext_pending)
+			n = plan_ext_reads(info, count, steps, n);
+		ext_pending = false;
+		plan_step(&steps[n++], PICO_1WIRE_STEP_READ, info[i].index, false, 0);
+	}
+	if (ext_pending)
+		n = plan_ext_reads(info, count, steps, n);
+
+	memset(info, 0, count * sizeof(pico_1wire_plan_step_t));
+	*step_count = n;
+
+	return 0;
+}
+
+
+int pico_1wire_run_conversion_plan(pico_1wire_t *ctx, const uint64_t *addr_list, uint count,
+				const pico_1wire_plan_step_t *steps, uint step_count,
+				float *temperatures, int *results)
+{
+	uint64_t start = 0;
+	bool started = false;
+	int ret = 0;
+
+	if (!ctx || !addr_list || !steps || !temperatures || count < 1)
+		return -1;
+
+	for (uint i = 0; i < step_count; i++) {
+		const pico_1wire_plan_step_t *s = &steps[i];
+		uint64_t addr;
+
+		if (s->index != PICO_1WIRE_ALL_DEVICES && s->index >= count)
+			return -1;
+		addr = (s->index == PICO_1WIRE_ALL_DEVICES ? 0 : addr_list[s->index]);
+
+		if (s->type == PICO_1WIRE_STEP_CONVERT) {
+			/* Broadcast conversion only reaches main trunk and the selected coupler branch. */
+			if (!addr) {
+				if (s->branch >= count)
+					return -1;
+				if (branch_group_on(ctx, addr_list[s->branch]))
+					return 1;
+			}
+			if (!started) {
+				start = hal_time_us();
+				started = true;
+			}
+			if (start_conversion(ctx, addr, s->strong_pullup, s->duration))
+				return 1;
+		}
+		else if (s->type == PICO_1WIRE_STEP_READ) {
+			/* Make sure sensor has had enough time to complete conversion */
+			uint64_t elapsed = (hal_time_us() - start) / 1000;
+			if (elapsed < s->duration)
+				hal_sleep_ms(s->duration - elapsed);
+
+			int res = pico_1wire_get_temperature(ctx, addr, &temperatures[s->index]);
+			if (results)
+				results[s->index] = res;
+			if (res)
+				ret = 2;
+		}
+	}
+
+	return ret;
+}
+
+
+int pico_1wire_set_adaptive_resolution(pico_1wire_t *ctx, const pico_1wire_adaptive_config_t *config)
+{
+	if (!ctx)
+		return -1;
+
+	if (!config) {
+		ctx->adaptive = false;
+		return 0;
+	}
+
+	if (config->min_resolution < 9 || config->min_resolution > 12
+		|| config->accuracy <= 0.0 || config->stable_delta < 0.0)
+		return -1;
+
+	ctx->adaptive_config = *config;
+	for (uint i = 0; i < ctx->device_count; i++)
+		ctx->devices[i].prev_valid = false;
+	ctx->adaptive = true;
+
+	return 0;
+}
+
+
+int pico_1wire_copy_scratch_pad(pico_1wire_t *ctx, uint64_t addr)
+{
+	bool pullup;
+
+	if (!ctx)
+		return -1;
+
+	pullup = needs_strong_pullup(ctx, addr);
+
+	if (match_rom(ctx, addr))
+		return 1;
+
+	/* Send Copy Scratchpad command.
+	   Phantom powered devices need strong pull-up while EEPROM is being written. */
+	write_byte_pullup(ctx, CMD_COPY_SCRATCHPAD, pullup);
+	hal_sleep_ms(COPY_SCRATCHPAD_TIME);
+	if (pullup)
+		pullup_off(ctx);
+
+	return 0;
+}
+
+
+int pico_1wire_set_alarm(pico_1wire_t *ctx, uint64_t addr, int8_t high, int8_t low, bool save)
+{
+	const pico_1wire_driver_t *drv;
+	uint8_t scratch[9];
+
+	if (!ctx || !addr || low > high)
+		return -1;
+
+	if (pico_1wire_read_scratch_pad(ctx, addr, scratch))
+		return 1;
+
+	/* MAX31850/MAX31851 have no alarm threshold registers (bytes 2-3 are cold-junction temperature). */
+	drv = find_device_driver(ctx, addr, scratch);
+	if (drv && drv->config_len == 0)
+		return 3;
+
+	scratch[2] = (uint8_t)high;
+	scratch[3] = (uint8_t)low;
+	if (write_scratch(ctx, addr, scratch, drv))
+		return 2;
+
+	if (save && pico_1wire_copy_scratch_pad(ctx, addr))
+		return 2;
+
+	return 0;
+}
+
+
+int pico_1wire_set_alarms(pico_1wire_t *ctx, const uint64_t *addr_list, const int8_t *high,
+			const int8_t *low, uint count, uint save)
+{
+	int res;
+
+	if (!ctx || !addr_list || !high || !low || count < 1 || save > PICO_1WIRE_SAVE_ALL)
+		return -1;
+
+	for (uint i = 0; i < count; i++) {
+		if ((res = pico_1wire_set_alarm(ctx, addr_list[i], high[i], low[i],
+							save == PICO_1WIRE_SAVE_DEVICES)))
+			return res;
+	}
+
+	/* Copy scratchpad of all devices in the bus to EEPROM at once (only when explicitly requested). */
+	if (save == PICO_1WIRE_SAVE_ALL && pico_1wire_copy_scratch_pad(ctx, 0))
+		return 2;
+
+	return 0;
+}
+
+
+int pico_1wire_alarm_search(pico_1wire_t *ctx, uint64_t *addr_list, uint addr_list_size, uint *devices_found)
+{
+	return search_devices(ctx, CMD_ALARM_SEARCH, addr_list, addr_list_size, devices_found, false);
+}
+
+
+int pico_1wire_alarm_cycle(pico_1wire_t *ctx, uint64_t *addr_list, uint addr_list_size, uint *devices_found)
+{
+	if (!ctx || !addr_list || !devices_found || addr_list_size < 1)
+		return -1;
+
+	uint64_t coupler = 0;
+	uint group = 0;
+	uint base, start, n;
+	int res;
+
+	/* Single broadcast conversion, followed by search for devices with alarm condition. */
+	if (pico_1wire_convert_temperature(ctx, 0, true))
+		return 1;
+
+	if (!next_branch_group(ctx, &coupler, &group))
+		return pico_1wire_alarm_search(ctx, addr_list, addr_list_size, devices_found);
+
+	/* Search main trunk (all branches off), then each coupler branch. */
+	if (pico_1wire_branch_off(ctx))
+		return 1;
+	if ((res = search_devices(ctx, CMD_ALARM_SEARCH, addr_list, addr_list_size, devices_found, false)))
+		return res;
+	base = *devices_found;
+
+	do {
+		if ((res = pico_1wire_branch_on(ctx, coupler, group - 1))) {
+			if (res == 2)
+				continue; /* Empty branch */
+			return res;
+		}
+		if ((start = *devices_found) >= addr_list_size)
+			return 2;
+		res = search_devices(ctx, CMD_ALARM_SEARCH, &addr_list[start],
+				addr_list_size - start, &n, false);
+		if (res && res != 2)
+			return res;
+
+		/* Main trunk devices are visible on every branch, keep only devices behind the branch. */
+		for (uint i = 0; i < n; i++) {
+			uint64_t addr = addr_list[start + i];
+			bool on_trunk = false;
+			for (uint j = 0; j < base && !on_trunk; j++)
+				on_trunk = (addr_list[j] == addr);
+			if (!on_trunk)
+				addr_list[(*devices_found)++] = addr;
+		}
+		memset(&addr_list[*devices_found], 0, (addr_list_size - *devices_found) * sizeof(uint64_t));
+		if (res)
+			return res;
+	} while (next_branch_group(ctx, &coupler, &group));
+
+	return 0;
+}
+
+
+int pico_1wire_get_stats(pico_1wire_t *ctx, pico_1wire_stats_t *stats)
+{
+	if (!ctx || !stats)
+		return -1;
+
+#if PICO_1WIRE_STATS
+	*stats = ctx->stats;
+	return 0;
+#else
+	memset(stats, 0, sizeof(pico_1wire_stats_t));
+	return 1;
+#endif
+}
+
+
+void pico_1wire_reset_stats(pico_1wire_t *ctx)
+{
+#if PICO_1WIRE_STATS
+	if (ctx)
+		memset(&ctx->stats, 0, sizeof(pico_1wire_stats_t));
+#endif
+}
+
+
+int pico_1wire_select(pico_1wire_t *ctx, uint mode, uint64_t addr)
+{
+	if (!ctx || mode > PICO_1WIRE_SELECT_RESUME)
+		return -1;
+
+	switch (mode) {
+	case PICO_1WIRE_SELECT_SKIP:
+		return match_rom(ctx, 0);
+
+	case PICO_1WIRE_SELECT_RESUME:
+		if (addr && addr == ctx->resume_addr) {
+			if (!pico_1wire_reset_bus(ctx))
+				return 1;
+			/* Send Resume command */
+			write_byte(ctx, CMD_RESUME);
+			return 0;
+		}
+		/* Device not selected previously, fall back to Match ROM */
+		/* fall through */
+
+	default:
+		if (!addr)
+			return -1;
+		return match_rom(ctx, addr);
+	}
+}
+
+
+int pico_1wire_write_block(pico_1wire_t *ctx, const uint8_t *buf, uint len, uint pullup)
+{
+	if (!ctx || (!buf && len > 0))
+		return -1;
+
+	for (uint i = 0; i < len; i++)
+		write_byte_pullup(ctx, buf[i], (pullup && i == len - 1));
+
+	if (pullup && len > 0) {
+		/* Strong pull-up was turned on right after last bit (for EEPROM writes, conversions, etc.) */
+		hal_sleep_ms(pullup);
+		pullup_off(ctx);
+	}
+
+	return 0;
+}
+
+
+int pico_1wire_read_block(pico_1wire_t *ctx, uint8_t *buf, uint len)
+{
+	if (!ctx || (!buf && len > 0))
+		return -1;
+
+	for (uint i = 0; i < len; i++)
+		buf[i] = read_byte(ctx);
+
+	return 0;
+}
+
+
+uint8_t pico_1wire_crc8(uint8_t crc, const uint8_t *buf, uint len)
+{
+	if (!buf)
+		return crc;
+
+	for (uint i = 0; i < len; i++)
+		crc = crc8(crc, buf[i]);
+
+	return crc;
+}
+
+
+uint16_t pico_1wire_crc16(uint16_t crc, const uint8_t *buf, uint len)
+{
+	if (!buf)
+		return crc;
+
+	for (uint i = 0; i < len; i++)
+		crc = crc16(crc, buf[i]);
+
+	return crc;
+}
+
+
+int pico_1wire_run_transaction(pico_1wire_t *ctx, const pico_1wire_op_t *ops, uint count, uint64_t addr,
+			uint *completed)
+{
+	uint i;
+	int res = 0;
+	bool pullup;
+
+	if (completed)
+		*completed = 0;
+	if (!ctx || !ops)
+		return -1;
+
+	/* Validate all operations before touching the bus */
+	for (i = 0; i < count; i++) {
+		const pico_1wire_op_t *op = &ops[i];
+
+		switch (op->type) {
+		case PICO_1WIRE_OP_RESET:
+		case PICO_1WIRE_OP_DELAY:
+		case PICO_1WIRE_OP_PULLUP:
+			break;
+		case PICO_1WIRE_OP_SELECT:
+			if (op->mode > PICO_1WIRE_SELECT_RESUME)
+				return -1;
+			if (op->mode != PICO_1WIRE_SELECT_SKIP && !op->addr && !addr)
+				return -1;
+			break;
+		case PICO_1WIRE_OP_WRITE:
+			if (!op->tx && op->len > 0)
+				return -1;
+			break;
+		case PICO_1WIRE_OP_READ:
+			if (!op->rx && op->len > 0)
+				return -1;
+			break;
+		default:
+			return -1;
+		}
+	}
+
+	for (i = 0; i < count && !res; i++) {
+		const pico_1wire_op_t *op = &ops[i];
+
+		switch (op->type) {
+		case PICO_1WIRE_OP_RESET:
+			if (!pico_1wire_reset_bus(ctx))
+				res = 1;
+			break;
+		case PICO_1WIRE_OP_SELECT:
+			if (pico_1wire_select(ctx, op->mode, (op->addr ? op->addr : addr)))
+				res = 1;
+			break;
+		case PICO_1WIRE_OP_WRITE:
+			pullup = (i + 1 < count && ops[i + 1].type == PICO_1WIRE_OP_PULLUP);
+			for (uint j = 0; j < op->len; j++)
+				write_byte_pullup(ctx, op->tx[j], (pullup && j + 1 == op->len));
+			break;
+		case PICO_1WIRE_OP_READ:
+			for (uint j = 0; j < op->len; j++)
+				op->rx[j] = read_byte(ctx);
+			break;
+		case PICO_1WIRE_OP_DELAY:
+			hal_sleep_ms(op->len);
+			break;
+		case PICO_1WIRE_OP_PULLUP:
+			power_mosfet_on(ctx);
+			hal_sleep_ms(op->len);
+			pullup_off(ctx);
+			break;
+		}
+		if (!res && completed)
+			*completed = i + 1;
+	}
+
+	return res;
+}
+
+
+int pico_1wire_register_driver(const pico_1wire_driver_t *driver)
+{
+	if (!driver)
+		return -1;
+
+	init_drivers();
+
+	return add_driver(driver);
+}
+
+
+const pico_1wire_driver_t* pico_1wire_get_driver(uint64_t addr)
+{
+	init_drivers();
+
+	return find_driver(addr);
+}
+
+
+const pico_1wire_driver_t* pico_1wire_get_device_driver(pico_1wire_t *ctx, uint64_t addr)
+{
+	if (!ctx || !addr)
+		return NULL;
+
+	return find_device_driver(ctx, addr, NULL);
+}
+
+
+int pico_1wire_set_irq_policy(pico_1wire_t *ctx, uint policy)
+{
+	if (!ctx || policy > PICO_1WIRE_IRQ_SLOT)
+		return -1;
+
+	ctx->irq_policy = policy;
+	return 0;
+}
+
+
+int pico_1wire_trace_read(pico_1wire_t *ctx, pico_1wire_trace_t *buf, uint size, uint *count)
+{
+	if (!ctx || !buf || !count)
+		return -1;
+
+	*count = 0;
+#if PICO_1WIRE_TRACE_SIZE > 0
+	uint n = (ctx->trace_count < PICO_1WIRE_TRACE_SIZE ? ctx->trace_count : PICO_1WIRE_TRACE_SIZE);
+	uint pos = (ctx->trace_pos + PICO_1WIRE_TRACE_SIZE - n) % PICO_1WIRE_TRACE_SIZE;
+
+	if (n > size) {
+		/* Skip oldest records that do not fit in the buffer */
+		pos = (pos + n - size) % PICO_1WIRE_TRACE_SIZE;
+		n = size;
+	}
+	for (uint i = 0; i < n; i++) {
+		buf[i] = ctx->trace[pos];
+		if (++pos >= PICO_1WIRE_TRACE_SIZE)
+			pos = 0;
+	}
+	*count = n;
+	return 0;
+#else
+	(void)size;
+	return 1;
+#endif
+}
+
+
+int pico_1wire_trace_dump(pico_1wire_t *ctx)
+{
+	if (!ctx)
+		return -1;
+
+#if PICO_1WIRE_TRACE_SIZE > 0
+	static const char type_chars[] = { 'R', 'W', 'r' };
+	uint n = (ctx->trace_count < PICO_1WIRE_TRACE_SIZE ? ctx->trace_count : PICO_1WIRE_TRACE_SIZE);
+	uint pos = (ctx->trace_pos + PICO_1WIRE_TRACE_SIZE - n) % PICO_1WIRE_TRACE_SIZE;
+
+	printf("# pico-1wire trace: pin=%u records=%u lost=%lu\n", ctx->data_pin, n,
+		(unsigned long)(ctx->trace_count - n));
+	for (uint i = 0; i < n; i++) {
+		pico_1wire_trace_t *t = &ctx->trace[pos];
+		printf("%lu %c %u %u\n", (unsigned long)t->timestamp,
+			(t->type < sizeof(type_chars) ? type_chars[t->type] : '?'),
+			t->driven, t->sampled);
+		if (++pos >= PICO_1WIRE_TRACE_SIZE)
+			pos = 0;
+	}
+	return 0;
+#else
+	return 1;
+#endif
+}
+
+
+void pico_1wire_trace_clear(pico_1wire_t *ctx)
+{
+#if PICO_1WIRE_TRACE_SIZE > 0
+	if (ctx) {
+		ctx->trace_pos = 0;
+		ctx->trace_count = 0;
+	}
+#else
+	(void)ctx;
+#endif
+}
@@ -0,0 +1,59 @@
+/* pico_1wire_drivers.h
+
+   Copyright (C) 2024 Timo Kokkonen <tjko@iki.fi>
+
+   SPDX-License-Identifier: GPL-3.0-or-later
+
+   This file is part of pico-1wire Library.
+
+   pico-1wire Library is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   pico-1wire Library is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with pico-1wire Library. If not, see <https://www.gnu.org/licenses/>.
+*/
+
+/* Built-in device family drivers (registered automatically). */
+
+#ifndef PICO_1WIRE_DRIVERS_H
+#define PICO_1WIRE_DRIVERS_H 1
+
+#include "pico_1wire.h"
+
+/* 1-Wire Device Family Codes */
+#define FAMILY_CODE_DS18S20      0x10  /* Temperature (9bit) */
+#define FAMILY_CODE_DS1822       0x22  /* Temperature (9-12bit) */
+#define FAMILY_CODE_DS18B20      0x28  /* Temperature (9-12bit) */
+#define FAMILY_CODE_MAX31820     0x28  /* Temperature (9-12bit) */
+#define FAMILY_CODE_DS1825       0x3B  /* Temperature (9-12bit) */
+#define FAMILY_CODE_MAX31826     0x3B  /* Temperature (12bit) + 1k EEPROM */
+#define FAMILY_CODE_MAX31850     0x3B  /* Thermocouple (14bit) */
+#define FAMILY_CODE_DS28EA00     0x42  /* Temperature (9-12bit) + IO */
+#define FAMILY_CODE_DS2431       0x2D  /* 1024-bit EEPROM */
+#define FAMILY_CODE_DS28EC20     0x43  /* 20480-bit EEPROM */
+#define FAMILY_CODE_DS2408       0x29  /* 8-channel addressable switch */
+#define FAMILY_CODE_DS2413       0x3A  /* 2-channel addressable switch */
+#define FAMILY_CODE_DS2438       0x26  /* Battery monitor */
+#define FAMILY_CODE_DS2409       0x1F  /* MicroLAN coupler */
+
+extern const pico_1wire_driver_t pico_1wire_driver_ds18s20;
+extern const pico_1wire_driver_t pico_1wire_driver_ds1822;
+extern const pico_1wire_driver_t pico_1wire_driver_ds18b20;
+extern const pico_1wire_driver_t pico_1wire_driver_ds1825;
+extern const pico_1wire_driver_t pico_1wire_driver_ds28ea00;
+extern const pico_1wire_driver_t pico_1wire_driver_max31850;
+
+
+/* Return driver for a device (library internal, not part of the API). Devices sharing family code
+   are identified using scratchpad contents (read if scratch is NULL), identified driver is cached
+   in the device registry. */
+const pico_1wire_driver_t* find_device_driver(pico_1wire_t *ctx, uint64_t addr, const uint8_t *scratch);
+
+#endif /* PICO_1WIRE_DRIVERS_H */
@@ -0,0 +1,144 @@
+/* pico_1wire_ds18x20.c
+
+   Copyright (C) 2024 Timo Kokkonen <tjko@iki.fi>
+
+   SPDX-License-Identifier: GPL-3.0-or-later
+
+   This file is part of pico-1wire Library.
+
+   pico-1wire Library is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   pico-1wire Library is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with pico-1wire Library. If not, see <https://www.gnu.org/licenses/>.
+*/
+
+/* Drivers for DS18S20 and DS18B20 compatible (DS1822, DS1825, DS28EA00) temperature sensors. */
+
+#include "pico_1wire_drivers.h"
+
+
+#define MAX_TEMP_CONVERSION_TIME 750    /* 750ms */
+
+
+static inline int scratch_temp(const uint8_t *scratch)
+{
+	int temp_read = (scratch[1] << 8) | scratch[0];
+
+	if (temp_read & 0x8000)
+		temp_read = - ((temp_read ^ 0xffff) + 1);
+
+	return temp_read;
+}
+
+
+/* DS18B20 (and compatible) with configurable resolution (9-12bit) */
+
+static int ds18b20_decode(const uint8_t *scratch, float *temperature)
+{
+	*temperature = (float)scratch_temp(scratch) / 16.0;
+	return 0;
+}
+
+
+static uint ds18b20_get_resolution(const uint8_t *scratch)
+{
+	return ((scratch[4] & 0x7f) >> 5) + 9;
+}
+
+
+static int ds18b20_set_resolution(uint8_t *scratch, uint resolution)
+{
+	if (resolution < 9 || resolution > 12)
+		return -1;
+
+	scratch[4] = (scratch[4] & 0x9f) | ((resolution - 9) << 5);
+	return 0;
+}
+
+
+static uint ds18b20_conversion_time(uint resolution)
+{
+	if (resolution == 9)
+		return 95;
+	else if (resolution == 10)
+		return 190;
+	else if (resolution == 11)
+		return 375;
+
+	return MAX_TEMP_CONVERSION_TIME;
+}
+
+
+/* MAX31850/MAX31851 share family code with DS1825/MAX31826, configuration
+   register (byte 4) bit 7 is always 1 on MAX31850 and always 0 on DS1825.
+   MAX31826 has no such difference to MAX31850 (bit 7 is also set), so it is
+   identified as MAX31850. */
+static const pico_1wire_driver_t* ds1825_identify(const uint8_t *scratch)
+{
+	if (scratch[4] & 0x80)
+		return &pico_1wire_driver_max31850;
+
+	return NULL;
+}
+
+
+#define DS18B20_DRIVER(var, family_code, device_name, identify_func)	\
+	const pico_1wire_driver_t var = {			\
+		.family = family_code,				\
+		.name = device_name,				\
+		.config_len = 3,				\
+		.decode = ds18b20_decode,			\
+		.get_resolution = ds18b20_get_resolution,	\
+		.set_resolution = ds18b20_set_resolution,	\
+		.conversion_time = ds18b20_conversion_time,	\
+		.identify = identify_func,			\
+	}
+
+DS18B20_DRIVER(pico_1wire_driver_ds1822, FAMILY_CODE_DS1822, "DS1822", NULL);
+DS18B20_DRIVER(pico_1wire_driver_ds18b20, FAMILY_CODE_DS18B20, "DS18B20", NULL);
+DS18B20_DRIVER(pico_1wire_driver_ds1825, FAMILY_CODE_DS1825, "DS1825", ds1825_identify);
+DS18B20_DRIVER(pico_1wire_driver_ds28ea00, FAMILY_CODE_DS28EA00, "DS28EA00", NULL);
+
+
+/* DS18S20 (9bit, extended resolution using COUNT_REMAIN register) */
+
+static int ds18s20_decode(const uint8_t *scratch, float *temperature)
+{
+	int temp_read = scratch_temp(scratch);
+	int count_remain = scratch[6];
+	int count_per_degree = scratch[7];
+
+	if (count_per_degree == 0) {
+		*temperature = temp_read / 2.0;
+		return 2;
+	}
+
+	*temperature = (temp_read / 2) - 0.25 + (count_per_degree - count_remain) / (float)count_per_degree;
+	return 0;
+}
+
+
+static uint ds18s20_conversion_time(uint resolution)
+{
+	(void)resolution;
+
+	return MAX_TEMP_CONVERSION_TIME;
+}
+
+
+const pico_1wire_driver_t pico_1wire_driver_ds18s20 = {
+	.family = FAMILY_CODE_DS18S20,
+	.name = "DS18S20",
+	.resolution = 9,
+	.config_len = 2,
+	.decode = ds18s20_decode,
+	.conversion_time = ds18s20_conversion_time,
+};
@@ -0,0 +1,270 @@
+/* pico_1wire_ds2438.c
+
+   Copyright (C) 2024 Timo Kokkonen <tjko@iki.fi>
+
+   SPDX-License-Identifier: GPL-3.0-or-later
+
+   This file is part of pico-1wire Library.
+
+   pico-1wire Library is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   pico-1wire Library is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with pico-1wire Library. If not, see <https://www.gnu.org/licenses/>.
+*/
+
+
+/* Driver for DS2438 smart battery monitor. */
+
+#include <string.h>
+
+#include "pico_1wire_hal.h"
+#include "pico_1wire_drivers.h"
+#include "pico_1wire_ds2438.h"
+
+
+/* Function Commands */
+#define CMD_CONVERT_T          0x44
+#define CMD_CONVERT_V          0xB4
+#define CMD_WRITE_SCRATCHPAD   0x4E
+#define CMD_READ_SCRATCHPAD    0xBE
+#define CMD_COPY_SCRATCHPAD    0x48
+#define CMD_RECALL             0xB8
+
+#define CONVERSION_TIME        10000   /* 10ms (temperature and voltage) */
+#define COPY_TIME              10      /* 10ms */
+#define PAGE_SIZE              8
+#define PIPELINE_DEPTH         16      /* devices in flight */
+
+
+static int send_command(pico_1wire_t *ctx, uint mode, uint64_t addr, uint8_t cmd)
+{
+	if (pico_1wire_select(ctx, mode, addr))
+		return 1;
+
+	return pico_1wire_write_block(ctx, &cmd, 1, 0);
+}
+
+
+static void wait_until(uint64_t t)
+{
+	uint64_t now = hal_time_us();
+
+	if (now < t)
+		hal_sleep_us(t - now);
+}
+
+
+static int read_scratch_page(pico_1wire_t *ctx, uint64_t addr, uint page, uint8_t *buf)
+{
+	uint8_t cmd[2];
+	uint8_t data[PAGE_SIZE + 1];
+
+	cmd[0] = CMD_READ_SCRATCHPAD;
+	cmd[1] = page;
+	if (pico_1wire_select(ctx, PICO_1WIRE_SELECT_MATCH, addr))
+		return 1;
+	pico_1wire_write_block(ctx, cmd, 2, 0);
+	pico_1wire_read_block(ctx, data, sizeof(data));
+	if (pico_1wire_crc8(0, data, sizeof(data)))
+		return 2;
+
+	memcpy(buf, data, PAGE_SIZE);
+	return 0;
+}
+
+
+static int read_page(pico_1wire_t *ctx, uint64_t addr, uint page, uint8_t *buf)
+{
+	uint8_t cmd[2];
+
+	/* Recall Memory copies page to scratchpad, then Read Scratchpad (after reset).
+	   DS2438 does not support Resume, so device is selected using Match ROM both times. */
+	cmd[0] = CMD_RECALL;
+	cmd[1] = page;
+	if (pico_1wire_select(ctx, PICO_1WIRE_SELECT_MATCH, addr))
+		return 1;
+	pico_1wire_write_block(ctx, cmd, 2, 0);
+
+	return read_scratch_page(ctx, addr, page, buf);
+}
+
+
+static void decode_results(const uint8_t *page, pico_1wire_ds2438_t *result)
+{
+	result->status = page[0];
+	result->temperature = (int16_t)((page[2] << 8) | page[1]);
+	result->voltage = (((page[4] << 8) | page[3]) & 0x3ff) * 10;
+	result->current = (int16_t)((page[6] << 8) | page[5]);
+	result->ica = 0;
+}
+
+
+static int read_results(pico_1wire_t *ctx, uint64_t addr, pico_1wire_ds2438_t *result, bool ica)
+{
+	uint8_t page[PAGE_SIZE];
+	int res;
+
+	if ((res = read_page(ctx, addr, 0, page)))
+		return res;
+	decode_results(page, result);
+
+	if (ica) {
+		if ((res = read_page(ctx, addr, 1, page)))
+			return res;
+		result->ica = page[4];
+	}
+
+	return 0;
+}
+
+
+/* Check if commands can be broadcast (Skip ROM): device registry is complete, contains only
+   DS2438 devices (no couplers), and all devices in the list are in the registry. */
+static bool can_broadcast(pico_1wire_t *ctx, const uint64_t *addr_list, uint count)
+{
+	if (!ctx->registry_complete || ctx->device_count < 1)
+		return false;
+
+	for (uint i = 0; i < ctx->device_count; i++) {
+		if ((ctx->devices[i].addr >> 56) != FAMILY_CODE_DS2438)
+			return false;
+	}
+
+	for (uint i = 0; i < count; i++) {
+		uint j;
+		for (j = 0; j < ctx->device_count; j++) {
+			if (ctx->devices[j].addr == addr_list[i])
+				break;
+		}
+		if (j == ctx->device_count)
+			return false;
+	}
+
+	return true;
+}
+
+
+/* Broadcast conversions and Recall Memory, then select each device once per page to read results. */
+static int acquire_broadcast(pico_1wire_t *ctx, const uint64_t *addr_list, uint count,
+			pico_1wire_ds2438_t *results, bool ica)
+{
+	uint8_t cmd[2];
+	uint8_t page[PAGE_SIZE];
+	int res;
+
+	if (send_command(ctx, PICO_1WIRE_SELECT_SKIP, 0, CMD_CONVERT_T))
+		return 1;
+	hal_sleep_us(CONVERSION_TIME);
+	if (send_command(ctx, PICO_1WIRE_SELECT_SKIP, 0, CMD_CONVERT_V))
+		return 1;
+	hal_sleep_us(CONVERSION_TIME);
+
+	for (uint p = 0; p < (ica ? 2 : 1); p++) {
+		cmd[0] = CMD_RECALL;
+		cmd[1] = p;
+		if (pico_1wire_select(ctx, PICO_1WIRE_SELECT_SKIP, 0))
+			return 1;
+		pico_1wire_write_block(ctx, cmd, 2, 0);
+	}
+
+	for (uint i = 0; i < count; i++) {
+		if ((res = read_scratch_page(ctx, addr_list[i], 0, page)))
+			return res;
+		decode_results(page, &results[i]);
+		if (ica) {
+			if ((res = read_scratch_page(ctx, addr_list[i], 1, page)))
+				return res;
+			results[i].ica = page[4];
+		}
+	}
+
+	return 0;
+}
+
+
+int pico_1wire_ds2438_acquire(pico_1wire_t *ctx, const uint64_t *addr_list, uint count,
+			pico_1wire_ds2438_t *results, bool ica)
+{
+	uint64_t t_ready[PIPELINE_DEPTH];
+	uint64_t v_ready[PIPELINE_DEPTH];
+	int res;
+
+	if (!ctx || !addr_list || !results)
+		return -1;
+
+	if (count > 0 && can_broadcast(ctx, addr_list, count))
+		return acquire_broadcast(ctx, addr_list, count, results, ica);
+
+	/* Otherwise each device is addressed using Match ROM, conversions on one device
+	   overlap with bus traffic to the others. */
+	for (uint base = 0; base < count; base += PIPELINE_DEPTH) {
+		uint n = (count - base < PIPELINE_DEPTH ? count - base : PIPELINE_DEPTH);
+		const uint64_t *addr = &addr_list[base];
+
+		/* Start temperature conversions */
+		for (uint i = 0; i < n; i++) {
+			if (send_command(ctx, PICO_1WIRE_SELECT_MATCH, addr[i], CMD_CONVERT_T))
+				return 1;
+			t_ready[i] = hal_time_us() + CONVERSION_TIME;
+		}
+
+		/* Start voltage conversions, as each temperature conversion completes */
+		for (uint i = 0; i < n; i++) {
+			wait_until(t_ready[i]);
+			if (send_command(ctx, PICO_1WIRE_SELECT_MATCH, addr[i], CMD_CONVERT_V))
+				return 1;
+			v_ready[i] = hal_time_us() + CONVERSION_TIME;
+		}
+
+		/* Read results */
+		for (uint i = 0; i < n; i++) {
+			wait_until(v_ready[i]);
+			if ((res = read_results(ctx, addr[i], &results[base + i], ica)))
+				return res;
+		}
+	}
+
+	return 0;
+}
+
+
+int pico_1wire_ds2438_read_page(pico_1wire_t *ctx, uint64_t addr, uint page, uint8_t *buf)
+{
+	if (!ctx || !addr || page > 7 || !buf)
+		return -1;
+
+	return read_page(ctx, addr, page, buf);
+}
+
+
+int pico_1wire_ds2438_set_config(pico_1wire_t *ctx, uint64_t addr, uint8_t config)
+{
+	uint8_t cmd[3];
+
+	if (!ctx || !addr)
+		return -1;
+
+	/* Write Status/Configuration register (page 0, byte 0) to scratchpad and copy to memory */
+	cmd[0] = CMD_WRITE_SCRATCHPAD;
+	cmd[1] = 0;
+	cmd[2] = config;
+	if (pico_1wire_select(ctx, PICO_1WIRE_SELECT_MATCH, addr))
+		return 1;
+	pico_1wire_write_block(ctx, cmd, 3, 0);
+
+	cmd[0] = CMD_COPY_SCRATCHPAD;
+	if (pico_1wire_select(ctx, PICO_1WIRE_SELECT_MATCH, addr))
+		return 1;
+	pico_1wire_write_block(ctx, cmd, 2, 0);
+	hal_sleep_ms(COPY_TIME);
+
+	return 0;
+}
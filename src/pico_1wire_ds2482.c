@@ -0,0 +1,214 @@
+/* pico_1wire_ds2482.c
+
+   Copyright (C) 2024 Timo Kokkonen <tjko@iki.fi>
+
+   SPDX-License-Identifier: GPL-3.0-or-later
+
+   This file is part of pico-1wire Library.
+
+   pico-1wire Library is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   pico-1wire Library is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with pico-1wire Library. If not, see <https://www.gnu.org/licenses/>.
+*/
+
+
+/* DS2482-100/-800 I2C-to-1-Wire bridge backend.
+ *
+ * Each 1-Wire operation is a DS2482 command, after which status register
+ * is polled over I2C until 1-Wire Busy (1WB) clears.
+ */
+
+#include "pico_1wire_hal.h"
+#include "pico_1wire_ds2482.h"
+
+
+/* DS2482 Commands */
+#define CMD_DEVICE_RESET       0xF0
+#define CMD_SET_READ_POINTER   0xE1
+#define CMD_WRITE_CONFIG       0xD2
+#define CMD_CHANNEL_SELECT     0xC3    /* DS2482-800 only */
+#define CMD_1WIRE_RESET        0xB4
+#define CMD_1WIRE_SINGLE_BIT   0x87
+#define CMD_1WIRE_WRITE_BYTE   0xA5
+#define CMD_1WIRE_READ_BYTE    0x96
+#define CMD_1WIRE_TRIPLET      0x78
+
+/* Read Pointer Codes */
+#define REG_DATA               0xE1
+
+/* Status Register */
+#define STATUS_1WB             0x01    /* 1-Wire busy */
+#define STATUS_PPD             0x02    /* Presence pulse detected */
+#define STATUS_SD              0x04    /* Short detected */
+#define STATUS_RST             0x10    /* Device reset */
+#define STATUS_SBR             0x20    /* Single bit result */
+#define STATUS_TSB             0x40    /* Triplet second bit */
+#define STATUS_DIR             0x80    /* Branch direction taken */
+
+/* Device Configuration Register */
+#define CONFIG_APU             0x01    /* Active pull-up */
+#define CONFIG_SPU             0x04    /* Strong pull-up */
+
+#define BUSY_POLL_MAX          200     /* Status reads before giving up (reset takes ~1.2ms) */
+
+
+/* Channel Select codes and the values read back when channel is selected. */
+static const uint8_t channel_code[8] = { 0xF0, 0xE1, 0xD2, 0xC3, 0xB4, 0xA5, 0x96, 0x87 };
+static const uint8_t channel_readback[8] = { 0xB8, 0xB1, 0xAA, 0xA3, 0x9C, 0x95, 0x8E, 0x87 };
+
+
+static bool command(pico_1wire_t *ctx, uint8_t cmd, int param)
+{
+	uint8_t buf[2] = { cmd, (uint8_t)param };
+	int len = (param < 0 ? 1 : 2);
+
+	return (hal_i2c_write(ctx->i2c_bus, ctx->i2c_addr, buf, len) == len);
+}
+
+
+static int read_register(pico_1wire_t *ctx)
+{
+	uint8_t val;
+
+	if (hal_i2c_read(ctx->i2c_bus, ctx->i2c_addr, &val, 1) != 1)
+		return -1;
+
+	return val;
+}
+
+
+static int onewire_command(pico_1wire_t *ctx, uint8_t cmd, int param)
+{
+	int status = -1;
+
+	if (!command(ctx, cmd, param))
+		return -1;
+
+	/* Read pointer is now at status register, poll until 1-Wire command completes. */
+	for (int i = 0; i < BUSY_POLL_MAX; i++) {
+		if ((status = read_register(ctx)) < 0 || !(status & STATUS_1WB))
+			return status;
+	}
+
+	return -1;
+}
+
+
+static bool write_config(pico_1wire_t *ctx, uint8_t config)
+{
+	/* Upper nibble must be one's complement of the configuration bits. */
+	if (!command(ctx, CMD_WRITE_CONFIG, (config | (~config << 4)) & 0xff))
+		return false;
+
+	return (read_register(ctx) == config);
+}
+
+
+static bool select_channel(pico_1wire_t *ctx)
+{
+	if (!command(ctx, CMD_CHANNEL_SELECT, channel_code[ctx->channel]))
+		return false;
+
+	return (read_register(ctx) == channel_readback[ctx->channel]);
+}
+
+
+bool ds2482_init(pico_1wire_t *ctx)
+{
+	int status;
+
+	if (ctx->channel > 7)
+		return false;
+
+	/* Device Reset also terminates any 1-Wire communication in progress. */
+	if (!command(ctx, CMD_DEVICE_RESET, -1))
+		return false;
+	if ((status = read_register(ctx)) < 0 || !(status & STATUS_RST))
+		return false;
+
+	if (!write_config(ctx, CONFIG_APU))
+		return false;
+
+	return (ctx->channel < 0 || select_channel(ctx));
+}
+
+
+int ds2482_reset(pico_1wire_t *ctx)
+{
+	int status;
+
+	if (ctx->channel >= 0 && !select_channel(ctx))
+		return PICO_1WIRE_RESET_NO_PRESENCE;
+
+	if ((status = onewire_command(ctx, CMD_1WIRE_RESET, -1)) < 0)
+		return PICO_1WIRE_RESET_NO_PRESENCE;
+	if (status & STATUS_SD)
+		return PICO_1WIRE_RESET_SHORT;
+	if (!(status & STATUS_PPD))
+		return PICO_1WIRE_RESET_NO_PRESENCE;
+
+	return PICO_1WIRE_RESET_OK;
+}
+
+
+bool ds2482_bit(pico_1wire_t *ctx, bool bit)
+{
+	int status = onewire_command(ctx, CMD_1WIRE_SINGLE_BIT, (bit ? 0x80 : 0x00));
+
+	/* Idle bus reads as 1 */
+	return (status < 0 || (status & STATUS_SBR));
+}
+
+
+void ds2482_write_byte(pico_1wire_t *ctx, uint8_t data)
+{
+	onewire_command(ctx, CMD_1WIRE_WRITE_BYTE, data);
+}
+
+
+uint8_t ds2482_read_byte(pico_1wire_t *ctx)
+{
+	int val;
+
+	if (onewire_command(ctx, CMD_1WIRE_READ_BYTE, -1) < 0)
+		return 0xff;
+	if (!command(ctx, CMD_SET_READ_POINTER, REG_DATA))
+		return 0xff;
+	if ((val = read_register(ctx)) < 0)
+		return 0xff;
+
+	return val;
+}
+
+
+bool ds2482_triplet(pico_1wire_t *ctx, bool dir, bool *id_bit, bool *cmp_bit)
+{
+	int status = onewire_command(ctx, CMD_1WIRE_TRIPLET, (dir ? 0x80 : 0x00));
+
+	if (status < 0) {
+		*id_bit = *cmp_bit = true;
+		return dir;
+	}
+
+	*id_bit = (status & STATUS_SBR);
+	*cmp_bit = (status & STATUS_TSB);
+
+	return (status & STATUS_DIR);
+}
+
+
+void ds2482_pullup(pico_1wire_t *ctx, bool enable)
+{
+	/* Strong pull-up (SPU) becomes active after next 1-Wire Write Byte (or Single Bit)
+	   command and lasts until next 1-Wire command or until SPU is cleared. */
+	write_config(ctx, (enable ? CONFIG_APU | CONFIG_SPU : CONFIG_APU));
+}
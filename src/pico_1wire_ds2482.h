@@ -0,0 +1,62 @@
+/* pico_1wire_ds2482.h
+
+   Copyright (C) 2024 Timo Kokkonen <tjko@iki.fi>
+
+   SPDX-License-Identifier: GPL-3.0-or-later
+
+   This file is part of pico-1wire Library.
+
+   pico-1wire Library is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   pico-1wire Library is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with pico-1wire Library. If not, see <https://www.gnu.org/licenses/>.
+*/
+
+/* DS2482-100/-800 I2C-to-1-Wire bridge backend.
+ *
+ * Used by the core (pico_1wire.c) for bus contexts created with
+ * pico_1wire_init_ds2482(), in place of GPIO bit-banging.
+ */
+
+#ifndef PICO_1WIRE_DS2482_H
+#define PICO_1WIRE_DS2482_H 1
+
+#include "pico_1wire.h"
+
+#if PICO_1WIRE_DS2482
+
+bool ds2482_init(pico_1wire_t *ctx);
+int ds2482_reset(pico_1wire_t *ctx);
+bool ds2482_bit(pico_1wire_t *ctx, bool bit);
+void ds2482_write_byte(pico_1wire_t *ctx, uint8_t data);
+uint8_t ds2482_read_byte(pico_1wire_t *ctx);
+bool ds2482_triplet(pico_1wire_t *ctx, bool dir, bool *id_bit, bool *cmp_bit);
+void ds2482_pullup(pico_1wire_t *ctx, bool enable);
+
+#else /* PICO_1WIRE_DS2482 */
+
+/* Backend not built in: ds2482_init() fails, so no context ever has ctx->bridge set. */
+static inline bool ds2482_init(pico_1wire_t *ctx) { (void)ctx; return false; }
+static inline int ds2482_reset(pico_1wire_t *ctx) { (void)ctx; return PICO_1WIRE_RESET_NO_PRESENCE; }
+static inline bool ds2482_bit(pico_1wire_t *ctx, bool bit) { (void)ctx; return bit; }
+static inline void ds2482_write_byte(pico_1wire_t *ctx, uint8_t data) { (void)ctx; (void)data; }
+static inline uint8_t ds2482_read_byte(pico_1wire_t *ctx) { (void)ctx; return 0xff; }
+static inline bool ds2482_triplet(pico_1wire_t *ctx, bool dir, bool *id_bit, bool *cmp_bit)
+{
+	(void)ctx;
+	*id_bit = *cmp_bit = true;
+	return dir;
+}
+static inline void ds2482_pullup(pico_1wire_t *ctx, bool enable) { (void)ctx; (void)enable; }
+
+#endif /* PICO_1WIRE_DS2482 */
+
+#endif /* PICO_1WIRE_DS2482_H */
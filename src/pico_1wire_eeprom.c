@@ -0,0 +1,250 @@
+/* pico_1wire_eeprom.c
+
+   Copyright (C) 2024 Timo Kokkonen <tjko@iki.fi>
+
+   SPDX-License-Identifier: GPL-3.0-or-later
+
+   This file is part of pico-1wire Library.
+
+   pico-1wire Library is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   pico-1wire Library is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with pico-1wire Library. If not, see <https://www.gnu.org/licenses/>.
+*/
+
+
+/* Memory function support for DS2431 and DS28EC20 EEPROMs. */
+
+#include <string.h>
+
+#include "pico_1wire_drivers.h"
+#include "pico_1wire_eeprom.h"
+
+
+/* Memory Function Commands */
+#define CMD_WRITE_SCRATCHPAD   0x0F
+#define CMD_READ_SCRATCHPAD    0xAA
+#define CMD_COPY_SCRATCHPAD    0x55
+#define CMD_READ_MEMORY        0xF0
+
+#define PROGRAM_TIME           10      /* 10ms */
+#define COPY_SUCCESS           0xAA
+#define CRC16_RESIDUE          0xB001  /* CRC-16 over data and (inverted) CRC */
+#define ES_PF                  0x20    /* Partial (byte) Flag */
+#define MAX_ROW_SIZE           32
+
+#define NO_PAGE                0xffff
+
+
+static uint8_t* cache_find(pico_1wire_eeprom_t *eeprom, uint page)
+{
+	for (uint i = 0; i < PICO_1WIRE_EEPROM_CACHE_PAGES; i++) {
+		if (eeprom->page[i] == page)
+			return eeprom->cache[i];
+	}
+
+	return NULL;
+}
+
+
+static void cache_store(pico_1wire_eeprom_t *eeprom, uint page, const uint8_t *data)
+{
+	uint8_t *slot = cache_find(eeprom, page);
+
+	if (!slot) {
+		uint i = eeprom->next_slot;
+		eeprom->next_slot = (i + 1) % PICO_1WIRE_EEPROM_CACHE_PAGES;
+		eeprom->page[i] = page;
+		slot = eeprom->cache[i];
+	}
+	memcpy(slot, data, PICO_1WIRE_EEPROM_PAGE_SIZE);
+}
+
+
+/* Write one scratchpad row and copy it to memory. */
+static int write_row(pico_1wire_eeprom_t *eeprom, uint offset, const uint8_t *data)
+{
+	uint8_t buf[3 + MAX_ROW_SIZE + 2];
+	uint len = eeprom->row_size;
+	uint8_t es = len - 1;
+	uint8_t status;
+
+	/* Write Scratchpad: command, target address, data, device returns CRC-16 */
+	buf[0] = CMD_WRITE_SCRATCHPAD;
+	buf[1] = offset & 0xff;
+	buf[2] = offset >> 8;
+	memcpy(&buf[3], data, len);
+	if (pico_1wire_select(eeprom->ctx, PICO_1WIRE_SELECT_RESUME, eeprom->addr))
+		return 1;
+	pico_1wire_write_block(eeprom->ctx, buf, 3 + len, 0);
+	pico_1wire_read_block(eeprom->ctx, &buf[3 + len], 2);
+	if (pico_1wire_crc16(0, buf, 3 + len + 2) != CRC16_RESIDUE)
+		return 2;
+
+	/* Read Scratchpad: verify target address, E/S register and data */
+	buf[0] = CMD_READ_SCRATCHPAD;
+	if (pico_1wire_select(eeprom->ctx, PICO_1WIRE_SELECT_RESUME, eeprom->addr))
+		return 1;
+	pico_1wire_write_block(eeprom->ctx, buf, 1, 0);
+	pico_1wire_read_block(eeprom->ctx, &buf[1], 3 + len + 2);
+	if (pico_1wire_crc16(0, buf, 1 + 3 + len + 2) != CRC16_RESIDUE)
+		return 2;
+	if (buf[1] != (offset & 0xff) || buf[2] != (offset >> 8) || (buf[3] & (ES_PF | es)) != es
+		|| memcmp(&buf[4], data, len))
+		return 2;
+
+	/* Copy Scratchpad: authorization pattern, then strong pull-up during programming */
+	buf[0] = CMD_COPY_SCRATCHPAD;
+	buf[1] = offset & 0xff;
+	buf[2] = offset >> 8;
+	buf[3] = es;
+	if (pico_1wire_select(eeprom->ctx, PICO_1WIRE_SELECT_RESUME, eeprom->addr))
+		return 1;
+	pico_1wire_write_block(eeprom->ctx, buf, 4, PROGRAM_TIME);
+	pico_1wire_read_block(eeprom->ctx, &status, 1);
+	if (status != COPY_SUCCESS)
+		return 3;
+
+	return 0;
+}
+
+
+int pico_1wire_eeprom_init(pico_1wire_eeprom_t *eeprom, pico_1wire_t *ctx, uint64_t addr)
+{
+	if (!eeprom || !ctx || !addr)
+		return -1;
+
+	memset(eeprom, 0, sizeof(pico_1wire_eeprom_t));
+	eeprom->ctx = ctx;
+	eeprom->addr = addr;
+
+	switch (addr >> 56) {
+	case FAMILY_CODE_DS2431:
+		eeprom->size = 128;
+		eeprom->row_size = 8;
+		break;
+	case FAMILY_CODE_DS28EC20:
+		eeprom->size = 2560;
+		eeprom->row_size = 32;
+		break;
+	default:
+		return 2;
+	}
+
+	pico_1wire_eeprom_invalidate(eeprom);
+
+	return 0;
+}
+
+
+int pico_1wire_eeprom_read(pico_1wire_eeprom_t *eeprom, uint offset, uint8_t *buf, uint len)
+{
+	uint8_t page_buf[PICO_1WIRE_EEPROM_PAGE_SIZE];
+	uint8_t cmd[3];
+	uint first, last, page;
+	uint8_t *data;
+
+	if (!eeprom || !buf || offset >= eeprom->size || len > eeprom->size - offset)
+		return -1;
+	if (len == 0)
+		return 0;
+
+	first = offset / PICO_1WIRE_EEPROM_PAGE_SIZE;
+	last = (offset + len - 1) / PICO_1WIRE_EEPROM_PAGE_SIZE;
+
+	/* Copy leading pages found in the cache */
+	for (page = first; page <= last && (data = cache_find(eeprom, page)); page++) {
+		uint start = page * PICO_1WIRE_EEPROM_PAGE_SIZE;
+		uint from = (offset > start ? offset - start : 0);
+		uint to = (offset + len < start + PICO_1WIRE_EEPROM_PAGE_SIZE ?
+			offset + len - start : PICO_1WIRE_EEPROM_PAGE_SIZE);
+		memcpy(&buf[start + from - offset], &data[from], to - from);
+	}
+	if (page > last) {
+		eeprom->cache_hits++;
+		return 0;
+	}
+	eeprom->cache_misses++;
+
+	/* Stream rest of the pages using single Read Memory command */
+	cmd[0] = CMD_READ_MEMORY;
+	cmd[1] = (page * PICO_1WIRE_EEPROM_PAGE_SIZE) & 0xff;
+	cmd[2] = (page * PICO_1WIRE_EEPROM_PAGE_SIZE) >> 8;
+	if (pico_1wire_select(eeprom->ctx, PICO_1WIRE_SELECT_RESUME, eeprom->addr))
+		return 1;
+	pico_1wire_write_block(eeprom->ctx, cmd, 3, 0);
+
+	for (; page <= last; page++) {
+		uint start = page * PICO_1WIRE_EEPROM_PAGE_SIZE;
+		uint from = (offset > start ? offset - start : 0);
+		uint to = (offset + len < start + PICO_1WIRE_EEPROM_PAGE_SIZE ?
+			offset + len - start : PICO_1WIRE_EEPROM_PAGE_SIZE);
+		pico_1wire_read_block(eeprom->ctx, page_buf, PICO_1WIRE_EEPROM_PAGE_SIZE);
+		cache_store(eeprom, page, page_buf);
+		memcpy(&buf[start + from - offset], &page_buf[from], to - from);
+	}
+
+	return 0;
+}
+
+
+int pico_1wire_eeprom_write(pico_1wire_eeprom_t *eeprom, uint offset, const uint8_t *buf, uint len)
+{
+	uint8_t row[MAX_ROW_SIZE];
+	uint pos = 0;
+	int res;
+
+	if (!eeprom || !buf || offset >= eeprom->size || len > eeprom->size - offset)
+		return -1;
+
+	while (pos < len) {
+		uint row_start = (offset + pos) & ~(eeprom->row_size - 1);
+		uint from = offset + pos - row_start;
+		uint count = eeprom->row_size - from;
+		uint page = row_start / PICO_1WIRE_EEPROM_PAGE_SIZE;
+		uint8_t *data;
+
+		if (count > len - pos)
+			count = len - pos;
+
+		/* Get current row contents (from cache, if available) */
+		if ((data = cache_find(eeprom, page))) {
+			memcpy(row, &data[row_start % PICO_1WIRE_EEPROM_PAGE_SIZE], eeprom->row_size);
+		} else if (count < eeprom->row_size) {
+			if ((res = pico_1wire_eeprom_read(eeprom, row_start, row, eeprom->row_size)))
+				return res;
+			data = cache_find(eeprom, page);
+		}
+
+		if (!data || memcmp(&row[from], &buf[pos], count)) {
+			memcpy(&row[from], &buf[pos], count);
+			if ((res = write_row(eeprom, row_start, row)))
+				return res;
+			if ((data = cache_find(eeprom, page)))
+				memcpy(&data[row_start % PICO_1WIRE_EEPROM_PAGE_SIZE], row, eeprom->row_size);
+		}
+
+		pos += count;
+	}
+
+	return 0;
+}
+
+
+void pico_1wire_eeprom_invalidate(pico_1wire_eeprom_t *eeprom)
+{
+	if (!eeprom)
+		return;
+
+	for (uint i = 0; i < PICO_1WIRE_EEPROM_CACHE_PAGES; i++)
+		eeprom->page[i] = NO_PAGE;
+	eeprom->next_slot = 0;
+}
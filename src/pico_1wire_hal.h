@@ -0,0 +1,206 @@
+/* pico_1wire_hal.h
+
+   Copyright (C) 2024 Timo Kokkonen <tjko@iki.fi>
+
+   SPDX-License-Identifier: GPL-3.0-or-later
+
+   This file is part of pico-1wire Library.
+
+   pico-1wire Library is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   pico-1wire Library is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with pico-1wire Library. If not, see <https://www.gnu.org/licenses/>.
+*/
+
+/* Hardware abstraction layer used by the library.
+ *
+ * On Pico these map directly to Pico SDK (inline) functions. Helpers used
+ * by slot-level code are declared HAL_INLINE (forced inline on Pico).
+ * When PICO_1WIRE_RAM_FUNCS is enabled, delays use a busy-wait loop on the
+ * (32bit) timer instead of sleep_us(), so slot-level code does not call
+ * into flash.
+ * On host builds (PICO_1WIRE_HOST defined) these map to host backend
+ * that uses virtual clock and pluggable pin backend (see pico_1wire_host.h).
+ *
+ * I2C functions (used by DS2482 bridge backend) return number of bytes
+ * transferred, or negative value on error (no acknowledge from device).
+ * On Pico they are only available with PICO_1WIRE_DS2482 (hardware_i2c).
+ */
+
+#ifndef PICO_1WIRE_HAL_H
+#define PICO_1WIRE_HAL_H 1
+
+#ifdef PICO_1WIRE_HOST
+
+#include "pico_1wire_host.h"
+
+#define HAL_GPIO_OUT true
+#define HAL_GPIO_IN  false
+
+#define HAL_RAM_FUNC(func) func
+#define HAL_RAM_DATA(group)
+#define HAL_INLINE static inline
+
+static inline void hal_gpio_init(uint pin)
+{
+	pico_1wire_host_pin_init(pin);
+}
+
+HAL_INLINE void hal_gpio_set_dir(uint pin, bool out)
+{
+	pico_1wire_host_pin_dir(pin, out);
+}
+
+HAL_INLINE void hal_gpio_put(uint pin, bool value)
+{
+	pico_1wire_host_pin_put(pin, value);
+}
+
+HAL_INLINE bool hal_gpio_get(uint pin)
+{
+	return pico_1wire_host_pin_get(pin);
+}
+
+HAL_INLINE void hal_sleep_us(uint64_t us)
+{
+	pico_1wire_host_sleep_us(us);
+}
+
+static inline void hal_sleep_ms(uint32_t ms)
+{
+	pico_1wire_host_sleep_us((uint64_t)ms * 1000);
+}
+
+static inline uint64_t hal_time_us(void)
+{
+	return pico_1wire_host_time_us();
+}
+
+HAL_INLINE uint32_t hal_time_us32(void)
+{
+	return (uint32_t)pico_1wire_host_time_us();
+}
+
+HAL_INLINE uint32_t hal_irq_save(void)
+{
+	return 0;
+}
+
+HAL_INLINE void hal_irq_restore(uint32_t state)
+{
+	(void)state;
+}
+
+static inline int hal_i2c_write(uint bus, uint8_t addr, const uint8_t *buf, size_t len)
+{
+	return pico_1wire_host_i2c_write(bus, addr, buf, len);
+}
+
+static inline int hal_i2c_read(uint bus, uint8_t addr, uint8_t *buf, size_t len)
+{
+	return pico_1wire_host_i2c_read(bus, addr, buf, len);
+}
+
+#else /* PICO_1WIRE_HOST */
+
+#include "pico/stdlib.h"
+#include "hardware/gpio.h"
+#include "hardware/sync.h"
+#if PICO_1WIRE_DS2482
+#include "hardware/i2c.h"
+#endif
+
+#define HAL_GPIO_OUT GPIO_OUT
+#define HAL_GPIO_IN  GPIO_IN
+
+#if PICO_1WIRE_RAM_FUNCS
+#define HAL_RAM_FUNC(func) __no_inline_not_in_flash_func(func)
+#define HAL_RAM_DATA(group) __not_in_flash(group)
+#else
+#define HAL_RAM_FUNC(func) func
+#define HAL_RAM_DATA(group)
+#endif
+
+/* Helpers called from slot-level (RAM) functions must be inlined also in Debug builds. */
+#define HAL_INLINE static __force_inline
+
+static inline void hal_gpio_init(uint pin)
+{
+	gpio_init(pin);
+}
+
+HAL_INLINE void hal_gpio_set_dir(uint pin, bool out)
+{
+	gpio_set_dir(pin, out);
+}
+
+HAL_INLINE void hal_gpio_put(uint pin, bool value)
+{
+	gpio_put(pin, value);
+}
+
+HAL_INLINE bool hal_gpio_get(uint pin)
+{
+	return gpio_get(pin);
+}
+
+HAL_INLINE void hal_sleep_us(uint64_t us)
+{
+#if PICO_1WIRE_RAM_FUNCS
+	uint32_t start = time_us_32();
+
+	while (time_us_32() - start < us)
+		tight_loop_contents();
+#else
+	sleep_us(us);
+#endif
+}
+
+static inline void hal_sleep_ms(uint32_t ms)
+{
+	sleep_ms(ms);
+}
+
+static inline uint64_t hal_time_us(void)
+{
+	return time_us_64();
+}
+
+HAL_INLINE uint32_t hal_time_us32(void)
+{
+	return time_us_32();
+}
+
+HAL_INLINE uint32_t hal_irq_save(void)
+{
+	return save_and_disable_interrupts();
+}
+
+HAL_INLINE void hal_irq_restore(uint32_t state)
+{
+	restore_interrupts(state);
+}
+
+#if PICO_1WIRE_DS2482
+static inline int hal_i2c_write(uint bus, uint8_t addr, const uint8_t *buf, size_t len)
+{
+	return i2c_write_blocking(i2c_get_instance(bus), addr, buf, len, false);
+}
+
+static inline int hal_i2c_read(uint bus, uint8_t addr, uint8_t *buf, size_t len)
+{
+	return i2c_read_blocking(i2c_get_instance(bus), addr, buf, len, false);
+}
+#endif
+
+#endif /* PICO_1WIRE_HOST */
+
+#endif /* PICO_1WIRE_HAL_H */
@@ -0,0 +1,93 @@
+/* pico_1wire_max31850.c
+
+   Copyright (C) 2024 Timo Kokkonen <tjko@iki.fi>
+
+   SPDX-License-Identifier: GPL-3.0-or-later
+
+   This file is part of pico-1wire Library.
+
+   pico-1wire Library is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   pico-1wire Library is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with pico-1wire Library. If not, see <https://www.gnu.org/licenses/>.
+*/
+
+
+/* Driver for MAX31850/MAX31851 cold-junction compensated thermocouple-to-digital converters. */
+
+#include "pico_1wire_drivers.h"
+#include "pico_1wire_max31850.h"
+
+
+#define MAX31850_CONVERSION_TIME 100    /* 100ms */
+
+
+static int max31850_decode(const uint8_t *scratch, float *temperature)
+{
+	/* Thermocouple temperature: 14bit signed (0.25C), bit 0 is fault flag. */
+	int16_t raw = (int16_t)((scratch[1] << 8) | scratch[0]);
+
+	*temperature = (float)(raw >> 2) * 0.25;
+
+	return (scratch[0] & 0x01 ? 2 : 0);
+}
+
+
+static uint max31850_conversion_time(uint resolution)
+{
+	(void)resolution;
+
+	return MAX31850_CONVERSION_TIME;
+}
+
+
+const pico_1wire_driver_t pico_1wire_driver_max31850 = {
+	.family = FAMILY_CODE_MAX31850,
+	.name = "MAX31850",
+	.resolution = 14,
+	.decode = max31850_decode,
+	.conversion_time = max31850_conversion_time,
+};
+
+
+int pico_1wire_max31850_decode(const uint8_t *scratch, pico_1wire_thermocouple_t *tc)
+{
+	int16_t raw;
+
+	if (!scratch || !tc)
+		return -1;
+
+	max31850_decode(scratch, &tc->temperature);
+	/* Cold-junction temperature: 12bit signed (0.0625C), bits 0-2 are fault status. */
+	raw = (int16_t)((scratch[3] << 8) | scratch[2]);
+	tc->cold_junction = (float)(raw >> 4) * 0.0625;
+	tc->fault = (scratch[0] & 0x01 ? scratch[2] & 0x07 : 0);
+	tc->address = scratch[4] & 0x0f;
+
+	return (scratch[0] & 0x01 ? 3 : 0);
+}
+
+
+int pico_1wire_get_thermocouple(pico_1wire_t *ctx, uint64_t addr, pico_1wire_thermocouple_t *tc)
+{
+	uint8_t scratch[9];
+
+	if (!ctx || !tc)
+		return -1;
+
+	if (pico_1wire_read_scratch_pad(ctx, addr, scratch))
+		return 1;
+
+	if (find_device_driver(ctx, addr, scratch) != &pico_1wire_driver_max31850)
+		return 2;
+
+	return pico_1wire_max31850_decode(scratch, tc);
+}
@@ -0,0 +1,198 @@
+/* pico_1wire_switch.c
+
+   Copyright (C) 2024 Timo Kokkonen <tjko@iki.fi>
+
+   SPDX-License-Identifier: GPL-3.0-or-later
+
+   This file is part of pico-1wire Library.
+
+   pico-1wire Library is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   pico-1wire Library is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with pico-1wire Library. If not, see <https://www.gnu.org/licenses/>.
+*/
+
+
+/* Channel access support for DS2408 and DS2413 addressable switches. */
+
+#include <string.h>
+
+#include "pico_1wire_drivers.h"
+#include "pico_1wire_switch.h"
+
+
+/* Function Commands */
+#define CMD_READ_PIO_REGISTERS     0xF0
+#define CMD_CHANNEL_ACCESS_READ    0xF5
+#define CMD_CHANNEL_ACCESS_WRITE   0x5A
+
+#define CONFIRMATION           0xAA
+#define CRC16_RESIDUE          0xB001  /* CRC-16 over data and (inverted) CRC */
+#define DS2408_REG_PIO_LOGIC   0x88    /* PIO Logic State register */
+#define DS2408_REG_COUNT       8       /* Registers 0x88..0x8F */
+#define DS2408_SAMPLE_BLOCK    32      /* Channel Access Read CRC interval */
+
+#define IS_DS2413(sw) (((sw)->addr >> 56) == FAMILY_CODE_DS2413)
+
+
+/* Decode DS2413 status byte (PIOA state, PIOA latch, PIOB state, PIOB latch + complement). */
+static int ds2413_pins(uint8_t status, uint8_t *state)
+{
+	if ((status & 0x0f) != (~status >> 4 & 0x0f))
+		return 2;
+
+	*state = (status & 0x01) | ((status >> 1) & 0x02);
+	return 0;
+}
+
+
+int pico_1wire_switch_init(pico_1wire_switch_t *sw, pico_1wire_t *ctx, uint64_t addr)
+{
+	if (!sw || !ctx || !addr)
+		return -1;
+
+	memset(sw, 0, sizeof(pico_1wire_switch_t));
+	sw->ctx = ctx;
+	sw->addr = addr;
+
+	switch (addr >> 56) {
+	case FAMILY_CODE_DS2408:
+		sw->channels = 8;
+		break;
+	case FAMILY_CODE_DS2413:
+		sw->channels = 2;
+		break;
+	default:
+		return 2;
+	}
+	sw->latch = (1 << sw->channels) - 1;
+
+	return 0;
+}
+
+
+int pico_1wire_switch_read(pico_1wire_switch_t *sw, uint8_t *state)
+{
+	uint8_t buf[3 + DS2408_REG_COUNT + 2];
+
+	if (!sw || !state)
+		return -1;
+
+	if (IS_DS2413(sw))
+		return pico_1wire_switch_sample(sw, state, 1);
+
+	/* Read PIO registers from PIO Logic State register to end of register page (and CRC) */
+	buf[0] = CMD_READ_PIO_REGISTERS;
+	buf[1] = DS2408_REG_PIO_LOGIC;
+	buf[2] = 0;
+	if (pico_1wire_select(sw->ctx, PICO_1WIRE_SELECT_RESUME, sw->addr))
+		return 1;
+	pico_1wire_write_block(sw->ctx, buf, 3, 0);
+	pico_1wire_read_block(sw->ctx, &buf[3], DS2408_REG_COUNT + 2);
+	if (pico_1wire_crc16(0, buf, sizeof(buf)) != CRC16_RESIDUE)
+		return 2;
+
+	*state = buf[3];
+	return 0;
+}
+
+
+int pico_1wire_switch_sample(pico_1wire_switch_t *sw, uint8_t *buf, uint count)
+{
+	uint8_t block[DS2408_SAMPLE_BLOCK + 2];
+	uint8_t cmd = CMD_CHANNEL_ACCESS_READ;
+	uint16_t crc;
+	uint pos = 0;
+
+	if (!sw || !buf)
+		return -1;
+
+	/* Nothing to do, do not leave device in channel access mode. */
+	if (count == 0)
+		return 0;
+
+	if (pico_1wire_select(sw->ctx, PICO_1WIRE_SELECT_RESUME, sw->addr))
+		return 1;
+	pico_1wire_write_block(sw->ctx, &cmd, 1, 0);
+
+	if (IS_DS2413(sw)) {
+		for (; pos < count; pos++) {
+			pico_1wire_read_block(sw->ctx, block, 1);
+			if (ds2413_pins(block[0], &buf[pos]))
+				return 2;
+		}
+		return 0;
+	}
+
+	/* First CRC covers command byte and first block, following ones only the block */
+	crc = pico_1wire_crc16(0, &cmd, 1);
+	while (pos < count) {
+		uint n = count - pos;
+		if (n > DS2408_SAMPLE_BLOCK)
+			n = DS2408_SAMPLE_BLOCK;
+		pico_1wire_read_block(sw->ctx, block, sizeof(block));
+		if (pico_1wire_crc16(crc, block, sizeof(block)) != CRC16_RESIDUE)
+			return 2;
+		memcpy(&buf[pos], block, n);
+		pos += n;
+		crc = 0;
+	}
+
+	return 0;
+}
+
+
+int pico_1wire_switch_write(pico_1wire_switch_t *sw, const uint8_t *values, uint count, uint8_t *state)
+{
+	uint8_t cmd = CMD_CHANNEL_ACCESS_WRITE;
+	uint8_t buf[2];
+	uint8_t pins = 0;
+
+	if (!sw || (!values && count > 0))
+		return -1;
+
+	/* Nothing to do, do not leave device in channel access mode. */
+	if (count == 0)
+		return 0;
+
+	if (pico_1wire_select(sw->ctx, PICO_1WIRE_SELECT_RESUME, sw->addr))
+		return 1;
+	pico_1wire_write_block(sw->ctx, &cmd, 1, 0);
+
+	for (uint i = 0; i < count; i++) {
+		/* DS2413 requires unused upper bits to be set */
+		uint8_t value = (IS_DS2413(sw) ? values[i] | 0xfc : values[i]);
+		buf[0] = value;
+		buf[1] = ~value;
+		pico_1wire_write_block(sw->ctx, buf, 2, 0);
+		pico_1wire_read_block(sw->ctx, buf, 2);
+		if (buf[0] != CONFIRMATION)
+			return 3;
+		if (IS_DS2413(sw)) {
+			if (ds2413_pins(buf[1], &pins))
+				return 3;
+		} else {
+			pins = buf[1];
+		}
+		sw->latch = values[i] & ((1 << sw->channels) - 1);
+	}
+
+	if (state)
+		*state = pins;
+
+	return 0;
+}
+
+
+int pico_1wire_switch_set(pico_1wire_switch_t *sw, uint8_t latch)
+{
+	return pico_1wire_switch_write(sw, &latch, 1, NULL);
+}
@@ -0,0 +1,108 @@
+/* pico_1wire_test.c
+
+   Copyright (C) 2024 Timo Kokkonen <tjko@iki.fi>
+
+   SPDX-License-Identifier: GPL-3.0-or-later
+
+   This file is part of pico-1wire Library.
+
+   pico-1wire Library is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   pico-1wire Library is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with pico-1wire Library. If not, see <https://www.gnu.org/licenses/>.
+*/
+
+/* Regression tests: runs library functions against the simulated bus and
+   checks results. Tests are selected by name (see tests[] in each test program),
+   exit status is non-zero if any check failed. */
+
+#include "pico_1wire_test.h"
+
+
+uint failures = 0;
+pico_1wire_sim_t *sim;
+pico_1wire_t *ctx;
+
+
+void bus_setup()
+{
+	sim = pico_1wire_sim_create(DATA_PIN, POWER_PIN, true);
+	CHECK(sim != NULL);
+}
+
+
+void bus_start()
+{
+	ctx = pico_1wire_init(DATA_PIN, POWER_PIN, true);
+	CHECK(ctx != NULL);
+}
+
+
+void bus_teardown()
+{
+	if (ctx)
+		pico_1wire_destroy(ctx);
+	if (sim)
+		pico_1wire_sim_destroy(sim);
+	ctx = NULL;
+	sim = NULL;
+}
+
+
+bool in_list(const uint64_t *addr_list, uint count, uint64_t addr)
+{
+	for (uint i = 0; i < count; i++) {
+		if (addr_list[i] == addr)
+			return true;
+	}
+	return false;
+}
+
+
+void rom_bytes(uint64_t addr, uint8_t *buf)
+{
+	/* Family code (first byte on the wire) is in the most significant byte. */
+	for (int i = 0; i < 8; i++)
+		buf[i] = (addr >> (56 - 8 * i)) & 0xff;
+}
+
+
+uint rom_serial(uint64_t addr)
+{
+	/* Low byte of serial number follows family code. */
+	return (addr >> 48) & 0xff;
+}
+
+
+int main(int argc, char **argv)
+{
+	bool found = false;
+
+	for (uint i = 0; i < test_count; i++) {
+		if (argc > 1 && strcmp(argv[1], tests[i].name))
+			continue;
+		found = true;
+		printf("%s\n", tests[i].name);
+		tests[i].func();
+	}
+
+	if (!found) {
+		fprintf(stderr, "usage: %s [test]\n", argv[0]);
+		return 2;
+	}
+
+	if (failures) {
+		printf("%u check(s) failed\n", failures);
+		return 1;
+	}
+
+	return 0;
+}
@@ -0,0 +1,74 @@
+/* pico_1wire_test.h
+
+   Copyright (C) 2024 Timo Kokkonen <tjko@iki.fi>
+
+   SPDX-License-Identifier: GPL-3.0-or-later
+
+   This file is part of pico-1wire Library.
+
+   pico-1wire Library is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   pico-1wire Library is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with pico-1wire Library. If not, see <https://www.gnu.org/licenses/>.
+*/
+
+
+/* Common helpers for regression tests. Each test program (pico_1wire_test_xxx.c)
+ * provides its tests[] table, pico_1wire_test.c runs them against the simulated bus.
+ */
+
+#ifndef PICO_1WIRE_TEST_H
+#define PICO_1WIRE_TEST_H 1
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "pico_1wire.h"
+#include "pico_1wire_sim.h"
+
+
+#define DATA_PIN  16
+#define POWER_PIN 17
+
+#define MAX_DEVICES 64
+
+
+#define CHECK(cond) do {						\
+		if (!(cond)) {						\
+			fprintf(stderr, "%s:%d: check failed: %s\n",	\
+				__FILE__, __LINE__, #cond);		\
+			failures++;					\
+		}							\
+	} while (0)
+
+
+typedef struct test_case_t {
+	const char *name;
+	void (*func)();
+} test_case_t;
+
+/* Provided by each test program. */
+extern const test_case_t tests[];
+extern const uint test_count;
+
+extern uint failures;
+extern pico_1wire_sim_t *sim;
+extern pico_1wire_t *ctx;
+
+void bus_setup();
+void bus_start();
+void bus_teardown();
+bool in_list(const uint64_t *addr_list, uint count, uint64_t addr);
+void rom_bytes(uint64_t addr, uint8_t *buf);
+uint rom_serial(uint64_t addr);
+
+#endif /* PICO_1WIRE_TEST_H */
@@ -0,0 +1,108 @@
+/* pico_1wire_test_adaptive.c
+
+   Copyright (C) 2024 Timo Kokkonen <tjko@iki.fi>
+
+   SPDX-License-Identifier: GPL-3.0-or-later
+
+   This file is part of pico-1wire Library.
+
+   pico-1wire Library is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   pico-1wire Library is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with pico-1wire Library. If not, see <https://www.gnu.org/licenses/>.
+*/
+
+
+/* Regression tests: adaptive resolution control. */
+
+#include <math.h>
+
+#include "pico_1wire_test.h"
+
+
+/* Convert and read sensor, return resolution selected for next conversion. */
+static uint measure(uint64_t addr, pico_1wire_sim_device_t *dev, float temperature)
+{
+	uint resolution = 0;
+	float temp;
+
+	pico_1wire_sim_set_temperature(dev, temperature);
+	CHECK(pico_1wire_convert_temperature(ctx, addr, true) == 0);
+	CHECK(pico_1wire_get_temperature(ctx, addr, &temp) == 0);
+	CHECK(temp == temperature);
+	CHECK(pico_1wire_get_resolution(ctx, addr, &resolution) == 0);
+
+	return resolution;
+}
+
+
+static void test_adaptive()
+{
+	pico_1wire_adaptive_config_t config = {
+		.accuracy = 0.125,
+		.stable_delta = 0.5,
+		.threshold_low = NAN,
+		.threshold_high = NAN,
+		.threshold_margin = 1.0,
+		.min_resolution = 9,
+	};
+	uint64_t addr = pico_1wire_sim_rom(0x28, 1);
+	pico_1wire_sim_device_t *dev;
+	uint64_t addr_list[2];
+	uint found, duration;
+
+	bus_setup();
+	dev = pico_1wire_sim_add_device(sim, addr, false);
+	bus_start();
+	CHECK(pico_1wire_search_rom(ctx, addr_list, 2, &found) == 0);
+
+	config.min_resolution = 13;
+	CHECK(pico_1wire_set_adaptive_resolution(ctx, &config) == -1);
+	config.min_resolution = 9;
+	CHECK(pico_1wire_set_adaptive_resolution(ctx, &config) == 0);
+
+	/* First reading (no history): lowest resolution meeting the accuracy target (0.125C = 11bit). */
+	CHECK(measure(addr, dev, 20.0) == 11);
+
+	/* Stable reading: minimum resolution, shorter conversion. */
+	CHECK(measure(addr, dev, 20.0) == 9);
+	CHECK(pico_1wire_convert_duration(ctx, addr, &duration) == 0);
+	CHECK(duration == 95);
+
+	/* Fast change: back to accuracy target. */
+	CHECK(measure(addr, dev, 25.0) == 11);
+	CHECK(measure(addr, dev, 25.0) == 9);
+
+	/* Tighter accuracy target (0.0625C = 12bit). */
+	config.accuracy = 0.0625;
+	CHECK(pico_1wire_set_adaptive_resolution(ctx, &config) == 0);
+	CHECK(measure(addr, dev, 25.0) == 12);
+	CHECK(measure(addr, dev, 25.0) == 9);
+
+	/* Stable reading near threshold keeps accuracy target. */
+	config.threshold_high = 25.5;
+	CHECK(pico_1wire_set_adaptive_resolution(ctx, &config) == 0);
+	CHECK(measure(addr, dev, 25.0) == 12);
+	CHECK(measure(addr, dev, 25.0) == 12);
+
+	/* Disabled: resolution is left as is. */
+	CHECK(pico_1wire_set_adaptive_resolution(ctx, NULL) == 0);
+	CHECK(measure(addr, dev, 30.0) == 12);
+
+	bus_teardown();
+}
+
+
+const test_case_t tests[] = {
+	{ "adaptive", test_adaptive },
+};
+
+const uint test_count = sizeof(tests) / sizeof(tests[0]);
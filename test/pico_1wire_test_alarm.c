@@ -0,0 +1,88 @@
+/* pico_1wire_test_alarm.c
+
+   Copyright (C) 2024 Timo Kokkonen <tjko@iki.fi>
+
+   SPDX-License-Identifier: GPL-3.0-or-later
+
+   This file is part of pico-1wire Library.
+
+   pico-1wire Library is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   pico-1wire Library is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with pico-1wire Library. If not, see <https://www.gnu.org/licenses/>.
+*/
+
+
+/* Regression tests: TH/TL alarm thresholds and threshold monitoring. */
+
+#include "pico_1wire_test.h"
+
+
+static void test_alarm()
+{
+	static const uint8_t recall[] = { 0xb8 };
+	const pico_1wire_op_t recall_ops[] = {
+		{ .type = PICO_1WIRE_OP_SELECT, .mode = PICO_1WIRE_SELECT_MATCH },
+		{ .type = PICO_1WIRE_OP_WRITE, .len = 1, .tx = recall },
+		{ .type = PICO_1WIRE_OP_DELAY, .len = 1 },
+	};
+	uint64_t addr_list[8], sensors[4];
+	pico_1wire_sim_stats_t sim_stats;
+	int8_t high[4], low[4];
+	uint8_t scratch[9];
+	uint found;
+
+	bus_setup();
+	for (uint i = 0; i < 4; i++) {
+		sensors[i] = pico_1wire_sim_rom(0x28, i + 1);
+		pico_1wire_sim_set_temperature(pico_1wire_sim_add_device(sim, sensors[i], i % 2), 10.0 + i * 10);
+		high[i] = (i < 3 ? 25 : 50);
+		low[i] = 15;
+	}
+	bus_start();
+	CHECK(pico_1wire_search_rom(ctx, addr_list, 8, &found) == 0);
+
+	/* Thresholds are copied to EEPROM (with strong pull-up for phantom powered sensors). */
+	pico_1wire_sim_reset_stats(sim);
+	CHECK(pico_1wire_set_alarms(ctx, sensors, high, low, 4, PICO_1WIRE_SAVE_DEVICES) == 0);
+	for (uint i = 0; i < 4; i++) {
+		CHECK(pico_1wire_set_alarm(ctx, sensors[i], 100, -50, false) == 0);
+		CHECK(pico_1wire_run_transaction(ctx, recall_ops, 3, sensors[i], NULL) == 0);
+		CHECK(pico_1wire_read_scratch_pad(ctx, sensors[i], scratch) == 0);
+		CHECK((int8_t)scratch[2] == high[i] && (int8_t)scratch[3] == low[i]);
+	}
+	pico_1wire_sim_get_stats(sim, &sim_stats);
+	CHECK(sim_stats.power_faults == 0);
+
+	/* Only sensors outside their thresholds are found (10C below 15C, 30C above 25C). */
+	CHECK(pico_1wire_alarm_cycle(ctx, addr_list, 8, &found) == 0);
+	CHECK(found == 2);
+	CHECK(in_list(addr_list, found, sensors[0]));
+	CHECK(in_list(addr_list, found, sensors[2]));
+
+	/* All within thresholds: nothing found. */
+	for (uint i = 0; i < 4; i++)
+		pico_1wire_sim_set_temperature(pico_1wire_sim_device(sim, i), 20.0);
+	CHECK(pico_1wire_alarm_cycle(ctx, addr_list, 8, &found) == 0);
+	CHECK(found == 0);
+
+	pico_1wire_sim_get_stats(sim, &sim_stats);
+	CHECK(sim_stats.power_faults == 0);
+
+	bus_teardown();
+}
+
+
+const test_case_t tests[] = {
+	{ "alarm", test_alarm },
+};
+
+const uint test_count = sizeof(tests) / sizeof(tests[0]);
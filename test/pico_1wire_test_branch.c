@@ -0,0 +1,119 @@
+/* pico_1wire_test_branch.c
+
+   Copyright (C) 2024 Timo Kokkonen <tjko@iki.fi>
+
+   SPDX-License-Identifier: GPL-3.0-or-later
+
+   This file is part of pico-1wire Library.
+
+   pico-1wire Library is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   pico-1wire Library is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with pico-1wire Library. If not, see <https://www.gnu.org/licenses/>.
+*/
+
+/* Regression tests: DS2409 MicroLAN coupler branches (discovery, conversions, alarms). */
+
+#include "pico_1wire_test.h"
+
+
+static void test_branch()
+{
+	uint64_t addr_list[16], sensors[8];
+	pico_1wire_plan_step_t steps[PICO_1WIRE_PLAN_MAX_STEPS(6)];
+	pico_1wire_sim_stats_t sim_stats;
+	pico_1wire_sim_device_t *coupler;
+	int8_t high[6], low[6];
+	float temps[6];
+	int results[6];
+	uint found, count = 0, step_count;
+
+	/* Two sensors on main trunk and on each branch of a DS2409 coupler. */
+	bus_setup();
+	coupler = pico_1wire_sim_add_device(sim, pico_1wire_sim_rom(0x1f, 1), false);
+	for (uint i = 0; i < 6; i++) {
+		pico_1wire_sim_device_t *dev = pico_1wire_sim_add_device(sim, pico_1wire_sim_rom(0x28, i + 1), i % 2);
+		pico_1wire_sim_set_temperature(dev, 20.0 + i);
+		if (i >= 2)
+			pico_1wire_sim_set_branch(dev, coupler, (i - 2) / 2);
+	}
+	bus_start();
+
+	CHECK(pico_1wire_branch_discovery(ctx, addr_list, 16, &found) == 0);
+	CHECK(found == 7);
+	for (uint i = 0; i < found; i++) {
+		if ((addr_list[i] >> 56) == 0x28)
+			sensors[count++] = addr_list[i];
+	}
+	CHECK(count == 6);
+
+	/* Broadcast conversion reaches all branches. */
+	CHECK(pico_1wire_convert_temperature(ctx, 0, true) == 0);
+	for (uint i = 0; i < count; i++) {
+		uint serial = rom_serial(sensors[i]);
+		CHECK(pico_1wire_get_temperature(ctx, sensors[i], &temps[i]) == 0);
+		CHECK(temps[i] == 20.0 + serial - 1);
+	}
+
+	/* One broadcast conversion per branch (main trunk sensors convert along with the first one). */
+	CHECK(pico_1wire_plan_conversions(ctx, sensors, count, 3000, steps, PICO_1WIRE_PLAN_MAX_STEPS(6),
+						&step_count) == 0);
+	CHECK(step_count == count + 2);
+	pico_1wire_sim_reset_stats(sim);
+	CHECK(pico_1wire_run_conversion_plan(ctx, sensors, count, steps, step_count, temps, results) == 0);
+	pico_1wire_sim_get_stats(sim, &sim_stats);
+	CHECK(sim_stats.power_faults == 0);
+	CHECK(sim_stats.parasitic_peak == 2);
+	for (uint i = 0; i < count; i++) {
+		uint serial = rom_serial(sensors[i]);
+		CHECK(results[i] == 0);
+		CHECK(temps[i] == 20.0 + serial - 1);
+	}
+
+	/* Budget for one phantom powered sensor: main trunk fits alone (broadcast with branches off),
+	   phantom powered sensors on branches are converted one at a time. */
+	CHECK(pico_1wire_plan_conversions(ctx, sensors, count, 1500, steps, PICO_1WIRE_PLAN_MAX_STEPS(6),
+						&step_count) == 0);
+	CHECK(step_count == 11);
+	CHECK(steps[2].type == PICO_1WIRE_STEP_CONVERT && steps[2].index == PICO_1WIRE_ALL_DEVICES);
+	pico_1wire_sim_reset_stats(sim);
+	CHECK(pico_1wire_run_conversion_plan(ctx, sensors, count, steps, step_count, temps, results) == 0);
+	pico_1wire_sim_get_stats(sim, &sim_stats);
+	CHECK(sim_stats.power_faults == 0);
+	CHECK(sim_stats.parasitic_peak == 1);
+	for (uint i = 0; i < count; i++) {
+		uint serial = rom_serial(sensors[i]);
+		CHECK(results[i] == 0);
+		CHECK(temps[i] == 20.0 + serial - 1);
+	}
+
+	/* Alarm on one trunk sensor and two sensors on branches. */
+	for (uint i = 0; i < count; i++) {
+		uint serial = rom_serial(sensors[i]);
+		high[i] = (serial == 1 || serial == 4 || serial == 5 ? 10 : 50);
+		low[i] = 0;
+	}
+	CHECK(pico_1wire_set_alarms(ctx, sensors, high, low, count, PICO_1WIRE_SAVE_NONE) == 0);
+	CHECK(pico_1wire_alarm_cycle(ctx, addr_list, 16, &found) == 0);
+	CHECK(found == 3);
+	CHECK(in_list(addr_list, found, pico_1wire_sim_rom(0x28, 1)));
+	CHECK(in_list(addr_list, found, pico_1wire_sim_rom(0x28, 4)));
+	CHECK(in_list(addr_list, found, pico_1wire_sim_rom(0x28, 5)));
+
+	bus_teardown();
+}
+
+
+const test_case_t tests[] = {
+	{ "branch", test_branch },
+};
+
+const uint test_count = sizeof(tests) / sizeof(tests[0]);
@@ -0,0 +1,81 @@
+/* pico_1wire_test_cache.c
+
+   Copyright (C) 2024 Timo Kokkonen <tjko@iki.fi>
+
+   SPDX-License-Identifier: GPL-3.0-or-later
+
+   This file is part of pico-1wire Library.
+
+   pico-1wire Library is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   pico-1wire Library is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with pico-1wire Library. If not, see <https://www.gnu.org/licenses/>.
+*/
+
+
+/* Regression tests: cached temperature reads. */
+
+#include "pico_1wire_test.h"
+
+
+static void test_cache()
+{
+	uint64_t addr = pico_1wire_sim_rom(0x28, 1);
+	pico_1wire_sim_device_t *dev;
+	pico_1wire_sim_stats_t sim_stats;
+	uint64_t addr_list[2];
+	float temp;
+	uint found;
+
+	bus_setup();
+	dev = pico_1wire_sim_add_device(sim, addr, false);
+	pico_1wire_sim_set_temperature(dev, 20.0);
+	bus_start();
+	CHECK(pico_1wire_search_rom(ctx, addr_list, 2, &found) == 0);
+
+	/* First read converts. */
+	pico_1wire_sim_reset_stats(sim);
+	CHECK(pico_1wire_get_temperature_cached(ctx, addr, 1000, &temp) == 0);
+	CHECK(temp == 20.0);
+	pico_1wire_sim_get_stats(sim, &sim_stats);
+	CHECK(sim_stats.resets > 0);
+
+	/* Read within max_age: cached value, no bus traffic. */
+	pico_1wire_sim_set_temperature(dev, 30.0);
+	pico_1wire_sim_reset_stats(sim);
+	CHECK(pico_1wire_get_temperature_cached(ctx, addr, 1000, &temp) == 0);
+	CHECK(temp == 20.0);
+	pico_1wire_sim_get_stats(sim, &sim_stats);
+	CHECK(sim_stats.resets == 0 && sim_stats.read_slots == 0);
+
+	/* Stale reading: converts again. */
+	CHECK(pico_1wire_get_temperature_cached(ctx, addr, 10, &temp) == 0);
+	CHECK(temp == 30.0);
+
+	/* Conversion in progress (started without waiting) is waited for instead of
+	   starting a new one: only the scratchpad read is on the bus. */
+	pico_1wire_sim_set_temperature(dev, 25.0);
+	CHECK(pico_1wire_convert_temperature(ctx, addr, false) == 0);
+	pico_1wire_sim_reset_stats(sim);
+	CHECK(pico_1wire_get_temperature_cached(ctx, addr, 10, &temp) == 0);
+	CHECK(temp == 25.0);
+	pico_1wire_sim_get_stats(sim, &sim_stats);
+	CHECK(sim_stats.resets == 1);
+
+	bus_teardown();
+}
+
+
+const test_case_t tests[] = {
+	{ "cache", test_cache },
+};
+
+const uint test_count = sizeof(tests) / sizeof(tests[0]);
@@ -0,0 +1,153 @@
+/* pico_1wire_test_ds2438.c
+
+   Copyright (C) 2024 Timo Kokkonen <tjko@iki.fi>
+
+   SPDX-License-Identifier: GPL-3.0-or-later
+
+   This file is part of pico-1wire Library.
+
+   pico-1wire Library is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   pico-1wire Library is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with pico-1wire Library. If not, see <https://www.gnu.org/licenses/>.
+*/
+
+
+
+/* Regression tests: DS2438 battery monitor. */
+
+#include "pico_1wire_test.h"
+#include "pico_1wire_ds2438.h"
+
+
+static void check_results(const uint64_t *addr_list, const pico_1wire_ds2438_t *results, uint count, bool ica)
+{
+	for (uint i = 0; i < count; i++) {
+		uint serial = rom_serial(addr_list[i]);
+		CHECK(results[i].temperature == (int16_t)((20 + serial - 1) * 256));
+		CHECK(results[i].voltage == 5000);
+		CHECK(results[i].current == 25);
+		CHECK(results[i].ica == (ica ? 0x10 : 0));
+	}
+}
+
+
+static void test_acquire()
+{
+	uint64_t addr_list[4];
+	pico_1wire_ds2438_t results[3];
+	pico_1wire_sim_stats_t sim_stats;
+	uint found;
+
+	bus_setup();
+	for (uint i = 0; i < 3; i++)
+		pico_1wire_sim_set_temperature(pico_1wire_sim_add_device(sim, pico_1wire_sim_rom(0x26, i + 1), false),
+					20.0 + i);
+	bus_start();
+	CHECK(pico_1wire_search_rom(ctx, addr_list, 4, &found) == 0);
+	CHECK(found == 3);
+
+	/* Bus with only DS2438 devices: conversions and recall are broadcast,
+	   each device is selected once per page. */
+	pico_1wire_sim_reset_stats(sim);
+	CHECK(pico_1wire_ds2438_acquire(ctx, addr_list, found, results, false) == 0);
+	check_results(addr_list, results, found, false);
+	pico_1wire_sim_get_stats(sim, &sim_stats);
+	CHECK(sim_stats.resets == 3 + found);
+
+	pico_1wire_sim_reset_stats(sim);
+	CHECK(pico_1wire_ds2438_acquire(ctx, addr_list, found, results, true) == 0);
+	check_results(addr_list, results, found, true);
+	pico_1wire_sim_get_stats(sim, &sim_stats);
+	CHECK(sim_stats.resets == 4 + 2 * found);
+
+	/* Partial list. */
+	CHECK(pico_1wire_ds2438_acquire(ctx, &addr_list[1], 1, results, false) == 0);
+	check_results(&addr_list[1], results, 1, false);
+
+	bus_teardown();
+}
+
+
+static void test_acquire_mixed()
+{
+	uint64_t addr_list[4];
+	uint64_t ds2438_list[3];
+	pico_1wire_ds2438_t results[3];
+	pico_1wire_sim_stats_t sim_stats;
+	uint found, n = 0;
+
+	bus_setup();
+	for (uint i = 0; i < 3; i++)
+		pico_1wire_sim_set_temperature(pico_1wire_sim_add_device(sim, pico_1wire_sim_rom(0x26, i + 1), false),
+					20.0 + i);
+	pico_1wire_sim_add_device(sim, pico_1wire_sim_rom(0x28, 9), true);
+	bus_start();
+	CHECK(pico_1wire_search_rom(ctx, addr_list, 4, &found) == 0);
+	CHECK(found == 4);
+	for (uint i = 0; i < found; i++) {
+		if ((addr_list[i] >> 56) == 0x26)
+			ds2438_list[n++] = addr_list[i];
+	}
+	CHECK(n == 3);
+
+	/* Other devices in the bus: no broadcasts (0x44 would start phantom powered conversion),
+	   each command uses Match ROM. */
+	pico_1wire_sim_reset_stats(sim);
+	CHECK(pico_1wire_ds2438_acquire(ctx, ds2438_list, n, results, true) == 0);
+	check_results(ds2438_list, results, n, true);
+	pico_1wire_sim_get_stats(sim, &sim_stats);
+	CHECK(sim_stats.resets == 6 * n);
+	CHECK(sim_stats.power_faults == 0);
+
+	bus_teardown();
+}
+
+
+static void test_pages()
+{
+	uint64_t addr = pico_1wire_sim_rom(0x26, 1);
+	pico_1wire_sim_device_t *dev;
+	pico_1wire_ds2438_t result;
+	uint8_t page[8];
+
+	bus_setup();
+	dev = pico_1wire_sim_add_device(sim, addr, false);
+	bus_start();
+
+	CHECK(pico_1wire_ds2438_read_page(ctx, addr, 8, page) == -1);
+	CHECK(pico_1wire_ds2438_read_page(ctx, addr, 1, page) == 0);
+	CHECK(page[4] == 0x10);
+
+	/* Voltage A/D input selected by configuration (VAD instead of VDD). */
+	CHECK(pico_1wire_ds2438_set_config(ctx, addr, PICO_1WIRE_DS2438_IAD | PICO_1WIRE_DS2438_CA) == 0);
+	CHECK(pico_1wire_ds2438_acquire(ctx, &addr, 1, &result, false) == 0);
+	CHECK(result.voltage == 3700);
+	CHECK((result.status & 0x0f) == (PICO_1WIRE_DS2438_IAD | PICO_1WIRE_DS2438_CA));
+
+	/* CRC-8 error in page data. */
+	CHECK(pico_1wire_sim_corrupt_bit(dev, 12) == 0);
+	CHECK(pico_1wire_ds2438_read_page(ctx, addr, 0, page) == 2);
+	CHECK(pico_1wire_sim_corrupt_bit(dev, 20) == 0);
+	CHECK(pico_1wire_ds2438_acquire(ctx, &addr, 1, &result, false) == 2);
+	CHECK(pico_1wire_ds2438_acquire(ctx, &addr, 1, &result, false) == 0);
+
+	bus_teardown();
+}
+
+
+const test_case_t tests[] = {
+	{ "acquire", test_acquire },
+	{ "acquire_mixed", test_acquire_mixed },
+	{ "pages", test_pages },
+};
+
+const uint test_count = sizeof(tests) / sizeof(tests[0]);
@@ -0,0 +1,80 @@
+/* pico_1wire_test_ds2482.c
+
+   Copyright (C) 2024 Timo Kokkonen <tjko@iki.fi>
+
+   SPDX-License-Identifier: GPL-3.0-or-later
+
+   This file is part of pico-1wire Library.
+
+   pico-1wire Library is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   pico-1wire Library is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with pico-1wire Library. If not, see <https://www.gnu.org/licenses/>.
+*/
+
+
+
+/* Regression tests: DS2482 I2C-to-1-Wire bridge backend. */
+
+#include "pico_1wire_test.h"
+
+
+static void test_bridge()
+{
+	uint64_t addr_list[MAX_DEVICES];
+	pico_1wire_sim_ds2482_t *bridge;
+	pico_1wire_stats_t stats;
+	float temp;
+	uint found;
+
+	bus_setup();
+	pico_1wire_sim_add_devices(sim, 0x28, 30, false, 4);
+	for (uint i = 0; i < 30; i++)
+		pico_1wire_sim_set_temperature(pico_1wire_sim_device(sim, i), -10.0 + i);
+
+	bridge = pico_1wire_sim_ds2482_create(0, PICO_1WIRE_DS2482_ADDR, 1);
+	CHECK(bridge != NULL);
+	CHECK(pico_1wire_sim_ds2482_attach(bridge, 0, sim) == 0);
+
+	/* No bridge at this address. */
+	CHECK(pico_1wire_init_ds2482(0, PICO_1WIRE_DS2482_ADDR + 1, -1, 0) == NULL);
+
+	ctx = pico_1wire_init_ds2482(0, PICO_1WIRE_DS2482_ADDR, -1, 0);
+	CHECK(ctx != NULL);
+	if (ctx) {
+		/* Search using 1-Wire Triplet command. */
+		CHECK(pico_1wire_search_rom(ctx, addr_list, MAX_DEVICES, &found) == 0);
+		CHECK(found == 30);
+		for (uint i = 0; i < 30; i++)
+			CHECK(in_list(addr_list, found, pico_1wire_sim_device_addr(pico_1wire_sim_device(sim, i))));
+
+		CHECK(pico_1wire_convert_temperature(ctx, 0, true) == 0);
+		for (uint i = 0; i < 30; i++) {
+			uint64_t addr = pico_1wire_sim_device_addr(pico_1wire_sim_device(sim, i));
+			CHECK(pico_1wire_get_temperature(ctx, addr, &temp) == 0);
+			CHECK(temp == -10.0 + i);
+		}
+
+		CHECK(pico_1wire_get_stats(ctx, &stats) == 0);
+		CHECK(stats.search_crc_failures == 0);
+		CHECK(stats.crc_failures == 0);
+	}
+
+	bus_teardown();
+	pico_1wire_sim_ds2482_destroy(bridge);
+}
+
+
+const test_case_t tests[] = {
+	{ "bridge", test_bridge },
+};
+
+const uint test_count = sizeof(tests) / sizeof(tests[0]);
@@ -0,0 +1,111 @@
+/* pico_1wire_test_eeprom.c
+
+   Copyright (C) 2024 Timo Kokkonen <tjko@iki.fi>
+
+   SPDX-License-Identifier: GPL-3.0-or-later
+
+   This file is part of pico-1wire Library.
+
+   pico-1wire Library is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   pico-1wire Library is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with pico-1wire Library. If not, see <https://www.gnu.org/licenses/>.
+*/
+
+/* Regression tests: DS2431/DS28EC20 EEPROM access and page cache. */
+
+#include "pico_1wire_test.h"
+#include "pico_1wire_eeprom.h"
+
+
+static void test_eeprom()
+{
+	pico_1wire_eeprom_t eeprom;
+	pico_1wire_sim_stats_t sim_stats;
+	uint64_t addr = pico_1wire_sim_rom(0x2d, 1);
+	uint8_t buf[128], data[3] = { 0x11, 0x22, 0x33 };
+	uint8_t *mem;
+	uint size;
+	uint32_t misses;
+
+	bus_setup();
+	pico_1wire_sim_device_t *dev = pico_1wire_sim_add_device(sim, addr, false);
+	mem = pico_1wire_sim_memory(dev, &size);
+	CHECK(mem != NULL && size == 128);
+	for (uint i = 0; i < size; i++)
+		mem[i] = i;
+	bus_start();
+
+	CHECK(pico_1wire_eeprom_init(&eeprom, ctx, pico_1wire_sim_rom(0x28, 1)) == 2);
+	CHECK(pico_1wire_eeprom_init(&eeprom, ctx, addr) == 0);
+	CHECK(eeprom.size == 128);
+	CHECK(eeprom.row_size == 8);
+
+	CHECK(pico_1wire_eeprom_read(&eeprom, 0, buf, 128) == 0);
+	CHECK(memcmp(buf, mem, 128) == 0);
+	CHECK(eeprom.cache_misses > 0);
+	CHECK(pico_1wire_eeprom_read(&eeprom, 120, buf, 9) == -1);
+
+	/* Cached pages are read without bus access. */
+	misses = eeprom.cache_misses;
+	pico_1wire_sim_reset_stats(sim);
+	CHECK(pico_1wire_eeprom_read(&eeprom, 40, buf, 20) == 0);
+	CHECK(memcmp(buf, mem + 40, 20) == 0);
+	pico_1wire_sim_get_stats(sim, &sim_stats);
+	CHECK(sim_stats.resets == 0);
+	CHECK(eeprom.cache_misses == misses);
+	CHECK(eeprom.cache_hits > 0);
+
+	/* Partial row write preserves rest of the row. */
+	CHECK(pico_1wire_eeprom_write(&eeprom, 13, data, 3) == 0);
+	CHECK(memcmp(mem + 13, data, 3) == 0);
+	for (uint i = 8; i < 13; i++)
+		CHECK(mem[i] == i);
+	CHECK(pico_1wire_eeprom_read(&eeprom, 8, buf, 8) == 0);
+	CHECK(memcmp(buf, mem + 8, 8) == 0);
+
+	/* Write spanning rows (and pages). */
+	memset(buf, 0xa5, 20);
+	CHECK(pico_1wire_eeprom_write(&eeprom, 28, buf, 20) == 0);
+	CHECK(memcmp(mem + 28, buf, 20) == 0);
+	CHECK(mem[27] == 27 && mem[48] == 48);
+
+	/* Rows that already contain the data are not rewritten. */
+	pico_1wire_sim_reset_stats(sim);
+	CHECK(pico_1wire_eeprom_write(&eeprom, 13, data, 3) == 0);
+	pico_1wire_sim_get_stats(sim, &sim_stats);
+	CHECK(sim_stats.resets == 0);
+
+	/* Memory modified behind the cache is seen only after invalidate. */
+	mem[2] = 0xee;
+	CHECK(pico_1wire_eeprom_read(&eeprom, 2, buf, 1) == 0);
+	CHECK(buf[0] == 2);
+	pico_1wire_eeprom_invalidate(&eeprom);
+	CHECK(pico_1wire_eeprom_read(&eeprom, 2, buf, 1) == 0);
+	CHECK(buf[0] == 0xee);
+
+	/* CRC-16 error in Write Scratchpad response: row is not copied to memory. */
+	memset(buf, 0x44, 8);
+	CHECK(pico_1wire_sim_corrupt_bit(dev, 3) == 0);
+	CHECK(pico_1wire_eeprom_write(&eeprom, 64, buf, 8) == 2);
+	CHECK(mem[64] == 64);
+	CHECK(pico_1wire_eeprom_write(&eeprom, 64, buf, 8) == 0);
+	CHECK(memcmp(mem + 64, buf, 8) == 0);
+
+	bus_teardown();
+}
+
+
+const test_case_t tests[] = {
+	{ "eeprom", test_eeprom },
+};
+
+const uint test_count = sizeof(tests) / sizeof(tests[0]);
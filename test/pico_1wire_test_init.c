@@ -0,0 +1,148 @@
+/* pico_1wire_test_init.c
+
+   Copyright (C) 2024 Timo Kokkonen <tjko@iki.fi>
+
+   SPDX-License-Identifier: GPL-3.0-or-later
+
+   This file is part of pico-1wire Library.
+
+   pico-1wire Library is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   pico-1wire Library is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with pico-1wire Library. If not, see <https://www.gnu.org/licenses/>.
+*/
+
+
+
+/* Regression tests: context allocation and bus initialization. Also built with
+   PICO_1WIRE_STATIC_POOL_SIZE=2 (pico_1wire_test_pool) to test the static context pool. */
+
+#include "pico_1wire_test.h"
+
+
+static void test_lazy_init()
+{
+	uint64_t addr = pico_1wire_sim_rom(0x28, 1);
+	pico_1wire_sim_device_t *dev;
+	pico_1wire_sim_stats_t sim_stats;
+	float temp;
+
+	bus_setup();
+	dev = pico_1wire_sim_add_device(sim, addr, true);
+	pico_1wire_sim_set_temperature(dev, 21.5);
+
+	/* No bus access before first use. */
+	ctx = pico_1wire_init_ex(DATA_PIN, POWER_PIN, true, PICO_1WIRE_INIT_LAZY);
+	CHECK(ctx != NULL);
+	pico_1wire_sim_get_stats(sim, &sim_stats);
+	CHECK(sim_stats.resets == 0);
+	CHECK(sim_stats.write0_slots == 0 && sim_stats.write1_slots == 0 && sim_stats.read_slots == 0);
+
+	/* Phantom power check is done before first conversion (strong pull-up in time). */
+	CHECK(pico_1wire_convert_temperature(ctx, addr, true) == 0);
+	CHECK(pico_1wire_get_temperature(ctx, addr, &temp) == 0);
+	CHECK(temp == 21.5);
+	pico_1wire_sim_get_stats(sim, &sim_stats);
+	CHECK(sim_stats.resets > 0);
+	CHECK(sim_stats.power_faults == 0);
+
+	bus_teardown();
+}
+
+
+static void test_eager_init()
+{
+	pico_1wire_sim_stats_t sim_stats;
+
+	bus_setup();
+	pico_1wire_sim_add_device(sim, pico_1wire_sim_rom(0x28, 1), true);
+
+	/* Default initialization searches the bus. */
+	ctx = pico_1wire_init_ex(DATA_PIN, POWER_PIN, true, 0);
+	CHECK(ctx != NULL);
+	pico_1wire_sim_get_stats(sim, &sim_stats);
+	CHECK(sim_stats.resets > 0);
+	CHECK(ctx->device_count == 1);
+
+	bus_teardown();
+}
+
+
+static void test_static_init()
+{
+	static pico_1wire_t storage;
+	uint8_t buf[PICO_1WIRE_CTX_SIZE + 1];
+
+	bus_setup();
+	pico_1wire_sim_add_device(sim, pico_1wire_sim_rom(0x28, 1), false);
+
+	/* Too small or misaligned storage is rejected. */
+	CHECK(pico_1wire_init_static(&storage, PICO_1WIRE_CTX_SIZE - 1, DATA_PIN, POWER_PIN, true, 0) == NULL);
+	if ((uintptr_t)buf % _Alignof(pico_1wire_t))
+		CHECK(pico_1wire_init_static(buf, PICO_1WIRE_CTX_SIZE, DATA_PIN, POWER_PIN, true, 0) == NULL);
+	else
+		CHECK(pico_1wire_init_static(buf + 1, PICO_1WIRE_CTX_SIZE, DATA_PIN, POWER_PIN, true, 0) == NULL);
+
+	ctx = pico_1wire_init_static(&storage, sizeof(storage), DATA_PIN, POWER_PIN, true, 0);
+	CHECK(ctx == &storage);
+	CHECK(ctx->device_count == 1);
+
+	bus_teardown();
+}
+
+
+#if PICO_1WIRE_STATIC_POOL_SIZE > 0
+static void test_pool()
+{
+	pico_1wire_t *pool[PICO_1WIRE_STATIC_POOL_SIZE];
+	static pico_1wire_t storage;
+	pico_1wire_t *extra;
+
+	bus_setup();
+
+	for (int i = 0; i < PICO_1WIRE_STATIC_POOL_SIZE; i++) {
+		pool[i] = pico_1wire_init_ex(DATA_PIN, POWER_PIN, true, PICO_1WIRE_INIT_LAZY);
+		CHECK(pool[i] != NULL);
+	}
+
+	/* Pool exhausted. */
+	CHECK(pico_1wire_init_ex(DATA_PIN, POWER_PIN, true, PICO_1WIRE_INIT_LAZY) == NULL);
+	CHECK(pico_1wire_init(DATA_PIN, POWER_PIN, true) == NULL);
+
+	/* Caller provided storage does not use the pool. */
+	extra = pico_1wire_init_static(&storage, sizeof(storage), DATA_PIN, POWER_PIN, true, PICO_1WIRE_INIT_LAZY);
+	CHECK(extra == &storage);
+	pico_1wire_destroy(extra);
+
+	/* Destroyed context is returned to the pool. */
+	pico_1wire_destroy(pool[0]);
+	extra = pico_1wire_init_ex(DATA_PIN, POWER_PIN, true, PICO_1WIRE_INIT_LAZY);
+	CHECK(extra == pool[0]);
+	CHECK(pico_1wire_init_ex(DATA_PIN, POWER_PIN, true, PICO_1WIRE_INIT_LAZY) == NULL);
+
+	pico_1wire_destroy(extra);
+	for (int i = 1; i < PICO_1WIRE_STATIC_POOL_SIZE; i++)
+		pico_1wire_destroy(pool[i]);
+
+	bus_teardown();
+}
+#endif
+
+
+const test_case_t tests[] = {
+	{ "lazy_init", test_lazy_init },
+	{ "eager_init", test_eager_init },
+	{ "static_init", test_static_init },
+#if PICO_1WIRE_STATIC_POOL_SIZE > 0
+	{ "pool", test_pool },
+#endif
+};
+const uint test_count = sizeof(tests) / sizeof(tests[0]);
@@ -0,0 +1,126 @@
+/* pico_1wire_test_line.c
+
+   Copyright (C) 2024 Timo Kokkonen <tjko@iki.fi>
+
+   SPDX-License-Identifier: GPL-3.0-or-later
+
+   This file is part of pico-1wire Library.
+
+   pico-1wire Library is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   pico-1wire Library is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with pico-1wire Library. If not, see <https://www.gnu.org/licenses/>.
+*/
+
+
+
+/* Regression tests: data line fault detection and recovery. */
+
+#include "pico_1wire_test.h"
+#include "pico_1wire_host.h"
+
+
+static void test_stuck_low()
+{
+	pico_1wire_sim_stats_t sim_stats;
+	uint64_t addr_list[2];
+	uint64_t start;
+	uint found;
+
+	bus_setup();
+	pico_1wire_sim_add_device(sim, pico_1wire_sim_rom(0x28, 1), false);
+	bus_start();
+	CHECK(pico_1wire_get_bus_fault(ctx) == PICO_1WIRE_RESET_OK);
+
+	/* Line low before reset: waits for possible slot in progress, no reset pulse sent. */
+	pico_1wire_sim_set_line_fault(sim, PICO_1WIRE_SIM_FAULT_STUCK_LOW);
+	pico_1wire_sim_reset_stats(sim);
+	start = pico_1wire_host_time_us();
+	CHECK(pico_1wire_reset_bus_ex(ctx) == PICO_1WIRE_RESET_STUCK_LOW);
+	CHECK(pico_1wire_host_time_us() - start >= 120);
+	CHECK(pico_1wire_get_bus_fault(ctx) == PICO_1WIRE_RESET_STUCK_LOW);
+
+	/* Fault already known: fail immediately. */
+	start = pico_1wire_host_time_us();
+	CHECK(!pico_1wire_reset_bus(ctx));
+	CHECK(pico_1wire_search_rom(ctx, addr_list, 2, &found) == 1);
+	CHECK(pico_1wire_host_time_us() - start < 120);
+	CHECK(pico_1wire_get_bus_fault(ctx) == PICO_1WIRE_RESET_STUCK_LOW);
+	pico_1wire_sim_get_stats(sim, &sim_stats);
+	CHECK(sim_stats.resets == 0);
+
+	bus_teardown();
+}
+
+
+static void test_short()
+{
+	bus_setup();
+	pico_1wire_sim_add_device(sim, pico_1wire_sim_rom(0x28, 1), false);
+	bus_start();
+
+	/* Line does not return high after presence window. */
+	pico_1wire_sim_set_line_fault(sim, PICO_1WIRE_SIM_FAULT_SHORT);
+	CHECK(pico_1wire_reset_bus_ex(ctx) == PICO_1WIRE_RESET_SHORT);
+	CHECK(pico_1wire_get_bus_fault(ctx) == PICO_1WIRE_RESET_SHORT);
+	CHECK(!pico_1wire_reset_bus(ctx));
+
+	bus_teardown();
+}
+
+
+static void test_recovery()
+{
+	uint64_t addr = pico_1wire_sim_rom(0x28, 1);
+	uint64_t addr_list[2];
+	uint found;
+
+	bus_setup();
+	pico_1wire_sim_add_device(sim, addr, false);
+	bus_start();
+
+	/* Stuck low fault is cleared by first reset after line is released. */
+	pico_1wire_sim_set_line_fault(sim, PICO_1WIRE_SIM_FAULT_STUCK_LOW);
+	CHECK(pico_1wire_reset_bus_ex(ctx) == PICO_1WIRE_RESET_STUCK_LOW);
+	pico_1wire_sim_set_line_fault(sim, PICO_1WIRE_SIM_FAULT_NONE);
+	CHECK(pico_1wire_get_bus_fault(ctx) == PICO_1WIRE_RESET_STUCK_LOW);
+	CHECK(pico_1wire_reset_bus_ex(ctx) == PICO_1WIRE_RESET_OK);
+	CHECK(pico_1wire_get_bus_fault(ctx) == PICO_1WIRE_RESET_OK);
+	CHECK(pico_1wire_search_rom(ctx, addr_list, 2, &found) == 0);
+	CHECK(found == 1 && addr_list[0] == addr);
+
+	/* Short: once line has been released, next reset succeeds. */
+	pico_1wire_sim_set_line_fault(sim, PICO_1WIRE_SIM_FAULT_SHORT);
+	CHECK(pico_1wire_reset_bus_ex(ctx) == PICO_1WIRE_RESET_SHORT);
+	pico_1wire_sim_set_line_fault(sim, PICO_1WIRE_SIM_FAULT_NONE);
+	pico_1wire_host_sleep_us(1000);
+	CHECK(pico_1wire_reset_bus_ex(ctx) == PICO_1WIRE_RESET_OK);
+	CHECK(pico_1wire_search_rom(ctx, addr_list, 2, &found) == 0);
+	CHECK(found == 1 && addr_list[0] == addr);
+
+	/* Empty bus is not a line fault. */
+	pico_1wire_destroy(ctx);
+	pico_1wire_sim_destroy(sim);
+	bus_setup();
+	bus_start();
+	CHECK(pico_1wire_reset_bus_ex(ctx) == PICO_1WIRE_RESET_NO_PRESENCE);
+
+	bus_teardown();
+}
+
+
+const test_case_t tests[] = {
+	{ "stuck_low", test_stuck_low },
+	{ "short", test_short },
+	{ "recovery", test_recovery },
+};
+
+const uint test_count = sizeof(tests) / sizeof(tests[0]);
@@ -0,0 +1,167 @@
+/* pico_1wire_test_max31850.c
+
+   Copyright (C) 2024 Timo Kokkonen <tjko@iki.fi>
+
+   SPDX-License-Identifier: GPL-3.0-or-later
+
+   This file is part of pico-1wire Library.
+
+   pico-1wire Library is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   pico-1wire Library is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with pico-1wire Library. If not, see <https://www.gnu.org/licenses/>.
+*/
+
+
+
+/* Regression tests: MAX31850 thermocouple interface (family code shared with DS1825). */
+
+#include "pico_1wire_test.h"
+#include "pico_1wire_max31850.h"
+
+
+static void scratch_set(uint8_t *scratch, int16_t tc, int16_t cj, uint8_t config)
+{
+	scratch[0] = tc & 0xff;
+	scratch[1] = (tc >> 8) & 0xff;
+	scratch[2] = cj & 0xff;
+	scratch[3] = (cj >> 8) & 0xff;
+	scratch[4] = config;
+	scratch[5] = scratch[6] = scratch[7] = 0xff;
+	scratch[8] = pico_1wire_crc8(0, scratch, 8);
+}
+
+
+static void test_decode()
+{
+	pico_1wire_thermocouple_t tc;
+	uint8_t scratch[9];
+
+	CHECK(pico_1wire_max31850_decode(NULL, &tc) == -1);
+	CHECK(pico_1wire_max31850_decode(scratch, NULL) == -1);
+
+	/* Thermocouple 14bit (0.25C) in bits 15-2, cold-junction 12bit (0.0625C) in bits 15-4. */
+	scratch_set(scratch, (int16_t)(100.25 * 4) << 2, (int16_t)(25.0625 * 16) << 4, 0xf5);
+	CHECK(pico_1wire_max31850_decode(scratch, &tc) == 0);
+	CHECK(tc.temperature == 100.25);
+	CHECK(tc.cold_junction == 25.0625);
+	CHECK(tc.fault == 0);
+	CHECK(tc.address == 5);
+
+	/* Negative temperatures (sign extended). */
+	scratch_set(scratch, (int16_t)(-12.5 * 4) * 4, (int16_t)(-3.125 * 16) * 16, 0xf0);
+	CHECK(pico_1wire_max31850_decode(scratch, &tc) == 0);
+	CHECK(tc.temperature == -12.5);
+	CHECK(tc.cold_junction == -3.125);
+	CHECK(tc.address == 0);
+
+	/* Fault flag (bit 0 of thermocouple data), fault status in cold-junction bits 2-0. */
+	scratch_set(scratch, 0x0001, ((int16_t)(22.0 * 16) << 4) | PICO_1WIRE_TC_FAULT_OPEN, 0xff);
+	CHECK(pico_1wire_max31850_decode(scratch, &tc) == 3);
+	CHECK(tc.fault == PICO_1WIRE_TC_FAULT_OPEN);
+	CHECK(tc.cold_junction == 22.0);
+	CHECK(tc.address == 15);
+	scratch_set(scratch, 0x0001, PICO_1WIRE_TC_FAULT_SHORT_GND, 0xf0);
+	CHECK(pico_1wire_max31850_decode(scratch, &tc) == 3);
+	CHECK(tc.fault == PICO_1WIRE_TC_FAULT_SHORT_GND);
+	scratch_set(scratch, 0x0001, PICO_1WIRE_TC_FAULT_SHORT_VDD, 0xf0);
+	CHECK(pico_1wire_max31850_decode(scratch, &tc) == 3);
+	CHECK(tc.fault == PICO_1WIRE_TC_FAULT_SHORT_VDD);
+
+	/* Fault status bits are ignored without fault flag. */
+	scratch_set(scratch, 0x0000, 0x0007, 0xf0);
+	CHECK(pico_1wire_max31850_decode(scratch, &tc) == 0);
+	CHECK(tc.fault == 0);
+}
+
+
+static void test_thermocouple()
+{
+	uint64_t tc_addr = pico_1wire_sim_rom(0x3b, 1);
+	uint64_t ds1825_addr = pico_1wire_sim_rom(0x3b, 2);
+	uint64_t addr_list[2];
+	pico_1wire_thermocouple_t tc;
+	pico_1wire_sim_device_t *dev;
+	const pico_1wire_driver_t *drv;
+	float temp;
+	uint found;
+
+	bus_setup();
+	dev = pico_1wire_sim_add_device_model(sim, tc_addr, "MAX31850", false);
+	CHECK(dev != NULL);
+	pico_1wire_sim_set_temperature(dev, 812.5);
+	dev = pico_1wire_sim_add_device(sim, ds1825_addr, false);
+	pico_1wire_sim_set_temperature(dev, 21.0);
+	bus_start();
+	CHECK(pico_1wire_search_rom(ctx, addr_list, 2, &found) == 0);
+	CHECK(found == 2);
+
+	/* Devices sharing family code are identified from scratchpad. */
+	CHECK((drv = pico_1wire_get_device_driver(ctx, tc_addr)) && !strcmp(drv->name, "MAX31850"));
+	CHECK((drv = pico_1wire_get_device_driver(ctx, ds1825_addr)) && !strcmp(drv->name, "DS1825"));
+
+	CHECK(pico_1wire_convert_temperature(ctx, 0, true) == 0);
+	CHECK(pico_1wire_get_thermocouple(ctx, tc_addr, &tc) == 0);
+	CHECK(tc.temperature == 812.5);
+	CHECK(tc.cold_junction == 25.0);
+	CHECK(pico_1wire_get_temperature(ctx, tc_addr, &temp) == 0);
+	CHECK(temp == 812.5);
+	CHECK(pico_1wire_get_thermocouple(ctx, ds1825_addr, &tc) == 2);
+	CHECK(pico_1wire_get_temperature(ctx, ds1825_addr, &temp) == 0);
+	CHECK(temp == 21.0);
+
+	bus_teardown();
+}
+
+
+static void test_read_only()
+{
+	uint64_t tc_addr = pico_1wire_sim_rom(0x3b, 1);
+	uint64_t ds1825_addr = pico_1wire_sim_rom(0x3b, 2);
+	pico_1wire_sim_stats_t sim_stats;
+	uint8_t scratch[9];
+	uint8_t before[9];
+
+	bus_setup();
+	pico_1wire_sim_add_device_model(sim, tc_addr, "MAX31850", false);
+	pico_1wire_sim_add_device(sim, ds1825_addr, false);
+	bus_start();
+
+	/* MAX31850 has no Write Scratchpad command, or alarm threshold registers. */
+	CHECK(pico_1wire_read_scratch_pad(ctx, tc_addr, before) == 0);
+	memcpy(scratch, before, sizeof(scratch));
+	CHECK(pico_1wire_get_device_driver(ctx, tc_addr) != NULL);
+	/* Device already identified: rejected without bus access. */
+	pico_1wire_sim_reset_stats(sim);
+	CHECK(pico_1wire_write_scratch_pad(ctx, tc_addr, scratch) == 3);
+	pico_1wire_sim_get_stats(sim, &sim_stats);
+	CHECK(sim_stats.resets == 0);
+	CHECK(pico_1wire_set_alarm(ctx, tc_addr, 50, 10, false) == 3);
+	CHECK(pico_1wire_set_resolution(ctx, tc_addr, 12) == 3);
+	CHECK(pico_1wire_read_scratch_pad(ctx, tc_addr, scratch) == 0);
+	CHECK(!memcmp(scratch, before, sizeof(scratch)));
+
+	/* DS1825 with same family code has alarm thresholds. */
+	CHECK(pico_1wire_set_alarm(ctx, ds1825_addr, 50, 10, false) == 0);
+	CHECK(pico_1wire_read_scratch_pad(ctx, ds1825_addr, scratch) == 0);
+	CHECK(scratch[2] == 50 && scratch[3] == 10);
+
+	bus_teardown();
+}
+
+
+const test_case_t tests[] = {
+	{ "decode", test_decode },
+	{ "thermocouple", test_thermocouple },
+	{ "read_only", test_read_only },
+};
+
+const uint test_count = sizeof(tests) / sizeof(tests[0]);
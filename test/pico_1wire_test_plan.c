@@ -0,0 +1,96 @@
+/* pico_1wire_test_plan.c
+
+   Copyright (C) 2024 Timo Kokkonen <tjko@iki.fi>
+
+   SPDX-License-Identifier: GPL-3.0-or-later
+
+   This file is part of pico-1wire Library.
+
+   pico-1wire Library is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   pico-1wire Library is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with pico-1wire Library. If not, see <https://www.gnu.org/licenses/>.
+*/
+
+/* Regression tests: conversion planning for phantom powered sensors within current budget. */
+
+#include "pico_1wire_test.h"
+
+
+static void test_plan()
+{
+	uint64_t addr_list[8];
+	pico_1wire_plan_step_t steps[PICO_1WIRE_PLAN_MAX_STEPS(6)];
+	pico_1wire_sim_stats_t sim_stats;
+	float temps[6];
+	int results[6];
+	uint found, step_count;
+
+	bus_setup();
+	for (uint i = 0; i < 6; i++)
+		pico_1wire_sim_set_temperature(pico_1wire_sim_add_device(sim, pico_1wire_sim_rom(0x28, i + 1), i % 3),
+					20.0 + i);
+	bus_start();
+
+	CHECK(pico_1wire_search_rom(ctx, addr_list, 8, &found) == 0);
+	CHECK(found == 6);
+
+	/* Budget too small for a single phantom powered sensor. */
+	CHECK(pico_1wire_plan_conversions(ctx, addr_list, found, 0, steps, PICO_1WIRE_PLAN_MAX_STEPS(6),
+						&step_count) == 2);
+
+	/* One phantom powered sensor at a time, all at once. */
+	for (uint budget = 1500; budget <= 9000; budget += 7500) {
+		CHECK(pico_1wire_plan_conversions(ctx, addr_list, found, budget, steps,
+							PICO_1WIRE_PLAN_MAX_STEPS(6), &step_count) == 0);
+		CHECK(step_count == (budget < 9000 ? 2 * found : found + 1));
+
+		pico_1wire_sim_reset_stats(sim);
+		CHECK(pico_1wire_run_conversion_plan(ctx, addr_list, found, steps, step_count, temps, results) == 0);
+		pico_1wire_sim_get_stats(sim, &sim_stats);
+		CHECK(sim_stats.power_faults == 0);
+		CHECK(sim_stats.parasitic_peak == (budget < 9000 ? 1 : 4));
+		for (uint i = 0; i < found; i++) {
+			uint serial = rom_serial(addr_list[i]);
+			CHECK(results[i] == 0);
+			CHECK(temps[i] == 20.0 + serial - 1);
+		}
+	}
+
+	/* List without all phantom powered sensors: no broadcast conversion
+	   (it would convert the others too), even if budget allows. */
+	CHECK(pico_1wire_plan_conversions(ctx, addr_list, 4, 9000, steps, PICO_1WIRE_PLAN_MAX_STEPS(6),
+						&step_count) == 0);
+	CHECK(step_count == 8);
+	for (uint i = 0; i < step_count; i++)
+		CHECK(steps[i].index != PICO_1WIRE_ALL_DEVICES);
+	pico_1wire_sim_reset_stats(sim);
+	CHECK(pico_1wire_run_conversion_plan(ctx, addr_list, 4, steps, step_count, temps, results) == 0);
+	pico_1wire_sim_get_stats(sim, &sim_stats);
+	CHECK(sim_stats.power_faults == 0);
+	CHECK(sim_stats.parasitic_peak == 1);
+
+	/* Registry incomplete (search stopped when list was full): no broadcast conversion. */
+	CHECK(pico_1wire_search_rom(ctx, addr_list, 3, &found) == 2);
+	CHECK(pico_1wire_plan_conversions(ctx, addr_list, found, 9000, steps, PICO_1WIRE_PLAN_MAX_STEPS(6),
+						&step_count) == 0);
+	for (uint i = 0; i < step_count; i++)
+		CHECK(steps[i].index != PICO_1WIRE_ALL_DEVICES);
+
+	bus_teardown();
+}
+
+
+const test_case_t tests[] = {
+	{ "plan", test_plan },
+};
+
+const uint test_count = sizeof(tests) / sizeof(tests[0]);
@@ -0,0 +1,120 @@
+/* pico_1wire_test_power.c
+
+   Copyright (C) 2024 Timo Kokkonen <tjko@iki.fi>
+
+   SPDX-License-Identifier: GPL-3.0-or-later
+
+   This file is part of pico-1wire Library.
+
+   pico-1wire Library is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   pico-1wire Library is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with pico-1wire Library. If not, see <https://www.gnu.org/licenses/>.
+*/
+
+
+/* Regression tests: per-device power supply (phantom power) detection. */
+
+#include "pico_1wire_test.h"
+#include "pico_1wire_ds2438.h"
+
+
+/* DS2438 voltage register is only set by Convert V (0xB4, same code as Read Power Supply). */
+static uint ds2438_voltage(uint64_t addr)
+{
+	uint8_t page[8];
+
+	CHECK(pico_1wire_ds2438_read_page(ctx, addr, 0, page) == 0);
+	return page[3] | (page[4] << 8);
+}
+
+
+static void test_power()
+{
+	uint64_t monitor = pico_1wire_sim_rom(0x26, 1);
+	uint64_t sensor_p = pico_1wire_sim_rom(0x28, 1);
+	uint64_t sensor_e = pico_1wire_sim_rom(0x28, 2);
+	uint64_t addr_list[4];
+	pico_1wire_sim_stats_t sim_stats;
+	float temp;
+	uint found;
+
+	bus_setup();
+	pico_1wire_sim_add_device(sim, monitor, false);
+	pico_1wire_sim_set_temperature(pico_1wire_sim_add_device(sim, sensor_p, true), 21.0);
+	pico_1wire_sim_set_temperature(pico_1wire_sim_add_device(sim, sensor_e, false), 22.0);
+
+	/* Initialization finds the devices, and queries sensors one at a time
+	   (no broadcast Read Power Supply, as DS2438 is present). */
+	bus_start();
+	CHECK(ctx->power_known);
+	CHECK(!ctx->psu_present);
+	CHECK(ctx->registry_complete && ctx->device_count == 3);
+
+	/* Strong pull-up only for phantom powered sensor. */
+	pico_1wire_sim_reset_stats(sim);
+	CHECK(pico_1wire_convert_temperature(ctx, sensor_p, true) == 0);
+	CHECK(pico_1wire_get_temperature(ctx, sensor_p, &temp) == 0);
+	CHECK(temp == 21.0);
+	CHECK(pico_1wire_convert_temperature(ctx, sensor_e, true) == 0);
+	CHECK(pico_1wire_get_temperature(ctx, sensor_e, &temp) == 0);
+	CHECK(temp == 22.0);
+	pico_1wire_sim_get_stats(sim, &sim_stats);
+	CHECK(sim_stats.power_faults == 0);
+	CHECK(ds2438_voltage(monitor) == 0);
+
+	/* Search that does not fit all devices (registry incomplete): still no broadcast. */
+	CHECK(pico_1wire_search_rom(ctx, addr_list, 1, &found) == 2);
+	CHECK(!ctx->registry_complete);
+	CHECK(!ctx->psu_present);
+	CHECK(pico_1wire_search_rom(ctx, addr_list, 4, &found) == 0);
+	CHECK(found == 3);
+	CHECK(ds2438_voltage(monitor) == 0);
+
+	bus_teardown();
+}
+
+
+static void test_power_sensors()
+{
+	uint64_t addr_list[4];
+	uint found;
+
+	/* Sensors only: bus wide status is read using broadcast. */
+	bus_setup();
+	pico_1wire_sim_add_devices(sim, 0x28, 3, false, 5);
+	bus_start();
+	CHECK(ctx->power_known);
+	CHECK(ctx->psu_present);
+	CHECK(pico_1wire_search_rom(ctx, addr_list, 4, &found) == 0);
+	for (uint i = 0; i < ctx->device_count; i++)
+		CHECK(!ctx->devices[i].parasitic);
+	bus_teardown();
+
+	/* Lazy initialization: no bus traffic until first conversion. */
+	bus_setup();
+	pico_1wire_sim_add_devices(sim, 0x28, 3, true, 5);
+	ctx = pico_1wire_init_ex(DATA_PIN, POWER_PIN, true, PICO_1WIRE_INIT_LAZY);
+	CHECK(ctx != NULL);
+	CHECK(!ctx->power_known);
+	CHECK(pico_1wire_convert_temperature(ctx, 0, true) == 0);
+	CHECK(ctx->power_known);
+	CHECK(!ctx->psu_present);
+	bus_teardown();
+}
+
+
+const test_case_t tests[] = {
+	{ "power", test_power },
+	{ "power_sensors", test_power_sensors },
+};
+
+const uint test_count = sizeof(tests) / sizeof(tests[0]);
@@ -0,0 +1,68 @@
+/* pico_1wire_test_sequence.c
+
+   Copyright (C) 2024 Timo Kokkonen <tjko@iki.fi>
+
+   SPDX-License-Identifier: GPL-3.0-or-later
+
+   This file is part of pico-1wire Library.
+
+   pico-1wire Library is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   pico-1wire Library is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with pico-1wire Library. If not, see <https://www.gnu.org/licenses/>.
+*/
+
+/* Regression tests: DS28EA00 chain mode (sequence discovery). */
+
+#include "pico_1wire_test.h"
+
+
+static void test_sequence()
+{
+	static const uint64_t serials[] = { 5, 2, 9, 1, 7 };
+	const uint count = sizeof(serials) / sizeof(serials[0]);
+	uint64_t addr_list[8];
+	uint found, pos;
+
+	bus_setup();
+	for (uint i = 0; i < count; i++)
+		pico_1wire_sim_add_device(sim, pico_1wire_sim_rom(0x42, serials[i]), false);
+	bus_start();
+
+	/* Devices are found in the order they are wired in the chain. */
+	CHECK(pico_1wire_sequence_discovery(ctx, addr_list, 8, &found) == 0);
+	CHECK(found == count);
+	for (uint i = 0; i < found && i < count; i++) {
+		CHECK(addr_list[i] == pico_1wire_sim_rom(0x42, serials[i]));
+		CHECK(pico_1wire_get_position(ctx, addr_list[i], &pos) == 0);
+		CHECK(pos == i + 1);
+	}
+	CHECK(pico_1wire_get_position(ctx, pico_1wire_sim_rom(0x42, 3), &pos) == 1);
+
+	/* List full: discovery stops, chain mode is still turned off. */
+	CHECK(pico_1wire_sequence_discovery(ctx, addr_list, 3, &found) == 2);
+	CHECK(found == 3);
+	for (uint i = 0; i < found; i++)
+		CHECK(addr_list[i] == pico_1wire_sim_rom(0x42, serials[i]));
+
+	/* Chain mode is off afterwards, all devices answer normal search. */
+	CHECK(pico_1wire_search_rom(ctx, addr_list, 8, &found) == 0);
+	CHECK(found == count);
+
+	bus_teardown();
+}
+
+
+const test_case_t tests[] = {
+	{ "sequence", test_sequence },
+};
+
+const uint test_count = sizeof(tests) / sizeof(tests[0]);
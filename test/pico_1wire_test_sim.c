@@ -0,0 +1,169 @@
+/* pico_1wire_test_sim.c
+
+   Copyright (C) 2024 Timo Kokkonen <tjko@iki.fi>
+
+   SPDX-License-Identifier: GPL-3.0-or-later
+
+   This file is part of pico-1wire Library.
+
+   pico-1wire Library is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   pico-1wire Library is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with pico-1wire Library. If not, see <https://www.gnu.org/licenses/>.
+*/
+
+/* Regression tests: device enumeration and CRC checks on the simulated bus,
+   and simulator fault injection. */
+
+#include "pico_1wire_test.h"
+
+
+static void test_enumerate()
+{
+	uint64_t addr_list[MAX_DEVICES];
+	pico_1wire_stats_t stats;
+	float temp;
+	uint found;
+
+	bus_setup();
+	CHECK(pico_1wire_sim_add_devices(sim, 0x28, 40, false, 1) == 40);
+	CHECK(pico_1wire_sim_add_devices(sim, 0x10, 10, false, 2) == 10);
+	for (uint i = 0; i < 50; i++)
+		pico_1wire_sim_set_temperature(pico_1wire_sim_device(sim, i), 20.0 + i * 0.5);
+	bus_start();
+
+	CHECK(pico_1wire_search_rom(ctx, addr_list, MAX_DEVICES, &found) == 0);
+	CHECK(found == 50);
+	for (uint i = 0; i < pico_1wire_sim_device_count(sim); i++)
+		CHECK(in_list(addr_list, found, pico_1wire_sim_device_addr(pico_1wire_sim_device(sim, i))));
+
+	/* Search stops when list is full. */
+	CHECK(pico_1wire_search_rom(ctx, addr_list, 10, &found) == 2);
+	CHECK(found == 10);
+
+	CHECK(pico_1wire_convert_temperature(ctx, 0, true) == 0);
+	for (uint i = 0; i < 50; i++) {
+		uint64_t addr = pico_1wire_sim_device_addr(pico_1wire_sim_device(sim, i));
+		CHECK(pico_1wire_get_temperature(ctx, addr, &temp) == 0);
+		CHECK(temp == 20.0 + i * 0.5);
+	}
+
+	CHECK(pico_1wire_get_stats(ctx, &stats) == 0);
+	CHECK(stats.search_crc_failures == 0);
+	CHECK(stats.crc_failures == 0);
+
+	bus_teardown();
+
+	/* Empty bus. */
+	bus_setup();
+	bus_start();
+	CHECK(pico_1wire_search_rom(ctx, addr_list, MAX_DEVICES, &found) == 1);
+	CHECK(found == 0);
+	bus_teardown();
+}
+
+
+static void test_crc()
+{
+	static const uint8_t check[] = "123456789";
+	uint64_t addr_list[8];
+	uint8_t buf[9];
+	pico_1wire_stats_t stats;
+	uint found;
+
+	/* Check values of CRC-8/MAXIM and CRC-16/ARC. */
+	CHECK(pico_1wire_crc8(0, check, 9) == 0xa1);
+	CHECK(pico_1wire_crc16(0, check, 9) == 0xbb3d);
+	CHECK(pico_1wire_crc16(pico_1wire_crc16(0, check, 4), check + 4, 5) == 0xbb3d);
+
+	bus_setup();
+	pico_1wire_sim_add_devices(sim, 0x28, 4, false, 3);
+	bus_start();
+
+	CHECK(pico_1wire_search_rom(ctx, addr_list, 8, &found) == 0);
+	CHECK(found == 4);
+	for (uint i = 0; i < found; i++) {
+		/* CRC over whole ROM (including CRC byte) is 0. */
+		rom_bytes(addr_list[i], buf);
+		CHECK(pico_1wire_crc8(0, buf, 8) == 0);
+
+		CHECK(pico_1wire_read_scratch_pad(ctx, addr_list[i], buf) == 0);
+		CHECK(pico_1wire_crc8(0, buf, 8) == buf[8]);
+	}
+
+	/* Device not on the bus: nobody answers, scratchpad reads as all ones. */
+	CHECK(pico_1wire_read_scratch_pad(ctx, pico_1wire_sim_rom(0x28, 0x123456), buf) == 2);
+	CHECK(pico_1wire_get_stats(ctx, &stats) == 0);
+	CHECK(stats.crc_failures == 1);
+	CHECK(stats.search_crc_failures == 0);
+
+	bus_teardown();
+}
+
+
+static void test_faults()
+{
+	static const uint8_t convert[] = { 0x44 };
+	const pico_1wire_op_t late_pullup[] = {
+		{ .type = PICO_1WIRE_OP_SELECT, .mode = PICO_1WIRE_SELECT_MATCH },
+		{ .type = PICO_1WIRE_OP_WRITE, .len = 1, .tx = convert },
+		{ .type = PICO_1WIRE_OP_DELAY, .len = 1 },
+		{ .type = PICO_1WIRE_OP_PULLUP, .len = 750 },
+	};
+	pico_1wire_sim_stats_t sim_stats;
+	pico_1wire_stats_t stats;
+	pico_1wire_sim_device_t *dev;
+	uint64_t addr = pico_1wire_sim_rom(0x28, 1);
+	uint8_t buf[9];
+	float temp;
+
+	bus_setup();
+	dev = pico_1wire_sim_add_device(sim, addr, true);
+	pico_1wire_sim_set_temperature(dev, 25.0);
+	bus_start();
+
+	/* Strong pull-up right after the command keeps phantom powered sensor running. */
+	CHECK(pico_1wire_convert_temperature(ctx, addr, true) == 0);
+	CHECK(pico_1wire_get_temperature(ctx, addr, &temp) == 0);
+	CHECK(temp == 25.0);
+	pico_1wire_sim_get_stats(sim, &sim_stats);
+	CHECK(sim_stats.power_faults == 0);
+
+	/* Strong pull-up enabled 1ms late is a power fault. */
+	CHECK(pico_1wire_run_transaction(ctx, late_pullup, 4, addr, NULL) == 0);
+	CHECK(pico_1wire_read_scratch_pad(ctx, addr, buf) == 0);
+	pico_1wire_sim_get_stats(sim, &sim_stats);
+	CHECK(sim_stats.power_faults == 1);
+
+	/* Bit error in scratchpad is caught by CRC check, and is injected only once. */
+	CHECK(pico_1wire_sim_corrupt_bit(dev, 70) == 0);
+	CHECK(pico_1wire_read_scratch_pad(ctx, addr, buf) == 2);
+	CHECK(pico_1wire_read_scratch_pad(ctx, addr, buf) == 0);
+	CHECK(pico_1wire_get_stats(ctx, &stats) == 0);
+	CHECK(stats.crc_failures == 1);
+
+	/* Data line held low: nobody answers. */
+	pico_1wire_sim_set_line_fault(sim, PICO_1WIRE_SIM_FAULT_STUCK_LOW);
+	CHECK(!pico_1wire_reset_bus(ctx));
+	pico_1wire_sim_set_line_fault(sim, PICO_1WIRE_SIM_FAULT_NONE);
+	CHECK(pico_1wire_reset_bus(ctx));
+
+	bus_teardown();
+}
+
+
+const test_case_t tests[] = {
+	{ "enumerate", test_enumerate },
+	{ "crc", test_crc },
+	{ "faults", test_faults },
+};
+
+const uint test_count = sizeof(tests) / sizeof(tests[0]);
@@ -0,0 +1,174 @@
+/* pico_1wire_test_switch.c
+
+   Copyright (C) 2024 Timo Kokkonen <tjko@iki.fi>
+
+   SPDX-License-Identifier: GPL-3.0-or-later
+
+   This file is part of pico-1wire Library.
+
+   pico-1wire Library is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   pico-1wire Library is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with pico-1wire Library. If not, see <https://www.gnu.org/licenses/>.
+*/
+
+
+
+/* Regression tests: DS2408/DS2413 addressable switches. */
+
+#include "pico_1wire_test.h"
+#include "pico_1wire_switch.h"
+
+
+static void test_channel_access()
+{
+	uint64_t ds2408_addr = pico_1wire_sim_rom(0x29, 1);
+	uint64_t ds2413_addr = pico_1wire_sim_rom(0x3a, 2);
+	static const uint8_t values[] = { 0x00, 0x55, 0xaa, 0xf0 };
+	pico_1wire_switch_t sw;
+	uint8_t samples[40];
+	uint8_t state;
+
+	bus_setup();
+	pico_1wire_sim_add_device(sim, ds2408_addr, false);
+	pico_1wire_sim_add_device(sim, ds2413_addr, false);
+	bus_start();
+
+	CHECK(pico_1wire_switch_init(&sw, ctx, pico_1wire_sim_rom(0x28, 3)) == 2);
+
+	/* DS2408: latch sequence, pin state read back with CRC-16 (register read and sample blocks) */
+	CHECK(pico_1wire_switch_init(&sw, ctx, ds2408_addr) == 0);
+	CHECK(sw.channels == 8);
+	CHECK(pico_1wire_switch_write(&sw, values, sizeof(values), &state) == 0);
+	CHECK(state == 0xf0 && sw.latch == 0xf0);
+	CHECK(pico_1wire_switch_read(&sw, &state) == 0);
+	CHECK(state == 0xf0);
+	memset(samples, 0, sizeof(samples));
+	CHECK(pico_1wire_switch_sample(&sw, samples, sizeof(samples)) == 0);
+	for (uint i = 0; i < sizeof(samples); i++)
+		CHECK(samples[i] == 0xf0);
+
+	/* DS2413: only two channels, upper bits of latch ignored */
+	CHECK(pico_1wire_switch_init(&sw, ctx, ds2413_addr) == 0);
+	CHECK(sw.channels == 2);
+	CHECK(pico_1wire_switch_set(&sw, 0x02) == 0);
+	CHECK(sw.latch == 0x02);
+	CHECK(pico_1wire_switch_read(&sw, &state) == 0);
+	CHECK(state == 0x02);
+	CHECK(pico_1wire_switch_write(&sw, values, sizeof(values), &state) == 0);
+	CHECK(state == 0x00 && sw.latch == 0x00);
+
+	bus_teardown();
+}
+
+
+static void test_ds2408_errors()
+{
+	uint64_t addr = pico_1wire_sim_rom(0x29, 1);
+	pico_1wire_sim_device_t *dev;
+	pico_1wire_switch_t sw;
+	uint8_t samples[40];
+	uint8_t state;
+
+	bus_setup();
+	dev = pico_1wire_sim_add_device(sim, addr, false);
+	bus_start();
+	CHECK(pico_1wire_switch_init(&sw, ctx, addr) == 0);
+
+	/* Missing 0xAA confirmation (first bit of response inverted). */
+	CHECK(pico_1wire_sim_corrupt_bit(dev, 0) == 0);
+	CHECK(pico_1wire_switch_set(&sw, 0x0f) == 3);
+
+	/* CRC-16 of PIO register read. */
+	CHECK(pico_1wire_sim_corrupt_bit(dev, 3) == 0);
+	CHECK(pico_1wire_switch_read(&sw, &state) == 2);
+	CHECK(pico_1wire_switch_read(&sw, &state) == 0);
+
+	/* CRC-16 of each sample block: first block (includes command byte) and second block. */
+	CHECK(pico_1wire_sim_corrupt_bit(dev, 8 * 5) == 0);
+	CHECK(pico_1wire_switch_sample(&sw, samples, sizeof(samples)) == 2);
+	CHECK(pico_1wire_sim_corrupt_bit(dev, 8 * (32 + 2 + 7)) == 0);
+	CHECK(pico_1wire_switch_sample(&sw, samples, sizeof(samples)) == 2);
+	CHECK(pico_1wire_sim_corrupt_bit(dev, 8 * (32 + 2 + 32)) == 0);
+	CHECK(pico_1wire_switch_sample(&sw, samples, sizeof(samples)) == 2);
+	CHECK(pico_1wire_switch_sample(&sw, samples, sizeof(samples)) == 0);
+
+	bus_teardown();
+}
+
+
+static void test_ds2413_errors()
+{
+	uint64_t addr = pico_1wire_sim_rom(0x3a, 1);
+	pico_1wire_sim_device_t *dev;
+	pico_1wire_switch_t sw;
+	uint8_t samples[4];
+	uint8_t state;
+
+	bus_setup();
+	dev = pico_1wire_sim_add_device(sim, addr, false);
+	bus_start();
+	CHECK(pico_1wire_switch_init(&sw, ctx, addr) == 0);
+
+	/* Status byte is checked against its complement (upper nibble). */
+	CHECK(pico_1wire_sim_corrupt_bit(dev, 6) == 0);
+	CHECK(pico_1wire_switch_read(&sw, &state) == 2);
+	CHECK(pico_1wire_sim_corrupt_bit(dev, 8 * 2 + 1) == 0);
+	CHECK(pico_1wire_switch_sample(&sw, samples, sizeof(samples)) == 2);
+	CHECK(pico_1wire_switch_sample(&sw, samples, sizeof(samples)) == 0);
+
+	/* Missing confirmation, or bad status after update. */
+	CHECK(pico_1wire_sim_corrupt_bit(dev, 4) == 0);
+	CHECK(pico_1wire_switch_set(&sw, 0x01) == 3);
+	CHECK(pico_1wire_sim_corrupt_bit(dev, 8 + 2) == 0);
+	CHECK(pico_1wire_switch_set(&sw, 0x01) == 3);
+	CHECK(pico_1wire_switch_set(&sw, 0x01) == 0);
+
+	bus_teardown();
+}
+
+
+static void test_empty()
+{
+	uint64_t addr = pico_1wire_sim_rom(0x29, 1);
+	pico_1wire_sim_stats_t sim_stats;
+	pico_1wire_switch_t sw;
+	uint8_t samples[1];
+
+	bus_setup();
+	pico_1wire_sim_add_device(sim, addr, false);
+	bus_start();
+	CHECK(pico_1wire_switch_init(&sw, ctx, addr) == 0);
+
+	/* Nothing to transfer: no bus access (device is not left in channel access mode). */
+	pico_1wire_sim_reset_stats(sim);
+	CHECK(pico_1wire_switch_write(&sw, NULL, 0, NULL) == 0);
+	CHECK(pico_1wire_switch_sample(&sw, samples, 0) == 0);
+	pico_1wire_sim_get_stats(sim, &sim_stats);
+	CHECK(sim_stats.resets == 0);
+	CHECK(sim_stats.write0_slots == 0 && sim_stats.write1_slots == 0 && sim_stats.read_slots == 0);
+	CHECK(sw.latch == 0xff);
+
+	CHECK(pico_1wire_switch_write(&sw, NULL, 1, NULL) == -1);
+	CHECK(pico_1wire_switch_sample(&sw, NULL, 1) == -1);
+
+	bus_teardown();
+}
+
+
+const test_case_t tests[] = {
+	{ "channel_access", test_channel_access },
+	{ "ds2408_errors", test_ds2408_errors },
+	{ "ds2413_errors", test_ds2413_errors },
+	{ "empty", test_empty },
+};
+
+const uint test_count = sizeof(tests) / sizeof(tests[0]);
@@ -0,0 +1,149 @@
+/* pico_1wire_test_transaction.c
+
+   Copyright (C) 2024 Timo Kokkonen <tjko@iki.fi>
+
+   SPDX-License-Identifier: GPL-3.0-or-later
+
+   This file is part of pico-1wire Library.
+
+   pico-1wire Library is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   pico-1wire Library is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with pico-1wire Library. If not, see <https://www.gnu.org/licenses/>.
+*/
+
+
+
+/* Regression tests: operation lists (pico_1wire_run_transaction()). */
+
+#include "pico_1wire_test.h"
+
+
+static const uint8_t convert[] = { 0x44 };
+static const uint8_t read_scratchpad[] = { 0xbe };
+
+
+static void test_validate()
+{
+	uint8_t buf[9];
+	const pico_1wire_op_t bad_type[] = {
+		{ .type = PICO_1WIRE_OP_SELECT, .mode = PICO_1WIRE_SELECT_MATCH },
+		{ .type = PICO_1WIRE_OP_WRITE, .len = 1, .tx = read_scratchpad },
+		{ .type = PICO_1WIRE_OP_READ, .len = 9, .rx = buf },
+		{ .type = 99 },
+	};
+	const pico_1wire_op_t bad_mode[] = {
+		{ .type = PICO_1WIRE_OP_RESET },
+		{ .type = PICO_1WIRE_OP_SELECT, .mode = 9 },
+	};
+	const pico_1wire_op_t no_addr[] = {
+		{ .type = PICO_1WIRE_OP_SELECT, .mode = PICO_1WIRE_SELECT_MATCH },
+	};
+	const pico_1wire_op_t no_buf[] = {
+		{ .type = PICO_1WIRE_OP_RESET },
+		{ .type = PICO_1WIRE_OP_READ, .len = 1 },
+	};
+	uint64_t addr = pico_1wire_sim_rom(0x28, 1);
+	pico_1wire_sim_stats_t sim_stats;
+	uint completed = 99;
+
+	bus_setup();
+	pico_1wire_sim_add_device(sim, addr, false);
+	bus_start();
+
+	/* Invalid operation anywhere in the list rejects whole list before any bus activity. */
+	pico_1wire_sim_reset_stats(sim);
+	CHECK(pico_1wire_run_transaction(ctx, bad_type, 4, addr, &completed) == -1);
+	CHECK(completed == 0);
+	CHECK(pico_1wire_run_transaction(ctx, bad_mode, 2, addr, NULL) == -1);
+	CHECK(pico_1wire_run_transaction(ctx, no_addr, 1, 0, NULL) == -1);
+	CHECK(pico_1wire_run_transaction(ctx, no_buf, 2, addr, NULL) == -1);
+	pico_1wire_sim_get_stats(sim, &sim_stats);
+	CHECK(sim_stats.resets == 0);
+	CHECK(sim_stats.write0_slots == 0 && sim_stats.write1_slots == 0 && sim_stats.read_slots == 0);
+
+	/* Same list without the invalid operation runs. */
+	CHECK(pico_1wire_run_transaction(ctx, bad_type, 3, addr, &completed) == 0);
+	CHECK(completed == 3);
+	CHECK(pico_1wire_crc8(0, buf, 9) == 0);
+
+	/* Failing operation stops the list, completed counts operations done before it. */
+	pico_1wire_sim_set_line_fault(sim, PICO_1WIRE_SIM_FAULT_STUCK_LOW);
+	pico_1wire_sim_reset_stats(sim);
+	CHECK(pico_1wire_run_transaction(ctx, bad_type, 3, addr, &completed) == 1);
+	CHECK(completed == 0);
+	pico_1wire_sim_get_stats(sim, &sim_stats);
+	CHECK(sim_stats.read_slots == 0);
+	pico_1wire_sim_set_line_fault(sim, PICO_1WIRE_SIM_FAULT_NONE);
+
+	bus_teardown();
+}
+
+
+static void test_pullup()
+{
+	uint8_t buf[9];
+	const pico_1wire_op_t convert_ops[] = {
+		{ .type = PICO_1WIRE_OP_SELECT, .mode = PICO_1WIRE_SELECT_MATCH },
+		{ .type = PICO_1WIRE_OP_WRITE, .len = 1, .tx = convert },
+		{ .type = PICO_1WIRE_OP_PULLUP, .len = 750 },
+		{ .type = PICO_1WIRE_OP_SELECT, .mode = PICO_1WIRE_SELECT_MATCH },
+		{ .type = PICO_1WIRE_OP_WRITE, .len = 1, .tx = read_scratchpad },
+		{ .type = PICO_1WIRE_OP_READ, .len = 9, .rx = buf },
+	};
+	uint64_t addr = pico_1wire_sim_rom(0x28, 1);
+	pico_1wire_sim_ds2482_t *bridge;
+	pico_1wire_sim_device_t *dev;
+	pico_1wire_sim_stats_t sim_stats;
+	uint completed;
+
+	bus_setup();
+	dev = pico_1wire_sim_add_device(sim, addr, true);
+	pico_1wire_sim_set_temperature(dev, 23.5);
+	bus_start();
+
+	/* PULLUP after WRITE: strong pull-up is turned on right after the last byte (within 10us). */
+	pico_1wire_sim_reset_stats(sim);
+	CHECK(pico_1wire_run_transaction(ctx, convert_ops, 6, addr, &completed) == 0);
+	CHECK(completed == 6);
+	pico_1wire_sim_get_stats(sim, &sim_stats);
+	CHECK(sim_stats.power_faults == 0);
+	CHECK(pico_1wire_crc8(0, buf, 9) == 0);
+	CHECK((int16_t)(buf[0] | (buf[1] << 8)) == 23.5 * 16);
+	pico_1wire_destroy(ctx);
+
+	/* Through DS2482 bridge, pull-up (SPU) must be armed before the last byte is written. */
+	bridge = pico_1wire_sim_ds2482_create(0, PICO_1WIRE_DS2482_ADDR, 1);
+	CHECK(bridge != NULL);
+	CHECK(pico_1wire_sim_ds2482_attach(bridge, 0, sim) == 0);
+	ctx = pico_1wire_init_ds2482(0, PICO_1WIRE_DS2482_ADDR, -1, 0);
+	CHECK(ctx != NULL);
+	if (ctx) {
+		pico_1wire_sim_set_temperature(dev, -5.0);
+		pico_1wire_sim_reset_stats(sim);
+		CHECK(pico_1wire_run_transaction(ctx, convert_ops, 6, addr, &completed) == 0);
+		pico_1wire_sim_get_stats(sim, &sim_stats);
+		CHECK(sim_stats.power_faults == 0);
+		CHECK(pico_1wire_crc8(0, buf, 9) == 0);
+		CHECK((int16_t)(buf[0] | (buf[1] << 8)) == -5.0 * 16);
+	}
+
+	bus_teardown();
+	pico_1wire_sim_ds2482_destroy(bridge);
+}
+
+
+const test_case_t tests[] = {
+	{ "validate", test_validate },
+	{ "pullup", test_pullup },
+};
+
+const uint test_count = sizeof(tests) / sizeof(tests[0]);
@@ -0,0 +1,231 @@
+/* pico_1wire_vcd.c
+
+   Copyright (C) 2024 Timo Kokkonen <tjko@iki.fi>
+
+   SPDX-License-Identifier: GPL-3.0-or-later
+
+   This file is part of pico-1wire Library.
+
+   pico-1wire Library is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   pico-1wire Library is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with pico-1wire Library. If not, see <https://www.gnu.org/licenses/>.
+*/
+
+/* Trace converter: reads output of pico_1wire_trace_dump() and writes
+   a VCD file (for GTKWave). Bus waveform is reconstructed from the
+   recorded slots using nominal slot timing. */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+
+
+/* Nominal timing (us) used by the library */
+#define RESET_LEN         480
+#define RESET_SLOT_LEN    960
+#define PRESENCE_START    30
+#define PRESENCE_LEN      120
+#define WRITE1_LOW_LEN    3
+#define WRITE0_LOW_LEN    60
+#define READ0_LOW_LEN     30
+#define READ_LOW_LEN      3
+#define READ_SAMPLE_TIME  10
+#define SLOT_LEN          65
+
+/* Values for "slot" signal */
+#define SLOT_IDLE   0
+#define SLOT_RESET  1
+#define SLOT_WRITE  2
+#define SLOT_READ   3
+
+enum signal_id {
+	SIG_BUS = 0,
+	SIG_DRIVEN,
+	SIG_SAMPLED,
+	SIG_SLOT,
+	SIG_COUNT
+};
+
+static const char *signal_codes[SIG_COUNT] = { "!", "\"", "#", "$" };
+
+static uint64_t current_time;
+static int current_value[SIG_COUNT];
+static int time_printed;
+static uint64_t slot_end;
+
+
+static void emit(FILE *out, uint64_t t, enum signal_id id, int value)
+{
+	/* Keep time monotonic even if trace contains overlapping records */
+	if (t < current_time)
+		t = current_time;
+
+	if (current_value[id] == value)
+		return;
+
+	if (t != current_time || !time_printed) {
+		fprintf(out, "#%llu\n", (unsigned long long)t);
+		current_time = t;
+		time_printed = 1;
+	}
+
+	if (id == SIG_SLOT)
+		fprintf(out, "b%d%d %s\n", (value >> 1) & 1, value & 1, signal_codes[id]);
+	else
+		fprintf(out, "%d%s\n", value, signal_codes[id]);
+	current_value[id] = value;
+}
+
+
+static void write_header(FILE *out, const char *source)
+{
+	fprintf(out, "$comment pico-1wire trace: %s $end\n", source);
+	fprintf(out, "$timescale 1us $end\n");
+	fprintf(out, "$scope module onewire $end\n");
+	fprintf(out, "$var wire 1 %s bus $end\n", signal_codes[SIG_BUS]);
+	fprintf(out, "$var wire 1 %s driven $end\n", signal_codes[SIG_DRIVEN]);
+	fprintf(out, "$var wire 1 %s sampled $end\n", signal_codes[SIG_SAMPLED]);
+	fprintf(out, "$var wire 2 %s slot $end\n", signal_codes[SIG_SLOT]);
+	fprintf(out, "$upscope $end\n");
+	fprintf(out, "$enddefinitions $end\n");
+	fprintf(out, "$dumpvars\n1%s\n1%s\n1%s\nb00 %s\n$end\n",
+		signal_codes[SIG_BUS], signal_codes[SIG_DRIVEN],
+		signal_codes[SIG_SAMPLED], signal_codes[SIG_SLOT]);
+
+	for (int i = 0; i < SIG_COUNT; i++)
+		current_value[i] = (i == SIG_SLOT ? SLOT_IDLE : 1);
+}
+
+
+static void end_slot(FILE *out, uint64_t t)
+{
+	/* Show idle only if there is a gap before the next slot */
+	if (slot_end && slot_end < t)
+		emit(out, slot_end, SIG_SLOT, SLOT_IDLE);
+	slot_end = 0;
+}
+
+
+static void write_record(FILE *out, uint64_t t, char type, int driven, int sampled)
+{
+	end_slot(out, t);
+
+	switch (type) {
+	case 'R':
+		emit(out, t, SIG_SLOT, SLOT_RESET);
+		emit(out, t, SIG_DRIVEN, 0);
+		emit(out, t, SIG_BUS, 0);
+		emit(out, t + RESET_LEN, SIG_BUS, 1);
+		if (sampled) {
+			emit(out, t + RESET_LEN + PRESENCE_START, SIG_BUS, 0);
+			emit(out, t + RESET_LEN + PRESENCE_START, SIG_SAMPLED, 1);
+			emit(out, t + RESET_LEN + PRESENCE_START + PRESENCE_LEN, SIG_BUS, 1);
+		} else {
+			emit(out, t + RESET_LEN + PRESENCE_START, SIG_SAMPLED, 0);
+		}
+		slot_end = t + RESET_SLOT_LEN;
+		break;
+
+	case 'W':
+		emit(out, t, SIG_SLOT, SLOT_WRITE);
+		emit(out, t, SIG_DRIVEN, driven);
+		emit(out, t, SIG_BUS, 0);
+		emit(out, t + (driven ? WRITE1_LOW_LEN : WRITE0_LOW_LEN), SIG_BUS, 1);
+		emit(out, t + SLOT_LEN - 1, SIG_SAMPLED, sampled);
+		if (!sampled)
+			emit(out, t + SLOT_LEN - 1, SIG_BUS, 0);
+		slot_end = t + SLOT_LEN;
+		break;
+
+	case 'r':
+		emit(out, t, SIG_SLOT, SLOT_READ);
+		emit(out, t, SIG_DRIVEN, 1);
+		emit(out, t, SIG_BUS, 0);
+		if (sampled) {
+			emit(out, t + READ_LOW_LEN, SIG_BUS, 1);
+			emit(out, t + READ_SAMPLE_TIME, SIG_SAMPLED, 1);
+		} else {
+			emit(out, t + READ_SAMPLE_TIME, SIG_SAMPLED, 0);
+			emit(out, t + READ0_LOW_LEN, SIG_BUS, 1);
+		}
+		slot_end = t + SLOT_LEN;
+		break;
+	}
+}
+
+
+int main(int argc, char **argv)
+{
+	FILE *in = stdin;
+	FILE *out = stdout;
+	const char *source = "stdin";
+	char line[256];
+	unsigned long ts;
+	char type;
+	unsigned int driven, sampled;
+	uint64_t base = 0, high = 0;
+	uint32_t prev = 0;
+	int first = 1;
+	int lineno = 0;
+
+	if (argc > 3 || (argc > 1 && !strcmp(argv[1], "-h"))) {
+		fprintf(stderr, "usage: %s [trace file] [vcd file]\n", argv[0]);
+		return 1;
+	}
+	if (argc > 1 && strcmp(argv[1], "-")) {
+		source = argv[1];
+		if (!(in = fopen(argv[1], "r"))) {
+			perror(argv[1]);
+			return 1;
+		}
+	}
+	if (argc > 2) {
+		if (!(out = fopen(argv[2], "w"))) {
+			perror(argv[2]);
+			return 1;
+		}
+	}
+
+	write_header(out, source);
+
+	while (fgets(line, sizeof(line), in)) {
+		lineno++;
+		if (line[0] == '#' || line[0] == '\n' || line[0] == '\r')
+			continue;
+		if (sscanf(line, "%lu %c %u %u", &ts, &type, &driven, &sampled) != 4
+			|| !strchr("RWr", type)) {
+			fprintf(stderr, "%s:%d: invalid trace record\n", source, lineno);
+			continue;
+		}
+
+		/* Timestamps are lower 32 bits of time since boot */
+		if (first) {
+			base = (uint32_t)ts;
+			first = 0;
+		} else if ((uint32_t)ts < prev) {
+			high += (uint64_t)1 << 32;
+		}
+		prev = (uint32_t)ts;
+
+		write_record(out, high + (uint32_t)ts - base, type, driven ? 1 : 0, sampled ? 1 : 0);
+	}
+
+	end_slot(out, UINT64_MAX);
+
+	if (in != stdin)
+		fclose(in);
+	if (out != stdout)
+		fclose(out);
+
+	return 0;
+}